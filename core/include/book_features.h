@@ -0,0 +1,309 @@
+#pragma once
+
+#include "protocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// 多档盘口特征
+// 所有价格类特征在该侧无有效挂单时为 0
+struct BookFeatures {
+    // 注意：字段全部为 double 且顺序与 BookFeatureCalc 批量收尾一致
+    double imbalance;        // 多档加权失衡度 sum(w*(b-a)) / sum(w*(b+a))，[-1, 1]
+    double microprice;       // 一档微价格 (b0*av0 + a0*bv0) / (bv0 + av0)
+    double mid;              // (b0 + a0) / 2
+    double bid_vwap;         // 买侧 N 档量加权均价 (扫单到第 N 档的均价)
+    double ask_vwap;         // 卖侧 N 档量加权均价
+    double weighted_spread;  // 深度加权价差 ask_vwap - bid_vwap
+    double bid_slope;        // 买侧斜率 (b0 - bid_vwap) / bid_depth，每手让价
+    double ask_slope;        // 卖侧斜率 (ask_vwap - a0) / ask_depth
+    double bid_depth;        // 买侧 N 档总量
+    double ask_depth;        // 卖侧 N 档总量
+};
+static_assert(sizeof(BookFeatures) == 10 * sizeof(double), "BookFeatures must be 10 packed doubles");
+
+/**
+ * BookFeatureCalc: 向量化多档盘口特征计算
+ *
+ * 一次遍历 TickRecord 的 5 档价量同时求出失衡度、微价格、VWAP、斜率等特征。
+ * 编译期按 __AVX512F__ / __AVX2__ 选择实现 (Release 默认 -march=native)，否则回退标量。
+ *
+ * - 单 Tick 接口 compute：5 档买/卖各占一个向量 (AVX2 4 lane + 标量尾)。
+ *   单 Tick 只有 5 档，AVX-512 的水平归约反而更慢，因此单 Tick 路径只用 AVX2。
+ * - 批量接口 compute_batch：按 Tick 方向向量化 (AVX-512 一次 8 个 Tick，AVX2 一次 4 个)，
+ *   档位用 gather 读取，除法等收尾运算也在向量中完成，供离线研究按数组处理；
+ *   指针数组重载供 onTickBatch 使用 (批内 Tick 不必连续，gather 按各 Tick 相对首个 Tick 的 64 位偏移寻址)。
+ *
+ * levels 之外的档位通过掩码权重清零，因此各实现结果一致。
+ */
+class BookFeatureCalc {
+public:
+    static constexpr int MAX_LEVELS = 5;
+
+    // weights 为空时使用 1/(i+1) 衰减权重
+    explicit BookFeatureCalc(int levels = MAX_LEVELS, const double* weights = nullptr) {
+        if (levels < 1) levels = 1;
+        if (levels > MAX_LEVELS) levels = MAX_LEVELS;
+        levels_ = levels;
+        for (int i = 0; i < 8; ++i) {
+            bool on = i < levels;
+            mask_[i] = on ? 1.0 : 0.0;
+            weight_[i] = on ? (weights ? weights[i] : 1.0 / (i + 1)) : 0.0;
+        }
+    }
+
+    int levels() const { return levels_; }
+
+    inline void compute(const TickRecord& t, BookFeatures& out) const {
+#if defined(__AVX2__)
+        compute_avx2(t, out);
+#else
+        compute_scalar(t, out);
+#endif
+    }
+
+    void compute_batch(const TickRecord* ticks, size_t n, BookFeatures* out) const {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        constexpr long long S = sizeof(TickRecord);
+        const __m512i idx = _mm512_setr_epi64(0, S, 2 * S, 3 * S, 4 * S, 5 * S, 6 * S, 7 * S);
+        for (; i + 8 <= n; i += 8) batch8_avx512(reinterpret_cast<const char*>(ticks + i), idx, out + i);
+#elif defined(__AVX2__)
+        constexpr long long S = sizeof(TickRecord);
+        const __m256i idx = _mm256_setr_epi64x(0, S, 2 * S, 3 * S);
+        for (; i + 4 <= n; i += 4) batch4_avx2(reinterpret_cast<const char*>(ticks + i), idx, out + i);
+#endif
+        for (; i < n; ++i) compute(ticks[i], out[i]);
+    }
+
+    void compute_batch(const TickRecord* const* ticks, size_t n, BookFeatures* out) const {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 8 <= n; i += 8) {
+            const char* b = reinterpret_cast<const char*>(ticks[i]);
+            const __m512i idx = _mm512_setr_epi64(0, offset(b, ticks[i + 1]), offset(b, ticks[i + 2]), offset(b, ticks[i + 3]),
+                                                  offset(b, ticks[i + 4]), offset(b, ticks[i + 5]), offset(b, ticks[i + 6]),
+                                                  offset(b, ticks[i + 7]));
+            batch8_avx512(b, idx, out + i);
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            const char* b = reinterpret_cast<const char*>(ticks[i]);
+            const __m256i idx = _mm256_setr_epi64x(0, offset(b, ticks[i + 1]), offset(b, ticks[i + 2]), offset(b, ticks[i + 3]));
+            batch4_avx2(b, idx, out + i);
+        }
+#endif
+        for (; i < n; ++i) compute(*ticks[i], out[i]);
+    }
+
+    // 标量参考实现 (也是无 SIMD 平台的回退路径)
+    void compute_scalar(const TickRecord& t, BookFeatures& out) const {
+        double bd = 0, ad = 0, bpv = 0, apv = 0, bw = 0, aw = 0;
+        for (int i = 0; i < MAX_LEVELS; ++i) {
+            double bv = t.bid_volume[i] * mask_[i];
+            double av = t.ask_volume[i] * mask_[i];
+            bd += bv;
+            ad += av;
+            bpv += valid_price(t.bid_price[i], bv) * bv;
+            apv += valid_price(t.ask_price[i], av) * av;
+            bw += weight_[i] * bv;
+            aw += weight_[i] * av;
+        }
+        finish(t, bd, ad, bpv, apv, bw, aw, out);
+    }
+
+#if defined(__AVX2__)
+    void compute_avx2(const TickRecord& t, BookFeatures& out) const {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d m = _mm256_loadu_pd(mask_);
+        const __m256d w = _mm256_loadu_pd(weight_);
+
+        __m256d bv = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.bid_volume))), m);
+        __m256d av = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.ask_volume))), m);
+        // 空档位 (量为 0) 的价格可能是 DBL_MAX，先按量掩掉
+        __m256d bp = _mm256_and_pd(_mm256_loadu_pd(t.bid_price), _mm256_cmp_pd(bv, zero, _CMP_GT_OQ));
+        __m256d ap = _mm256_and_pd(_mm256_loadu_pd(t.ask_price), _mm256_cmp_pd(av, zero, _CMP_GT_OQ));
+
+        // 水平求和：hadd 交错买卖两侧，一次得到 [bid_sum, ask_sum]
+        __m128d depth = hsum2(bv, av);
+        __m128d pv = hsum2(_mm256_mul_pd(bp, bv), _mm256_mul_pd(ap, av));
+        __m128d wv = hsum2(_mm256_mul_pd(w, bv), _mm256_mul_pd(w, av));
+
+        double d[2], p[2], q[2];
+        _mm_storeu_pd(d, depth);
+        _mm_storeu_pd(p, pv);
+        _mm_storeu_pd(q, wv);
+
+        // 第 5 档标量尾
+        double bv4 = t.bid_volume[4] * mask_[4];
+        double av4 = t.ask_volume[4] * mask_[4];
+        d[0] += bv4;
+        d[1] += av4;
+        p[0] += valid_price(t.bid_price[4], bv4) * bv4;
+        p[1] += valid_price(t.ask_price[4], av4) * av4;
+        q[0] += weight_[4] * bv4;
+        q[1] += weight_[4] * av4;
+
+        finish(t, d[0], d[1], p[0], p[1], q[0], q[1], out);
+    }
+#endif
+
+#if defined(__AVX2__)
+    // 4 个 Tick 一组，每个 lane 对应一个 Tick：lane j 的 Tick 位于 base + idx[j]
+    void batch4_avx2(const char* base, __m256i idx, BookFeatures* out) const {
+        const __m256d zero = _mm256_setzero_pd();
+
+        __m256d bd = zero, ad = zero, bpv = zero, apv = zero, bw = zero, aw = zero;
+        __m256d b0 = zero, a0 = zero, bv0 = zero, av0 = zero;
+        for (int l = 0; l < levels_; ++l) {
+            __m256d bv = _mm256_cvtepi32_pd(_mm256_i64gather_epi32(
+                reinterpret_cast<const int*>(base + offsetof(TickRecord, bid_volume) + l * sizeof(int)), idx, 1));
+            __m256d av = _mm256_cvtepi32_pd(_mm256_i64gather_epi32(
+                reinterpret_cast<const int*>(base + offsetof(TickRecord, ask_volume) + l * sizeof(int)), idx, 1));
+            __m256d bp = _mm256_and_pd(_mm256_i64gather_pd(
+                reinterpret_cast<const double*>(base + offsetof(TickRecord, bid_price) + l * sizeof(double)), idx, 1),
+                _mm256_cmp_pd(bv, zero, _CMP_GT_OQ));
+            __m256d ap = _mm256_and_pd(_mm256_i64gather_pd(
+                reinterpret_cast<const double*>(base + offsetof(TickRecord, ask_price) + l * sizeof(double)), idx, 1),
+                _mm256_cmp_pd(av, zero, _CMP_GT_OQ));
+            const __m256d w = _mm256_set1_pd(weight_[l]);
+
+            if (l == 0) { b0 = bp; a0 = ap; bv0 = bv; av0 = av; }
+            bd = _mm256_add_pd(bd, bv);
+            ad = _mm256_add_pd(ad, av);
+            bpv = _mm256_add_pd(bpv, _mm256_mul_pd(bp, bv));
+            apv = _mm256_add_pd(apv, _mm256_mul_pd(ap, av));
+            bw = _mm256_add_pd(bw, _mm256_mul_pd(w, bv));
+            aw = _mm256_add_pd(aw, _mm256_mul_pd(w, av));
+        }
+
+        // 收尾：与 finish 相同的语义，分母为 0 的 lane 置 0
+        auto safe_div = [zero](__m256d num, __m256d den) {
+            __m256d ok = _mm256_cmp_pd(den, zero, _CMP_GT_OQ);
+            return _mm256_and_pd(_mm256_div_pd(num, _mm256_blendv_pd(_mm256_set1_pd(1.0), den, ok)), ok);
+        };
+        __m256d both = _mm256_and_pd(_mm256_cmp_pd(b0, zero, _CMP_GT_OQ), _mm256_cmp_pd(a0, zero, _CMP_GT_OQ));
+        __m256d sides = _mm256_and_pd(_mm256_cmp_pd(bd, zero, _CMP_GT_OQ), _mm256_cmp_pd(ad, zero, _CMP_GT_OQ));
+
+        alignas(32) double f[10][4];
+        __m256d mid = _mm256_and_pd(_mm256_mul_pd(_mm256_add_pd(b0, a0), _mm256_set1_pd(0.5)), both);
+        __m256d micro = _mm256_div_pd(_mm256_add_pd(_mm256_mul_pd(b0, av0), _mm256_mul_pd(a0, bv0)),
+                                      _mm256_blendv_pd(_mm256_set1_pd(1.0), _mm256_add_pd(bv0, av0), both));
+        __m256d bvw = safe_div(bpv, bd);
+        __m256d avw = safe_div(apv, ad);
+        _mm256_store_pd(f[0], safe_div(_mm256_sub_pd(bw, aw), _mm256_add_pd(bw, aw)));
+        _mm256_store_pd(f[1], _mm256_blendv_pd(mid, micro, both));
+        _mm256_store_pd(f[2], mid);
+        _mm256_store_pd(f[3], bvw);
+        _mm256_store_pd(f[4], avw);
+        _mm256_store_pd(f[5], _mm256_and_pd(_mm256_sub_pd(avw, bvw), sides));
+        _mm256_store_pd(f[6], safe_div(_mm256_sub_pd(b0, bvw), bd));
+        _mm256_store_pd(f[7], safe_div(_mm256_sub_pd(avw, a0), ad));
+        _mm256_store_pd(f[8], bd);
+        _mm256_store_pd(f[9], ad);
+        scatter(f[0], 4, out);
+    }
+#endif
+
+#if defined(__AVX512F__)
+    // 8 个 Tick 一组，每个 lane 对应一个 Tick：lane j 的 Tick 位于 base + idx[j]
+    void batch8_avx512(const char* base, __m512i idx, BookFeatures* out) const {
+        const __m512d zero = _mm512_setzero_pd();
+
+        __m512d bd = zero, ad = zero, bpv = zero, apv = zero, bw = zero, aw = zero;
+        __m512d b0 = zero, a0 = zero, bv0 = zero, av0 = zero;
+        for (int l = 0; l < levels_; ++l) {
+            // 掩码形式 (零源)：非掩码 gather / cvt 内部的未定义源会触发 GCC 12 -Wmaybe-uninitialized
+            __m512d bv = _mm512_maskz_cvtepi32_pd(0xFF, _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xFF, idx,
+                base + offsetof(TickRecord, bid_volume) + l * sizeof(int), 1));
+            __m512d av = _mm512_maskz_cvtepi32_pd(0xFF, _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xFF, idx,
+                base + offsetof(TickRecord, ask_volume) + l * sizeof(int), 1));
+            __mmask8 bk = _mm512_cmp_pd_mask(bv, zero, _CMP_GT_OQ);
+            __mmask8 ak = _mm512_cmp_pd_mask(av, zero, _CMP_GT_OQ);
+            __m512d bp = _mm512_mask_i64gather_pd(zero, bk, idx,
+                base + offsetof(TickRecord, bid_price) + l * sizeof(double), 1);
+            __m512d ap = _mm512_mask_i64gather_pd(zero, ak, idx,
+                base + offsetof(TickRecord, ask_price) + l * sizeof(double), 1);
+            const __m512d w = _mm512_set1_pd(weight_[l]);
+
+            if (l == 0) { b0 = bp; a0 = ap; bv0 = bv; av0 = av; }
+            bd = _mm512_add_pd(bd, bv);
+            ad = _mm512_add_pd(ad, av);
+            bpv = _mm512_fmadd_pd(bp, bv, bpv);
+            apv = _mm512_fmadd_pd(ap, av, apv);
+            bw = _mm512_fmadd_pd(w, bv, bw);
+            aw = _mm512_fmadd_pd(w, av, aw);
+        }
+
+        __mmask8 bk = _mm512_cmp_pd_mask(bd, zero, _CMP_GT_OQ);
+        __mmask8 ak = _mm512_cmp_pd_mask(ad, zero, _CMP_GT_OQ);
+        __mmask8 both = _mm512_cmp_pd_mask(b0, zero, _CMP_GT_OQ) & _mm512_cmp_pd_mask(a0, zero, _CMP_GT_OQ);
+        __m512d wsum = _mm512_add_pd(bw, aw);
+        __mmask8 wk = _mm512_cmp_pd_mask(wsum, zero, _CMP_GT_OQ);
+
+        alignas(64) double f[10][8];
+        __m512d mid = _mm512_maskz_mul_pd(both, _mm512_add_pd(b0, a0), _mm512_set1_pd(0.5));
+        __m512d bvw = _mm512_maskz_div_pd(bk, bpv, bd);
+        __m512d avw = _mm512_maskz_div_pd(ak, apv, ad);
+        _mm512_store_pd(f[0], _mm512_maskz_div_pd(wk, _mm512_sub_pd(bw, aw), wsum));
+        _mm512_store_pd(f[1], _mm512_mask_div_pd(mid, both,
+            _mm512_fmadd_pd(b0, av0, _mm512_mul_pd(a0, bv0)), _mm512_add_pd(bv0, av0)));
+        _mm512_store_pd(f[2], mid);
+        _mm512_store_pd(f[3], bvw);
+        _mm512_store_pd(f[4], avw);
+        _mm512_store_pd(f[5], _mm512_maskz_sub_pd(bk & ak, avw, bvw));
+        _mm512_store_pd(f[6], _mm512_maskz_div_pd(bk, _mm512_sub_pd(b0, bvw), bd));
+        _mm512_store_pd(f[7], _mm512_maskz_div_pd(ak, _mm512_sub_pd(avw, a0), ad));
+        _mm512_store_pd(f[8], bd);
+        _mm512_store_pd(f[9], ad);
+        scatter(f[0], 8, out);
+    }
+#endif
+
+private:
+    static inline long long offset(const char* base, const TickRecord* t) {
+        return reinterpret_cast<const char*>(t) - base;
+    }
+
+    // 列式中间结果 (f[field][lane]) 写回 AoS 输出
+    static inline void scatter(const double* f, int lanes, BookFeatures* out) {
+        for (int j = 0; j < lanes; ++j) {
+            double* o = reinterpret_cast<double*>(&out[j]);
+            for (int k = 0; k < 10; ++k) o[k] = f[k * lanes + j];
+        }
+    }
+
+    static inline double valid_price(double price, double volume) {
+        return volume > 0.0 ? price : 0.0;
+    }
+
+#if defined(__AVX2__)
+    static inline __m128d hsum2(__m256d b, __m256d a) {
+        __m256d h = _mm256_hadd_pd(b, a);  // [b0+b1, a0+a1, b2+b3, a2+a3]
+        return _mm_add_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+    }
+#endif
+
+    static inline void finish(const TickRecord& t, double bd, double ad, double bpv, double apv,
+                              double bw, double aw, BookFeatures& out) {
+        double b0 = t.bid_volume[0] > 0 ? t.bid_price[0] : 0.0;
+        double a0 = t.ask_volume[0] > 0 ? t.ask_price[0] : 0.0;
+        double bv0 = t.bid_volume[0];
+        double av0 = t.ask_volume[0];
+
+        out.imbalance = (bw + aw) > 0.0 ? (bw - aw) / (bw + aw) : 0.0;
+        out.mid = (b0 > 0.0 && a0 > 0.0) ? (b0 + a0) * 0.5 : 0.0;
+        out.microprice = (b0 > 0.0 && a0 > 0.0) ? (b0 * av0 + a0 * bv0) / (bv0 + av0) : out.mid;
+        out.bid_vwap = bd > 0.0 ? bpv / bd : 0.0;
+        out.ask_vwap = ad > 0.0 ? apv / ad : 0.0;
+        out.weighted_spread = (bd > 0.0 && ad > 0.0) ? out.ask_vwap - out.bid_vwap : 0.0;
+        out.bid_slope = bd > 0.0 ? (b0 - out.bid_vwap) / bd : 0.0;
+        out.ask_slope = ad > 0.0 ? (out.ask_vwap - a0) / ad : 0.0;
+        out.bid_depth = bd;
+        out.ask_depth = ad;
+    }
+
+    int levels_;
+    double mask_[8];
+    double weight_[8];
+};
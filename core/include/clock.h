@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/**
+ * IClock: 引擎统一时间源
+ *
+ * 由 HftEngine 创建并安装 (默认 TscClock)，模块通过 IClock::instance() 或 ITimerService::clock() 读取。
+ * 回放 (回测) 时 ReplayModule 安装 SimClock，随发布的 Tick 推进，策略、风控与定时器读到的是行情时间，
+ * 回测结果与机器时间、回放速度无关。
+ * 时分秒与日期均由 now_ns() 加缓存的时区偏移算出，热路径不调用 localtime。
+ */
+class IClock {
+public:
+    virtual ~IClock() = default;
+
+    // 单例访问点 (未安装时为墙上时钟)
+    static IClock& instance();
+    static void set_instance(IClock* inst);
+
+    virtual uint64_t now_ns() const = 0;  // Unix 纪元纳秒
+    virtual bool simulated() const { return false; }
+
+    // 本地时间当日毫秒 [0, 86400000)
+    uint32_t time_of_day_ms() const;
+    // HHMMSS 形式的本地时间，如 93005
+    uint32_t hhmmss() const;
+    // YYYYMMDD 形式的本地日期
+    uint32_t yyyymmdd() const;
+    // 按国内期货惯例推算的交易日：18:00 之后 (夜盘) 归下一日，周末归下周一；不含节假日日历
+    uint32_t trading_day() const;
+
+    // 本地时区相对 UTC 的偏移 (毫秒，进程启动时取一次)
+    static int64_t tz_offset_ms();
+};
+
+// 墙上时钟 (clock_gettime vDSO)
+class WallClock : public IClock {
+public:
+    uint64_t now_ns() const override;
+};
+
+/**
+ * TscClock: TSC 校准的实时时钟
+ *
+ * 构造时以 CLOCK_REALTIME 为参照校准 TSC 频率，读取只需 rdtsc + 128 位乘法 (约 10ns，无系统调用)。
+ * resync() 由单个线程 (Engine 主循环) 周期调用：以启动以来的长窗口修正频率并重新锚定，
+ * 参数经 SeqLock 发布，任意线程可无锁读取。实时钟回拨时不跟随回退而是短暂放慢，now_ns() 单调不减。
+ * 需要 invariant TSC，supported() 为 false 时应改用 WallClock。
+ */
+class TscClock : public IClock {
+public:
+    TscClock();
+
+    static bool supported();
+
+    uint64_t now_ns() const override;
+    void resync();
+
+    double ghz() const;
+
+private:
+    struct Params {
+        uint64_t base_tsc;
+        uint64_t base_ns;
+        uint64_t mult;  // 每个 TSC 周期的纳秒数 * 2^32
+    };
+
+    static void sample(uint64_t& tsc, uint64_t& ns);
+
+    alignas(64) std::atomic<uint32_t> seq_{0};
+    Params params_{};
+
+    // 首次校准锚点 (仅 resync 线程访问)
+    uint64_t origin_tsc_ = 0;
+    uint64_t origin_ns_ = 0;
+};
+
+/**
+ * SimClock: 由行情时间驱动的模拟时钟
+ *
+ * 单写者 (回放线程) 调用 advance，时间只进不退；任意线程可读。
+ * 夜盘 Tick (>=18:00) 归到交易日前一自然日，节假日前的夜盘按前一日近似处理。
+ * 跨越整秒时在写者线程同步回调 on_second，Engine 借此在行情流中确定性地触发定时任务。
+ */
+class SimClock : public IClock {
+public:
+    // update_time 为 HHMMSSmmm
+    void advance(uint32_t trading_day, uint64_t update_time);
+    void reset();
+
+    uint64_t now_ns() const override { return ns_.load(std::memory_order_acquire); }
+    bool simulated() const override { return true; }
+
+    // 参数为新的纪元秒；须在回放开始前设置
+    void set_on_second(std::function<void(uint64_t)> cb) { on_second_ = std::move(cb); }
+
+private:
+    std::atomic<uint64_t> ns_{0};
+
+    // 交易日零点的纪元秒 (仅写者访问)
+    uint32_t cached_day_ = 0;
+    int64_t day_base_s_ = 0;
+    uint64_t last_sec_ = 0;
+    std::function<void(uint64_t)> on_second_;
+};
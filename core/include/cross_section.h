@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <immintrin.h>
+
+/**
+ * CrossSection: 截面因子矩阵 (合约 x 因子，按因子列存储 SoA)
+ *
+ * values[f * capacity + slot] 为合约 slot 的第 f 个因子，同一因子在所有合约上连续，
+ * 截面均值 / 方差 / z-score 线性组合按列向量化计算。合约是否就绪 (全部因子都已收到) 以 0/1 掩码列参与运算，
+ * 无需按就绪合约收集下标再 gather。编译期按 __AVX2__ 选择实现，否则回退标量 (结果一致到舍入误差)。
+ *
+ * 槽位与因子数在 init / add_slot 时确定，score() 不分配内存。因子数上限 64 (就绪位图为 uint64_t)。
+ */
+class CrossSection {
+public:
+    static constexpr size_t MAX_FACTORS = 64;
+
+    void init(size_t factors, size_t capacity) {
+        factors_ = std::min(factors, MAX_FACTORS);
+        full_mask_ = factors_ == 64 ? ~0ULL : ((1ULL << factors_) - 1);
+        slots_ = 0;
+        reserve(capacity);
+    }
+
+    // 新增一个槽位 (合约)，返回槽位号；超出容量时按倍增重排
+    size_t add_slot() {
+        if (slots_ == capacity_) reserve(std::max<size_t>(capacity_ * 2, 64));
+        return slots_++;
+    }
+
+    void set(size_t slot, size_t factor, double value) {
+        values_[factor * capacity_ + slot] = value;
+        uint64_t& m = seen_[slot];
+        m |= 1ULL << factor;
+        ready_[slot] = m == full_mask_ ? 1.0 : 0.0;
+    }
+
+    bool ready(size_t slot) const { return ready_[slot] != 0.0; }
+    double value(size_t slot, size_t factor) const { return values_[factor * capacity_ + slot]; }
+    size_t slots() const { return slots_; }
+    size_t factors() const { return factors_; }
+
+    // 对就绪合约做截面 z-score 并按 weights 线性组合：
+    // scores[s] = sum_f w_f * (v[f][s] - mean_f) / std_f (std_f <= eps 时该因子记 0)
+    // 返回就绪合约数；未就绪槽位的 scores 无意义
+    size_t score(const double* weights, double* scores, double eps = 1e-9) const {
+        const size_t n = slots_;
+        const double cnt = sum(ready_.data(), n);
+        std::fill(scores, scores + n, 0.0);
+        if (cnt < 1.0) return 0;
+
+        for (size_t f = 0; f < factors_; ++f) {
+            const double* col = &values_[f * capacity_];
+            const double mean = masked_sum(col, ready_.data(), n) / cnt;
+            const double var = masked_sq_dev(col, ready_.data(), n, mean) / cnt;
+            const double sd = std::sqrt(var);
+            if (!(sd > eps)) continue;
+            axpy_centered(scores, col, n, weights[f] / sd, mean);
+        }
+        return static_cast<size_t>(cnt);
+    }
+
+    // 从 candidates 中选出得分最高的 k 个放到前 k 位、最低的 k 个放到后 k 位 (2k <= size，各组内部无序)
+    static void select_extremes(std::vector<uint32_t>& candidates, const double* scores, size_t k) {
+        const size_t n = candidates.size();
+        if (k == 0 || 2 * k > n) return;
+        auto desc = [scores](uint32_t a, uint32_t b) {
+            return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+        };
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), desc);
+        std::nth_element(candidates.begin() + k, candidates.end() - k, candidates.end(), desc);
+    }
+
+private:
+    void reserve(size_t capacity) {
+        if (capacity <= capacity_) return;
+        std::vector<double> values(factors_ * capacity, 0.0);
+        for (size_t f = 0; f < factors_; ++f) {
+            std::copy(values_.begin() + f * capacity_, values_.begin() + f * capacity_ + slots_,
+                      values.begin() + f * capacity);
+        }
+        values_.swap(values);
+        seen_.resize(capacity, 0);
+        ready_.resize(capacity, 0.0);
+        capacity_ = capacity;
+    }
+
+    static double sum(const double* x, size_t n) {
+        size_t i = 0;
+        double s = 0.0;
+#if defined(__AVX2__)
+        __m256d acc = _mm256_setzero_pd();
+        for (; i + 4 <= n; i += 4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(x + i));
+        s = hsum(acc);
+#endif
+        for (; i < n; ++i) s += x[i];
+        return s;
+    }
+
+    static double masked_sum(const double* x, const double* m, size_t n) {
+        size_t i = 0;
+        double s = 0.0;
+#if defined(__AVX2__)
+        __m256d acc = _mm256_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(m + i)));
+        }
+        s = hsum(acc);
+#endif
+        for (; i < n; ++i) s += x[i] * m[i];
+        return s;
+    }
+
+    static double masked_sq_dev(const double* x, const double* m, size_t n, double mean) {
+        size_t i = 0;
+        double s = 0.0;
+#if defined(__AVX2__)
+        const __m256d mu = _mm256_set1_pd(mean);
+        __m256d acc = _mm256_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), mu);
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(d, d), _mm256_loadu_pd(m + i)));
+        }
+        s = hsum(acc);
+#endif
+        for (; i < n; ++i) {
+            double d = x[i] - mean;
+            s += d * d * m[i];
+        }
+        return s;
+    }
+
+    // y += a * (x - mean)
+    static void axpy_centered(double* y, const double* x, size_t n, double a, double mean) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256d va = _mm256_set1_pd(a);
+        const __m256d mu = _mm256_set1_pd(mean);
+        for (; i + 4 <= n; i += 4) {
+            __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), mu);
+            _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(va, d)));
+        }
+#endif
+        for (; i < n; ++i) y[i] += a * (x[i] - mean);
+    }
+
+#if defined(__AVX2__)
+    static double hsum(__m256d v) {
+        __m128d lo = _mm256_castpd256_pd128(v);
+        __m128d hi = _mm256_extractf128_pd(v, 1);
+        lo = _mm_add_pd(lo, hi);
+        return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+#endif
+
+    size_t factors_ = 0;
+    size_t capacity_ = 0;
+    size_t slots_ = 0;
+    uint64_t full_mask_ = 0;
+    std::vector<double> values_;   // [factor][capacity]
+    std::vector<uint64_t> seen_;   // 每槽位已收到的因子位图
+    std::vector<double> ready_;    // 0/1 就绪掩码，直接参与向量运算
+};
+
+/**
+ * BarBarrier: K 线收线屏障，每根 Bar (bar_key) 至多触发一次
+ *
+ * 每个合约的同一根 Bar 到达时调用 arrive()：上一根 Bar 到达过的合约 (期望集合) 全部到达本根即触发，
+ * 按槽位判断而非计数，本根新出现的合约不会顶替未到的合约提前触发。
+ * 期望集合中有合约本根未成交 (不产生 K 线) 时，下一根 Bar 的首根 K 线到达时补触发。早于当前 Bar 的迟到 K 线被忽略。
+ * 第一根 Bar 没有期望集合，在下一根 Bar 开始时触发。
+ */
+class BarBarrier {
+public:
+    void resize(size_t slots) { stamp_.resize(slots, 0); }
+
+    // slot < 0 (不在截面内的合约) 只推进 Bar，不计入到达数
+    bool arrive(uint64_t bar_key, int slot) {
+        bool fire = false;
+        if (bar_key > cur_key_) {
+            fire = cur_key_ != 0 && !fired_;  // 上一根未到齐：新 Bar 开始即补触发
+            // 期望集合 = stamp_ 仍为上一根 bar_key 的槽位
+            prev_key_ = cur_key_;
+            expected_ = arrived_;
+            pending_ = arrived_;
+            arrived_ = 0;
+            cur_key_ = bar_key;
+            fired_ = false;
+        } else if (bar_key < cur_key_) {
+            return false;
+        }
+
+        if (slot >= 0) {
+            if (static_cast<size_t>(slot) >= stamp_.size()) stamp_.resize(static_cast<size_t>(slot) + 1, 0);
+            if (stamp_[slot] != bar_key) {
+                if (prev_key_ != 0 && stamp_[slot] == prev_key_) --pending_;
+                stamp_[slot] = bar_key;
+                ++arrived_;
+            }
+        }
+        if (!fired_ && expected_ > 0 && pending_ == 0) {
+            fired_ = true;
+            fire = true;
+        }
+        return fire;
+    }
+
+    uint64_t current() const { return cur_key_; }
+    size_t arrived() const { return arrived_; }
+    size_t expected() const { return expected_; }
+    size_t pending() const { return pending_; }  // 期望集合中本根尚未到达的合约数
+
+private:
+    std::vector<uint64_t> stamp_;  // 每槽位最近到达的 bar_key
+    uint64_t cur_key_ = 0;
+    uint64_t prev_key_ = 0;
+    size_t arrived_ = 0;
+    size_t expected_ = 0;
+    size_t pending_ = 0;
+    bool fired_ = false;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "protocol.h"
+#include "rolling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 表达式算子 (字节码操作码)
+enum class ExprOp : uint8_t {
+    LOAD_F64,    // a = TickRecord 字段字节偏移
+    LOAD_I32,
+    ADD, SUB, MUL, DIV, MIN, MAX,
+    NEG, ABS, LOG, SQRT, SIGN,
+    CLIP,        // clip(x, lo, hi)
+    // 有状态算子：PUSH_* 每 Tick 更新一次状态 (同一状态被多处读取时只推进一次)，读取算子引用对应 PUSH 的结果
+    PUSH_SUM,    // RollingSum
+    PUSH_STATS,  // RollingStats
+    PUSH_MINMAX, // RollingMinMax
+    PUSH_CORR,   // RollingCorr (x, y)
+    SMA, SUM, STD, ZSCORE, TSMIN, TSMAX, CORR,
+    EMA,         // Ema (推进并读取)
+    DELAY        // N 个样本之前的值
+};
+
+struct ExprInstr {
+    ExprOp op;
+    uint32_t dst;      // 结果寄存器
+    uint32_t a, b, c;  // 操作数寄存器 (LOAD 为字段偏移)
+    uint32_t state;    // 有状态算子的状态下标
+};
+
+// 单个合约的求值状态：寄存器 (常量已预置) + 各类增量算子
+struct ExprState {
+    std::vector<double> regs;
+    std::vector<RollingSum> sums;
+    std::vector<RollingStats> stats;
+    std::vector<RollingMinMax> minmax;
+    std::vector<RollingCorr> corrs;
+    std::vector<Ema> emas;
+    std::vector<RollingWindow> delays;
+};
+
+/**
+ * ExprProgram: 表达式因子编译器 + 字节码解释器 (无 JIT，无需重新编译插件)
+ *
+ * 一组因子 (名称 -> 表达式) 编译为一段扁平字节码：
+ *   - 解析为表达式树后按 (算子, 操作数, 窗口) 哈希合并，因子之间的公共子表达式只算一次；
+ *     有状态算子的状态同样按 (种类, 输入, 窗口) 共享，如 std(mid,50) 与 zscore(mid,50) 共用一个 RollingStats。
+ *   - 纯算子的常量子树在编译期折叠；常量占用寄存器并在 make_state() 时预置，不生成指令。
+ *   - 指令按拓扑序排列，eval() 一次顺序执行，无递归、无分配。
+ * 程序在合约之间共享，每个合约一份 ExprState (寄存器 + 滚动窗口)。
+ *
+ * 语法：
+ *   + - * / 一元负号 括号 数字常量
+ *   字段: last volume turnover oi open high low pre_close upper_limit lower_limit vol_delta turnover_delta
+ *         bid[i] ask[i] bid_vol[i] ask_vol[i] (i = 0..4)；mid = (bid[0]+ask[0])/2，spread = ask[0]-bid[0]
+ *   函数: abs log sqrt sign min(a,b) max(a,b) clip(x,lo,hi)
+ *         ema(x,N) sma(x,N) sum(x,N) std(x,N) zscore(x,N) tsmin(x,N) tsmax(x,N) corr(x,y,N) delay(x,N) delta(x[,N])
+ *   N 为正整数常量。ema 取 alpha = 2/(N+1)，首个样本为初值；其余窗口算子在窗口满之前输出 NaN。
+ * NaN 沿表达式传播；有状态算子的输入为 NaN / Inf 时本 Tick 不更新状态并输出 NaN，调用方只发布有限值。
+ */
+class ExprProgram {
+public:
+    // 编译失败 (语法错误、未知字段 / 函数、非法窗口) 抛出 std::invalid_argument，消息含因子名与出错位置
+    explicit ExprProgram(const std::vector<std::pair<std::string, std::string>>& factors);
+
+    ExprState make_state() const;
+
+    // 求值全部因子，out[i] 对应第 i 个因子
+    void eval(const TickRecord& tick, ExprState& s, double* out) const;
+
+    size_t factor_count() const { return names_.size(); }
+    const std::string& factor_name(size_t i) const { return names_[i]; }
+    size_t instr_count() const { return code_.size(); }
+    size_t register_count() const { return consts_.size(); }
+
+    // 反汇编 (调试 / 日志)
+    std::string dump() const;
+
+private:
+    class Compiler;
+
+    std::vector<std::string> names_;
+    std::vector<uint32_t> outputs_;   // 因子 -> 结果寄存器
+    std::vector<ExprInstr> code_;
+    std::vector<double> consts_;      // 寄存器初值 (非常量寄存器为 0)
+
+    // 各类状态的窗口长度 (ExprInstr::state 为下标)
+    std::vector<uint32_t> sum_windows_;
+    std::vector<uint32_t> stats_windows_;
+    std::vector<uint32_t> minmax_windows_;
+    std::vector<uint32_t> corr_windows_;
+    std::vector<uint32_t> ema_spans_;
+    std::vector<uint32_t> delay_windows_;
+};
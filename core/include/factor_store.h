@@ -0,0 +1,123 @@
+#pragma once
+
+#include "protocol.h"
+#include "mmap_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 因子日志记录：<base>.dat/.meta 为 MmapReader<FactorLogRecord> 可读的追加日志，行列编号的名称见 <base>.names
+struct FactorLogRecord {
+    uint32_t trading_day; // 交易日 YYYYMMDD (写者 set_trading_day，未设置为 0)
+    uint32_t timestamp;   // 信号时间 (SignalRecord::timestamp，因子节点填 Tick 的 HHMMSSmmm)
+    uint32_t symbol_idx;  // FactorStore 行号
+    uint32_t factor_idx;  // FactorStore 列号
+    double value;
+};
+static_assert(sizeof(FactorLogRecord) == 24, "FactorLogRecord layout is part of the log format");
+
+// 单元格快照
+struct FactorValue {
+    double value = 0.0;
+    uint64_t timestamp = 0;
+    uint64_t seq = 0;     // 写入时的全局更新序号，0 表示从未写入
+};
+
+/**
+ * FactorStore: 因子最新值表 (共享内存) + 追加日志
+ *
+ * 共享内存 (/dev/shm/<name>)：
+ *   [Header 4KB] [因子名表 max_factors x 32B] [合约名表 max_symbols x 32B] [单元格 max_symbols x max_factors]
+ * 单元格按 合约 x 因子 稠密平铺 (同一合约的各因子相邻)，每格独立 seqlock，读者无锁读取任意 (合约, 因子) 的最新值。
+ * 行列编号由写者按首次出现顺序分配，名称写入名表后以 release 发布计数，其他进程按名称查找编号。
+ *
+ * 追加日志 (可选，open_log)：每次更新追加一条 FactorLogRecord，名称表 <base>.names 记录编号对应的合约 / 因子名，
+ * 重启后沿用已有编号继续追加；离线工具 (read_factors) 可按流重放、比较不同版本重算的结果。
+ *
+ * 单写者 (FactorStoreModule)，任意进程多读者。
+ */
+class FactorStore {
+public:
+    static constexpr size_t NAME_LEN = 32;
+
+    // writer 为 true 时创建 (或重置) 共享内存并成为唯一写者；读者挂载已有共享内存，不存在或格式不符时抛出 runtime_error
+    FactorStore(const std::string& shm_name, bool writer, uint32_t max_symbols = 4096, uint32_t max_factors = 64);
+    ~FactorStore();
+
+    FactorStore(const FactorStore&) = delete;
+    FactorStore& operator=(const FactorStore&) = delete;
+
+    // ---------- 写入 (单写者) ----------
+    // 打开追加日志 <base>.dat/.meta 与名称表 <base>.names，须在首次更新前调用；已有名称表时按其顺序预分配编号
+    bool open_log(const std::string& base_path, uint64_t capacity);
+
+    // 编号：首次出现时分配，表满返回 -1
+    int symbol_index(const char* symbol);
+    int factor_index(const char* name);
+
+    // 此后写入日志的记录所属交易日：timestamp 只有时分秒，夜盘与次日日盘靠它区分
+    void set_trading_day(uint32_t trading_day) { trading_day_ = trading_day; }
+
+    void update(int symbol_idx, int factor_idx, double value, uint64_t timestamp);
+    bool update(const SignalRecord& sig);  // 按名称定位后写入，表满返回 false
+
+    // 日志已满 / 表满而未能记录的更新数
+    uint64_t dropped() const { return dropped_; }
+    uint64_t logged() const { return logged_; }
+
+    // ---------- 读取 (任意进程) ----------
+    bool read(int symbol_idx, int factor_idx, FactorValue& out) const;
+
+    int find_symbol(const char* symbol) const;
+    int find_factor(const char* name) const;
+    uint32_t symbols() const;
+    uint32_t factors() const;
+    const char* symbol_name(uint32_t idx) const;
+    const char* factor_name(uint32_t idx) const;
+    uint32_t max_symbols() const { return max_symbols_; }
+    uint32_t max_factors() const { return max_factors_; }
+
+    // 全局更新序号：每次更新 +1，读者据此判断是否有新值
+    uint64_t update_seq() const;
+
+    // 读取日志名称表 (离线工具用)：下标即编号
+    static bool load_names(const std::string& base_path, std::vector<std::string>* symbols,
+                           std::vector<std::string>* factors);
+
+private:
+    struct Header;
+    struct Cell;
+
+    int assign(bool symbol, const char* name);
+    Cell& cell(int symbol_idx, int factor_idx) const;
+
+    std::string shm_name_;
+    bool writer_;
+    uint32_t max_symbols_;
+    uint32_t max_factors_;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    Header* header_ = nullptr;
+    char* factor_names_ = nullptr;
+    char* symbol_names_ = nullptr;
+    Cell* cells_ = nullptr;
+
+    // 写者私有：名称 -> 编号
+    std::unordered_map<std::string, int> symbol_ids_;
+    std::vector<std::string> factor_list_;
+    char last_symbol_[NAME_LEN] = {};
+    int last_symbol_idx_ = -1;
+    size_t last_factor_ = 0;
+    uint64_t seq_ = 0;
+    uint32_t trading_day_ = 0;
+
+    std::unique_ptr<MmapWriter<FactorLogRecord>> log_;
+    FILE* names_ = nullptr;
+    uint64_t logged_ = 0;
+    uint64_t dropped_ = 0;
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "protocol.h"
+#include "symbol_manager.h"
+#include "tick_normalizer.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef FEED_ARBITER_MAX_FEEDS
+#define FEED_ARBITER_MAX_FEEDS 8
+#endif
+
+#ifndef FEED_ARBITER_OVERFLOW_SLOTS
+#define FEED_ARBITER_OVERFLOW_SLOTS 1024   // 未登记合约槽位数，必须为 2 的幂
+#endif
+
+// 单条行情源的到达统计 (各源回调线程写各自的计数，报告线程随时读取)
+struct FeedStats {
+    alignas(64) std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> first{0};          // 该版本由本源最先送达并发布
+    std::atomic<uint64_t> duplicate{0};      // 其他源已发布同一版本
+    std::atomic<uint64_t> stale{0};          // 其他源已发布更新的版本
+    std::atomic<uint64_t> behind_sum_us{0};  // duplicate 时落后于胜出源的时间
+    std::atomic<uint64_t> behind_max_us{0};
+    std::atomic<int64_t> delay_sum_ms{0};    // 本地接收时刻 - 交易所时间戳
+    std::atomic<uint64_t> delay_count{0};
+    std::atomic<bool> connected{false};
+    std::atomic<uint64_t> disconnects{0};
+};
+
+/**
+ * FeedArbiter: 多路行情源按合约择先发布
+ *
+ * 同一合约的行情版本以 (交易日, 交易时段毫秒序, 累计成交量) 标识，严格大于已发布版本才发布，
+ * 因此各源中最先送达的版本胜出，其余源的同版本计为 duplicate、旧版本计为 stale。
+ *
+ * 失败路径只做一次无锁读取；可能胜出时在自旋锁内复核并执行发布回调，
+ * 保证发布序列对每个合约单调，且下游 (RingBuffer/MmapWriter) 仍只有一个生产者。
+ * 合约状态按 SymbolManager 稠密下标平铺；订阅了但不在 symbols.txt 中的合约 (symbol_id 为 0)
+ * 由 overflow_index() 按合约名分配其后的溢出槽位，同样参与仲裁。
+ */
+class FeedArbiter {
+public:
+    enum Verdict {
+        FIRST = 0,
+        DUPLICATE,
+        STALE
+    };
+
+    explicit FeedArbiter(size_t feeds)
+        : feeds_(std::min<size_t>(feeds, FEED_ARBITER_MAX_FEEDS)),
+          known_(SymbolManager::instance().count()),
+          slots_(new Slot[known_ + OVERFLOW_SLOTS]) {}
+
+    size_t feeds() const { return feeds_; }
+
+    // 交易日内的版本键: 时间为主序、成交量为次序；+1 保证任何合法 Tick 都大于初始值 0。
+    // 夜盘的 session_ms 小于前一交易日的日盘，跨交易日由 arbitrate() 的 trading_day 先行比较
+    static uint64_t make_key(uint64_t update_time, int volume) {
+        return ((TickNormalizer::session_ms(update_time) + 1) << 32) | static_cast<uint32_t>(volume);
+    }
+
+    /**
+     * 未登记合约的仲裁下标 (>= SymbolManager::count())
+     * @param symbol 补零的 32 字节合约名 (InstrumentCache::Entry::symbol)
+     * 首次出现时在锁内登记，之后无锁查找；溢出槽位用尽时返回 -1
+     */
+    int overflow_index(const char* symbol) {
+        size_t h = hash(symbol);
+        for (size_t i = 0; i < OVERFLOW_SLOTS; ++i) {
+            size_t k = (h + i) & (OVERFLOW_SLOTS - 1);
+            OverflowName& e = overflow_[k];
+            if (!e.used.load(std::memory_order_acquire)) {
+                lock();
+                if (!e.used.load(std::memory_order_relaxed)) {
+                    std::memcpy(e.symbol, symbol, sizeof(e.symbol));
+                    e.used.store(true, std::memory_order_release);
+                    unlock();
+                    return static_cast<int>(known_ + k);
+                }
+                unlock();
+            }
+            if (std::memcmp(e.symbol, symbol, sizeof(e.symbol)) == 0) return static_cast<int>(known_ + k);
+        }
+        return -1;
+    }
+
+    /**
+     * 仲裁一条到达的 Tick，胜出时在锁内调用 publish()
+     * @param feed        行情源编号 (0..feeds-1)
+     * @param index       SymbolManager::get_index(symbol_id)，未登记合约取 overflow_index()；
+     *                    仍为 -1 (溢出槽位用尽) 时只发布 0 号源，不做跨源去重但不会重复落盘
+     * @param trading_day 交易日 (YYYYMMDD)，大于已发布版本的交易日时无论 key 大小都视为新版本
+     * @param now_ns      接收时刻 (纳秒)，用于统计落后时间
+     */
+    template <typename PublishFn>
+    Verdict arbitrate(int feed, int index, uint32_t trading_day, uint64_t key, uint64_t now_ns, PublishFn&& publish) {
+        FeedStats& fs = stats_[feed];
+        bump(fs.received);
+
+        if (index < 0) {
+            if (feed != 0) {
+                bump(fs.duplicate);
+                return DUPLICATE;
+            }
+            lock();
+            publish();
+            unlock();
+            bump(fs.first);
+            return FIRST;
+        }
+
+        Slot& s = slots_[index];
+        uint32_t last_day = s.day.load(std::memory_order_acquire);
+        uint64_t last = s.key.load(std::memory_order_acquire);
+        int order = compare(trading_day, key, last_day, last);
+        if (order > 0) {
+            lock();
+            last_day = s.day.load(std::memory_order_relaxed);
+            last = s.key.load(std::memory_order_relaxed);
+            order = compare(trading_day, key, last_day, last);
+            if (order > 0) {
+                s.day.store(trading_day, std::memory_order_relaxed);
+                s.key.store(key, std::memory_order_release);
+                s.first_ns.store(now_ns, std::memory_order_relaxed);
+                publish();
+                unlock();
+                bump(fs.first);
+                return FIRST;
+            }
+            unlock();
+        }
+
+        if (order == 0) {
+            uint64_t first_ns = s.first_ns.load(std::memory_order_relaxed);
+            uint64_t behind_us = now_ns > first_ns ? (now_ns - first_ns) / 1000 : 0;
+            bump(fs.duplicate);
+            fs.behind_sum_us.store(fs.behind_sum_us.load(std::memory_order_relaxed) + behind_us,
+                                   std::memory_order_relaxed);
+            if (behind_us > fs.behind_max_us.load(std::memory_order_relaxed)) {
+                fs.behind_max_us.store(behind_us, std::memory_order_relaxed);
+            }
+            return DUPLICATE;
+        }
+        bump(fs.stale);
+        return STALE;
+    }
+
+    // 记录本地接收时刻与交易所时间戳之差 (毫秒，含两端时钟偏差，仅用于各源之间横向比较)
+    void record_delay(int feed, int64_t delay_ms) {
+        FeedStats& fs = stats_[feed];
+        fs.delay_sum_ms.store(fs.delay_sum_ms.load(std::memory_order_relaxed) + delay_ms, std::memory_order_relaxed);
+        bump(fs.delay_count);
+    }
+
+    void set_connected(int feed, bool up) {
+        FeedStats& fs = stats_[feed];
+        if (!up && fs.connected.load(std::memory_order_relaxed)) {
+            bump(fs.disconnects);
+        }
+        fs.connected.store(up, std::memory_order_relaxed);
+    }
+
+    const FeedStats& stats(int feed) const { return stats_[feed]; }
+
+    std::string stats_string() const {
+        std::ostringstream oss;
+        for (size_t i = 0; i < feeds_; ++i) {
+            const FeedStats& fs = stats_[i];
+            uint64_t recv = fs.received.load(std::memory_order_relaxed);
+            uint64_t first = fs.first.load(std::memory_order_relaxed);
+            uint64_t dup = fs.duplicate.load(std::memory_order_relaxed);
+            uint64_t dc = fs.delay_count.load(std::memory_order_relaxed);
+            if (i > 0) oss << '\n';
+            oss << "feed" << i << (fs.connected.load(std::memory_order_relaxed) ? " up" : " down")
+                << " recv=" << recv
+                << " first=" << first << " (" << (recv ? first * 100 / recv : 0) << "%)"
+                << " dup=" << dup
+                << " stale=" << fs.stale.load(std::memory_order_relaxed)
+                << " behind_avg_us=" << (dup ? fs.behind_sum_us.load(std::memory_order_relaxed) / dup : 0)
+                << " behind_max_us=" << fs.behind_max_us.load(std::memory_order_relaxed)
+                << " delay_avg_ms=" << (dc ? fs.delay_sum_ms.load(std::memory_order_relaxed) / static_cast<int64_t>(dc) : 0)
+                << " disconnects=" << fs.disconnects.load(std::memory_order_relaxed);
+        }
+        return oss.str();
+    }
+
+private:
+    static constexpr size_t OVERFLOW_SLOTS = FEED_ARBITER_OVERFLOW_SLOTS;
+    static_assert((OVERFLOW_SLOTS & (OVERFLOW_SLOTS - 1)) == 0, "FEED_ARBITER_OVERFLOW_SLOTS must be power of 2");
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> key{0};       // 已发布的最新版本 (交易日内)
+        std::atomic<uint32_t> day{0};       // 该版本的交易日
+        std::atomic<uint64_t> first_ns{0};  // 该版本的首达时刻
+    };
+
+    struct OverflowName {
+        std::atomic<bool> used{false};
+        char symbol[32];
+    };
+
+    // FNV-1a，与 InstrumentCache 相同
+    static size_t hash(const char* symbol) {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < 32 && symbol[i]; ++i) {
+            h ^= static_cast<unsigned char>(symbol[i]);
+            h *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    // 与已发布版本比较：>0 更新，0 同版本，<0 更旧
+    static int compare(uint32_t day, uint64_t key, uint32_t last_day, uint64_t last_key) {
+        if (day != last_day) return day > last_day ? 1 : -1;
+        return key > last_key ? 1 : (key == last_key ? 0 : -1);
+    }
+
+    static void bump(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void lock() {
+        while (lock_.exchange(true, std::memory_order_acquire)) {
+            while (lock_.load(std::memory_order_relaxed)) {
+                _mm_pause();
+            }
+        }
+    }
+    void unlock() { lock_.store(false, std::memory_order_release); }
+
+    size_t feeds_;
+    size_t known_;
+    std::unique_ptr<Slot[]> slots_;
+    OverflowName overflow_[OVERFLOW_SLOTS];
+    FeedStats stats_[FEED_ARBITER_MAX_FEEDS];
+    alignas(64) std::atomic<bool> lock_{false};
+};
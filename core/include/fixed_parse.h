@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * 定长字符串解析 (SWAR)
+ * 输入格式固定 (CTP 的 TradingDay / UpdateTime)，调用方需保证至少 8 字节可读。
+ * 数字与分隔符按 8 字节整体掩码校验，再检查取值范围；空串、短串、非数字或越界时返回 false，out 不变。
+ */
+
+// mask 覆盖的每个字节均为 '0'..'9'：高半字节为 3，且低半字节 +6 不进位 (即 <= 9)
+inline bool fixed_all_digits(uint64_t v, uint64_t mask) {
+    const uint64_t hi = 0xF0F0F0F0F0F0F0F0ULL & mask;
+    const uint64_t zero = 0x3030303030303030ULL & mask;
+    return (v & hi) == zero && ((v + (0x0606060606060606ULL & mask)) & hi) == zero;
+}
+
+// "YYYYMMDD" -> YYYYMMDD (月 01-12，日 01-31)
+inline bool parse_yyyymmdd(const char* s, uint32_t& out) {
+    uint64_t v;
+    std::memcpy(&v, s, 8);
+    if (!fixed_all_digits(v, ~0ULL)) return false;
+    v -= 0x3030303030303030ULL;
+    // 小端：低字节为首位数字，逐级两两合并 (1 位 -> 2 位 -> 4 位 -> 8 位)
+    v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFULL;
+    v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFULL;
+    v = (v * 10000 + (v >> 32)) & 0x00000000FFFFFFFFULL;
+    const uint32_t ymd = static_cast<uint32_t>(v);
+    const uint32_t mm = ymd / 100 % 100, dd = ymd % 100;
+    if (mm - 1 >= 12 || dd - 1 >= 31) return false;
+    out = ymd;
+    return true;
+}
+
+// "HH:MM:SS" -> HHMMSS (时 00-23，分秒 00-59)
+inline bool parse_hhmmss(const char* s, uint32_t& out) {
+    constexpr uint64_t COLONS = 0x0000FF0000FF0000ULL;  // 第 2、5 字节
+    uint64_t v;
+    std::memcpy(&v, s, 8);
+    if ((v & COLONS) != 0x00003A00003A0000ULL || !fixed_all_digits(v, ~COLONS)) return false;
+    v -= 0x3030303030303030ULL;
+    uint32_t hh = static_cast<uint32_t>((v & 0xFF) * 10 + ((v >> 8) & 0xFF));
+    uint32_t mm = static_cast<uint32_t>(((v >> 24) & 0xFF) * 10 + ((v >> 32) & 0xFF));
+    uint32_t ss = static_cast<uint32_t>(((v >> 48) & 0xFF) * 10 + ((v >> 56) & 0xFF));
+    if (hh >= 24 || mm >= 60 || ss >= 60) return false;
+    out = hh * 10000 + mm * 100 + ss;
+    return true;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * ForkJoinPool: 常驻工作线程的同步并行执行 (fork-join)
+ *
+ * run(n, fn) 把 fn(0) .. fn(n-1) 分给工作线程与调用线程共同执行，全部完成后返回；调用方的写入对任务可见，
+ * 任务的写入在 run 返回后对调用方可见。任务下标按原子计数动态领取，不分配内存，适合每条行情一次的细粒度并行。
+ *
+ * 空闲工作线程先自旋 spin 轮 (期间 run 的唤醒延迟为百纳秒级)，之后让出并阻塞在条件变量上，不长期占满核。
+ * 同一时刻只允许一个线程调用 run。
+ */
+class ForkJoinPool {
+public:
+    explicit ForkJoinPool(size_t threads, uint32_t spin = 1u << 16) : spin_(spin) {
+        for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this] { worker_loop(); });
+    }
+
+    ~ForkJoinPool() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_.store(true);
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    ForkJoinPool(const ForkJoinPool&) = delete;
+    ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+
+    size_t threads() const { return threads_.size(); }
+
+    template <class F>
+    void run(size_t n, F&& fn) {
+        if (threads_.empty() || n <= 1) {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+        ctx_ = &fn;
+        call_ = [](void* ctx, size_t i) { (*static_cast<std::remove_reference_t<F>*>(ctx))(i); };
+        count_ = n;
+        next_.store(0, std::memory_order_relaxed);
+        finished_.store(0, std::memory_order_relaxed);
+        epoch_.fetch_add(1);  // seq_cst：与工作线程登记 sleepers_ 构成 Dekker 配对
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lk(mu_);
+            cv_.notify_all();
+        }
+
+        work();
+        // 等全部工作线程退出本轮 (而非仅任务完成)，保证下一轮改写 ctx_/count_ 时无线程仍在读取
+        const size_t all = threads_.size();
+        for (uint32_t k = 0; finished_.load(std::memory_order_acquire) < all; ++k) backoff(k);
+    }
+
+private:
+    void work() {
+        size_t i;
+        while ((i = next_.fetch_add(1, std::memory_order_relaxed)) < count_) call_(ctx_, i);
+    }
+
+    void worker_loop() {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t e = epoch_.load(std::memory_order_acquire);
+            for (uint32_t k = 0; e == seen && k < spin_; ++k) {
+                if (stop_.load(std::memory_order_relaxed)) return;
+                backoff(k);
+                e = epoch_.load(std::memory_order_acquire);
+            }
+            if (e == seen) {
+                std::unique_lock<std::mutex> lk(mu_);
+                sleepers_.fetch_add(1);
+                cv_.wait(lk, [&] { return stop_.load() || epoch_.load() != seen; });
+                sleepers_.fetch_sub(1);
+                if (stop_.load()) return;
+                e = epoch_.load();
+            }
+            seen = e;
+            work();
+            finished_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    // 自旋等待：每 64 轮让出一次，核数不足 (线程数 > 核数) 时不至于饿死对方
+    static void backoff(uint32_t k) {
+        if ((k & 63) == 63) {
+            std::this_thread::yield();
+            return;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    std::vector<std::thread> threads_;
+    const uint32_t spin_;
+
+    void* ctx_ = nullptr;
+    void (*call_)(void*, size_t) = nullptr;
+    size_t count_ = 0;
+
+    alignas(64) std::atomic<uint64_t> epoch_{0};
+    alignas(64) std::atomic<size_t> next_{0};
+    alignas(64) std::atomic<size_t> finished_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mu_;
+    std::condition_variable cv_;
+};
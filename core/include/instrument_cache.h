@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifndef INSTRUMENT_CACHE_SIZE
+#define INSTRUMENT_CACHE_SIZE 4096   // 必须为 2 的幂，且大于订阅合约数的 2 倍
+#endif
+
+/**
+ * InstrumentCache: 合约代码 -> (symbol_id, 定长 symbol) 的预填充缓存
+ *
+ * 订阅时填充，行情回调中只做一次短哈希 + 32 字节比较，
+ * 命中后可直接 memcpy 已补零的 32 字节 symbol，免去 strncpy 与 std::string 哈希表查找。
+ * 开放寻址、线性探测、不支持删除；单线程使用 (CTP 回调线程)。
+ */
+class InstrumentCache {
+public:
+    struct Entry {
+        char symbol[32];     // 已补零，可直接整体拷贝到 TickRecord::symbol
+        uint64_t symbol_id;
+        bool used;
+    };
+
+    InstrumentCache() { std::memset(entries_, 0, sizeof(entries_)); }
+
+    // 返回已存在或新插入的条目；表满时返回 nullptr
+    const Entry* insert(const char* instrument, uint64_t symbol_id) {
+        char key[32];
+        size_t len = make_key(instrument, key);
+        for (size_t i = 0, h = hash(key, len); i < CAPACITY; ++i, ++h) {
+            Entry& e = entries_[h & (CAPACITY - 1)];
+            if (!e.used) {
+                std::memcpy(e.symbol, key, sizeof(key));
+                e.symbol_id = symbol_id;
+                e.used = true;
+                ++size_;
+                return &e;
+            }
+            if (std::memcmp(e.symbol, key, sizeof(key)) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    inline const Entry* find(const char* instrument) const {
+        char key[32];
+        size_t len = make_key(instrument, key);
+        for (size_t i = 0, h = hash(key, len); i < CAPACITY; ++i, ++h) {
+            const Entry& e = entries_[h & (CAPACITY - 1)];
+            if (!e.used) return nullptr;
+            if (std::memcmp(e.symbol, key, sizeof(key)) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    static constexpr size_t CAPACITY = INSTRUMENT_CACHE_SIZE;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "INSTRUMENT_CACHE_SIZE must be power of 2");
+
+    // 截断到 31 字节并补零，与 TickRecord::symbol 的写法一致
+    static inline size_t make_key(const char* instrument, char* key) {
+        size_t len = strnlen(instrument, 31);
+        std::memset(key, 0, 32);
+        std::memcpy(key, instrument, len);
+        return len;
+    }
+
+    // FNV-1a，合约代码通常不超过 8 字节
+    static inline size_t hash(const char* key, size_t len) {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= static_cast<unsigned char>(key[i]);
+            h *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    Entry entries_[CAPACITY];
+    size_t size_ = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "protocol.h"
+#include "trading_session.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// K 线规格：时间线 "15s" / "1m" / "5m" / "1h" / "1d"，Tick 线 "t500"，量线 "v1000" (手)，额线 "d5000" (万元)
+struct KlineSpec {
+    KlineType type = KLINE_TIME;
+    uint32_t size = 60;       // 时间线为秒数 (日线 86400)，其余为阈值 N
+    std::string label;        // 规范化名称，用于文件名与日志
+
+    bool daily() const { return type == KLINE_TIME && size >= 86400; }
+
+    static bool parse(const std::string& text, KlineSpec& out);
+    // 逗号分隔的规格列表，如 "1m,5m,1h,1d,v1000"
+    static bool parse_list(const std::string& text, std::vector<KlineSpec>& out);
+    // 由记录还原名称 (read_kline 等工具展示用)
+    static std::string label_of(const KlineRecord& k);
+};
+
+/**
+ * KlineEngine: 多周期、按交易时段切分的 K 线合成器
+ *
+ * - 时间线按品种交易日历的「交易时钟」切分 (任意秒/分钟周期，跳过休市，夜盘跨午夜连续)，
+ *   Tick/量/额线在累计达到阈值的那笔 Tick 上收线；所有周期直接由 Tick 合成，不做级联。
+ * - 收线触发：下一根 Bar 的 Tick 到达时立即收线；on_clock() 由定时器驱动，时钟越过 Bar 结束时刻
+ *   close_delay 后收线，不活跃合约不必等待下一笔成交。定时收线之后迟到的 Tick，其成交增量计入下一根 Bar。
+ * - 换交易日或交易日收盘时收掉全部未闭合 Bar (含 Tick/量/额线的残余部分)。
+ * - 合约状态按 SymbolManager 稠密下标平铺，[合约][规格] 连续存放，热路径无字符串构造与哈希查找。
+ *
+ * 非线程安全：on_tick 与 on_clock 跨线程调用时由调用方加锁。
+ */
+class KlineEngine {
+public:
+    using EmitFn = std::function<void(const KlineRecord& bar, size_t spec_index)>;
+
+    KlineEngine(std::vector<KlineSpec> specs, const TradingSessions* sessions, EmitFn emit);
+
+    void on_tick(const TickRecord& tick);
+
+    // 定时收线：time_of_day_ms 为当前本地当日毫秒 (引擎时钟，回放时为模拟时钟)
+    void on_clock(uint32_t time_of_day_ms);
+
+    // 预热：以截面中的累计量为基准，同一交易日的首个 Tick 即可计算增量
+    void seed(const TickRecord& tick);
+
+    // 强制推送全部未闭合 Bar (停止时调用)
+    void flush();
+
+    void set_close_delay_ms(uint32_t ms) { close_delay_ms_ = ms; }
+    const std::vector<KlineSpec>& specs() const { return specs_; }
+
+    uint64_t closed_by_tick() const { return closed_by_tick_; }
+    uint64_t closed_by_timer() const { return closed_by_timer_; }
+    uint64_t late_ticks() const { return late_ticks_; }
+
+private:
+    struct SymbolState {
+        const SessionCalendar* calendar = nullptr;
+        uint32_t trading_day = 0;
+        int last_volume = 0;
+        double last_turnover = 0.0;
+        bool has_base = false;
+        bool any_open = false;
+    };
+
+    struct BarState {
+        KlineRecord bar;
+        uint32_t start_off = 0;    // 交易时钟偏移 [start_off, end_off)
+        uint32_t end_off = 0;
+        uint32_t open_sms = 0;     // 开 Bar 时刻 (交易日毫秒序)
+        uint32_t next_index = 0;   // 时间线：下一根可开的 Bar 序号，更早的视为迟到
+        double accum = 0.0;        // Tick/量/额线的累计量
+        int carry_volume = 0;      // 迟到 Tick 的增量，计入下一根
+        double carry_turnover = 0.0;
+        bool open = false;
+    };
+
+    size_t slot_for(const TickRecord& tick);
+    void open_bar(BarState& b, const KlineSpec& spec, const TickRecord& tick, uint32_t offset, uint32_t sms,
+                  const SessionCalendar& cal);
+    void close_bar(BarState& b, size_t spec_index);
+    void close_symbol(size_t slot);
+
+    std::vector<KlineSpec> specs_;
+    std::vector<uint32_t> period_ms_;   // 时间线周期 (交易时钟毫秒)，非时间线为 0
+    const TradingSessions* sessions_;
+    EmitFn emit_;
+    uint32_t close_delay_ms_ = 2000;
+
+    std::vector<SymbolState> symbols_;
+    std::vector<BarState> bars_;        // [slot * specs_.size() + k]
+    std::unordered_map<std::string, size_t> extra_slots_;  // 未在 symbols.txt 中的合约
+
+    uint64_t closed_by_tick_ = 0;
+    uint64_t closed_by_timer_ = 0;
+    uint64_t late_ticks_ = 0;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "protocol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 一段连续的 K 线 (指向映射文件内部，KlineStore 存活期间有效)
+struct KlineSpan {
+    const KlineRecord* data = nullptr;
+    size_t size = 0;
+
+    const KlineRecord* begin() const { return data; }
+    const KlineRecord* end() const { return data + size; }
+    const KlineRecord& operator[](size_t i) const { return data[i]; }
+    const KlineRecord& back() const { return data[size - 1]; }
+    bool empty() const { return size == 0; }
+};
+
+/**
+ * KlineStore: 按 周期 x 交易日 分文件、文件内按合约分区的 K 线存储
+ *
+ * 文件 <root>/kline_<周期>_<交易日>.kls：
+ *   [Header 4KB] [合约索引 max_symbols 个槽位] [数据区：每个槽位 capacity 条连续 KlineRecord]
+ * 同一合约的 Bar 在文件内连续存放，查询直接返回指向映射区的 KlineSpan，无拷贝；
+ * 按时间查询在合约区内二分 (交易时段毫秒序，夜盘跨午夜单调)。文件按需扩展为稀疏文件，未写入的区域不占磁盘。
+ *
+ * 单写者 (KlineModule / kline_gen) 追加，任意进程多读者：记录写完后以 release 发布槽位计数，读者 acquire 读取。
+ */
+class KlineStore {
+public:
+    // root: 存储目录；writable 为 true 时可追加并按需创建文件
+    explicit KlineStore(std::string root, bool writable = false, uint32_t max_symbols = 0);
+    ~KlineStore();
+
+    KlineStore(const KlineStore&) = delete;
+    KlineStore& operator=(const KlineStore&) = delete;
+
+    // 查询区间键：交易日 + 当日时间 (HHMMSSmmm)，跨日与夜盘均按交易顺序比较
+    static uint64_t key(uint32_t trading_day, uint64_t hhmmssmmm);
+    static uint64_t day_begin(uint32_t trading_day);  // 该交易日第一根 (含夜盘)
+    static uint64_t day_end(uint32_t trading_day);    // 该交易日最后一根
+    static constexpr uint64_t KEY_MAX = ~0ULL;
+
+    // ---------- 写入 (单写者) ----------
+    // interval 为周期名 (KlineSpec::label，如 "1m"/"v1000")；合约区已满或打开失败时返回 false
+    bool append(const KlineRecord& bar, const std::string& interval);
+
+    // ---------- 查询 ----------
+    // [from, to] 内的 Bar，按交易日先后每日一个 span
+    std::vector<KlineSpan> get_bars(uint64_t symbol_id, const std::string& interval,
+                                    uint64_t from, uint64_t to = KEY_MAX);
+    std::vector<KlineSpan> get_bars(const char* symbol, const std::string& interval,
+                                    uint64_t from, uint64_t to = KEY_MAX);
+
+    // 截至 to (含) 的最后 n 根，跨日回溯，按时间先后返回
+    std::vector<KlineSpan> last_bars(uint64_t symbol_id, const std::string& interval, size_t n,
+                                     uint64_t to = KEY_MAX);
+
+    // 某周期某交易日的全部 Bar，每个合约一个 span (按槽位分配顺序)
+    std::vector<KlineSpan> day_bars(const std::string& interval, uint32_t trading_day);
+
+    // 已有数据的交易日 (升序) / 周期
+    std::vector<uint32_t> days(const std::string& interval);
+    std::vector<std::string> intervals();
+
+    // 重新扫描目录 (读者发现新交易日文件)
+    void refresh();
+
+    static std::string path(const std::string& root, const std::string& interval, uint32_t trading_day);
+
+private:
+    struct DayFile;
+
+    DayFile* open_day(const std::string& interval, uint32_t day, bool create, const KlineRecord* proto);
+    std::vector<uint32_t>& day_list(const std::string& interval, uint32_t need_day);
+    void scan();
+
+    std::string root_;
+    bool writable_;
+    uint32_t max_symbols_;
+    std::map<std::pair<std::string, uint32_t>, std::unique_ptr<DayFile>> files_;
+    std::unordered_map<std::string, std::vector<uint32_t>> days_;  // 周期 -> 交易日 (升序)
+    bool scanned_ = false;
+
+    // 写入热路径：上一次追加的文件
+    std::string last_interval_;
+    uint32_t last_day_ = 0;
+    DayFile* last_file_ = nullptr;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "protocol.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+class IClock;
+
+// 报单链路上的打点阶段，顺序即链路顺序
+enum LatencyStage : int {
+    LAT_MD_RECV = 0,   // 录制器收到行情 (TickRecord::recv_ns，跨进程)
+    LAT_MD_PUB,        // Engine 发布行情到 EventBus
+    LAT_STRATEGY,      // 策略收到行情
+    LAT_RISK,          // 风控放行
+    LAT_ORDER_MGR,     // OrderManager 完成装饰
+    LAT_API,           // 调用柜台报单接口前
+    LAT_API_RET,       // 柜台报单接口返回
+    LAT_STAGE_COUNT
+};
+
+// 单笔报单的各阶段时刻 (Unix 纳秒，实时时钟)，0 表示未经过该阶段
+struct OrderLatency {
+    uint64_t client_id;
+    uint64_t symbol_id;             // 触发报单的 Tick 合约，非行情触发时为 0
+    uint64_t ts[LAT_STAGE_COUNT];
+};
+
+class ILatencySink {
+public:
+    virtual ~ILatencySink() = default;
+    // 柜台出口线程调用，实现需自行保证线程安全
+    virtual void on_order(const OrderLatency& lat) = 0;
+};
+
+/**
+ * LatencyTrace: tick-to-order 链路打点
+ *
+ * EventBus 同步分发，行情发布 -> 策略 -> 风控 -> OrderManager -> 柜台 API 在同一线程的调用栈内完成，
+ * 因此触发报单的 Tick 时刻放在线程局部的链路上下文里随调用传递，OrderReq 与录制文件布局都不变。
+ * 时刻取自 Engine 的实时时钟 (TscClock)，回放安装 SimClock 时照常测量。
+ * 未安装 sink 时每个打点只有一次原子读。实现在 hft_core 中，保证各插件共享同一份上下文。
+ */
+class LatencyTrace {
+public:
+    static void set_sink(ILatencySink* sink);
+    static void set_clock(IClock* clock);  // nullptr 恢复为墙上时钟
+    static bool enabled();
+    static uint64_t now_ns();
+
+    // 行情发布线程：开启一条链路；recv_ns 为 0 (历史回放) 时不计行情接收段
+    static void begin_tick(const TickRecord& tick, uint64_t recv_ns);
+    static void end_tick();
+
+    static void stamp(LatencyStage stage);
+
+    // 柜台出口：打 LAT_API_RET 并交给 sink，之后清空报单段，同一 Tick 触发的下一笔报单复用行情段
+    static void egress(const OrderReq& req);
+};
+
+/**
+ * LatencyStats: 默认的统计 sink
+ *
+ * 相邻已打点阶段之差按对数分桶 (每个 2 的幂分 8 档，误差约 12%)，周期打印各段 avg/p50/p99/max 后清零；
+ * 可选逐笔写 CSV (client_id, symbol_id, 各阶段纳秒时刻)。
+ */
+class LatencyStats : public ILatencySink {
+public:
+    explicit LatencyStats(const std::string& csv_path = "") {
+        if (!csv_path.empty()) {
+            csv_.open(csv_path, std::ios::app);
+            if (csv_.tellp() == 0) {
+                csv_ << "client_id,symbol_id,md_recv,md_pub,strategy,risk,order_mgr,api,api_ret\n";
+            }
+        }
+    }
+
+    void on_order(const OrderLatency& lat) override {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ++orders_;
+        int prev = -1;
+        for (int s = 0; s < LAT_STAGE_COUNT; ++s) {
+            if (lat.ts[s] == 0) continue;
+            if (prev >= 0 && lat.ts[s] >= lat.ts[prev]) seg_[s].add(lat.ts[s] - lat.ts[prev]);
+            prev = s;
+        }
+        if (lat.ts[LAT_MD_PUB] && lat.ts[LAT_API] >= lat.ts[LAT_MD_PUB]) {
+            tick_to_api_.add(lat.ts[LAT_API] - lat.ts[LAT_MD_PUB]);
+        }
+        if (lat.ts[LAT_MD_RECV] && lat.ts[LAT_API] >= lat.ts[LAT_MD_RECV]) {
+            recv_to_api_.add(lat.ts[LAT_API] - lat.ts[LAT_MD_RECV]);
+        }
+        if (csv_.is_open()) {
+            csv_ << lat.client_id << ',' << lat.symbol_id;
+            for (int s = 0; s < LAT_STAGE_COUNT; ++s) csv_ << ',' << lat.ts[s];
+            csv_ << '\n';
+        }
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return orders_ == 0;
+    }
+
+    // 本周期统计 (打印后清零)
+    std::string report() {
+        static const char* const names[LAT_STAGE_COUNT] = {
+            "md_recv", "md_in", "strategy", "risk", "order_mgr", "api", "api_call"};
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::ostringstream oss;
+        oss << "orders=" << orders_;
+        for (int s = 1; s < LAT_STAGE_COUNT; ++s) seg_[s].print(oss, names[s]);
+        tick_to_api_.print(oss, "tick_to_api");
+        recv_to_api_.print(oss, "recv_to_api");
+
+        orders_ = 0;
+        for (auto& h : seg_) h.reset();
+        tick_to_api_.reset();
+        recv_to_api_.reset();
+        if (csv_.is_open()) csv_.flush();
+        return oss.str();
+    }
+
+private:
+    struct Histogram {
+        static constexpr int BUCKETS = 8 + 61 * 8;
+        uint64_t counts[BUCKETS] = {0};
+        uint64_t n = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        static int bucket(uint64_t v) {
+            if (v < 8) return static_cast<int>(v);
+            int k = 63 - __builtin_clzll(v);
+            return 8 + (k - 3) * 8 + static_cast<int>((v >> (k - 3)) & 7);
+        }
+        // 桶的上界 (报告分位数时偏保守)
+        static uint64_t upper(int b) {
+            if (b < 8) return static_cast<uint64_t>(b);
+            int k = (b - 8) / 8 + 3;
+            uint64_t sub = static_cast<uint64_t>((b - 8) % 8);
+            return ((8 + sub + 1) << (k - 3)) - 1;
+        }
+
+        void add(uint64_t v) {
+            ++counts[bucket(v)];
+            ++n;
+            sum += v;
+            if (v > max) max = v;
+        }
+        uint64_t percentile(double p) const {
+            uint64_t target = static_cast<uint64_t>(p * n);
+            if (target >= n) target = n - 1;
+            uint64_t acc = 0;
+            for (int b = 0; b < BUCKETS; ++b) {
+                acc += counts[b];
+                if (acc > target) return std::min(upper(b), max);
+            }
+            return max;
+        }
+        void print(std::ostringstream& oss, const char* name) const {
+            if (n == 0) return;
+            oss << " | " << name << " avg=" << sum / n << " p50=" << percentile(0.5)
+                << " p99=" << percentile(0.99) << " max=" << max << "ns";
+        }
+        void reset() { *this = Histogram(); }
+    };
+
+    std::mutex mtx_;
+    uint64_t orders_ = 0;
+    Histogram seg_[LAT_STAGE_COUNT];  // seg_[s]: 上一个已打点阶段 -> s
+    Histogram tick_to_api_;           // 行情发布 -> 调用柜台接口
+    Histogram recv_to_api_;           // 录制器接收 -> 调用柜台接口 (跨进程，含两端时钟偏差)
+    std::ofstream csv_;
+};
@@ -9,6 +9,11 @@
 #define MARKET_SNAPSHOT_MAX_SYMBOLS 2048
 #endif
 
+// SHM 变更日志环形缓冲区容量 (必须为 2 的幂)
+#ifndef MARKET_SNAPSHOT_CHANGE_LOG_SIZE
+#define MARKET_SNAPSHOT_CHANGE_LOG_SIZE 4096
+#endif
+
 struct alignas(64) MarketSnapshotSlot {
     std::atomic<uint32_t> seq{0};  // even=stable, odd=writing
     TickRecord tick;
@@ -32,8 +37,13 @@ public:
     virtual bool get(uint64_t symbol_id, TickRecord& out) const = 0;
     virtual void clear() = 0;
 
+    // 导出全部已写入的槽位 (用于 checkpoint)，返回写入 out 的条数
+    virtual size_t copy_all(TickRecord* out, size_t max_count) const = 0;
+
 protected:
     MarketSnapshot() = default;
+
+    static bool read_slot(const MarketSnapshotSlot& slot, TickRecord& out);
 };
 
 /**
@@ -45,8 +55,16 @@ public:
     void update(const TickRecord& rec) override;
     bool get(uint64_t symbol_id, TickRecord& out) const override;
     void clear() override;
+    size_t copy_all(TickRecord* out, size_t max_count) const override;
 
 private:
+    static constexpr uint64_t SYMBOL_ID_BASE = 10000000;
+
+    // symbols.txt 中的 ID 从 10000001 起，按偏移落槽；小 ID (模拟行情) 直接落槽
+    static uint64_t slot_index(uint64_t symbol_id) {
+        return symbol_id >= SYMBOL_ID_BASE ? symbol_id - SYMBOL_ID_BASE : symbol_id;
+    }
+
     MarketSnapshotSlot slots_[MARKET_SNAPSHOT_MAX_SYMBOLS];
 };
 
@@ -65,17 +83,48 @@ public:
     void update(const TickRecord& rec) override;
     bool get(uint64_t symbol_id, TickRecord& out) const override;
     void clear() override;
+    size_t copy_all(TickRecord* out, size_t max_count) const override;
+
+    // ==========================================
+    // 变更通知 (Reader API)
+    // ==========================================
+
+    // 全局更新序号：每次 update 单调 +1，clear 不会回退
+    uint64_t update_seq() const;
+
+    /**
+     * 收集 since_seq 之后发生过更新的合约 (已去重)
+     * 正常情况下只遍历变更日志 O(changes)；若读者落后超过日志容量则退化为按槽位扫描。
+     * @param out_ids   输出 symbol_id，建议容量 MARKET_SNAPSHOT_MAX_SYMBOLS
+     * @param next_seq  返回本次已覆盖到的序号，作为下一次调用的 since_seq
+     * @return 写入 out_ids 的数量
+     */
+    size_t collect_changes(uint64_t since_seq, uint64_t* out_ids, size_t max_count, uint64_t* next_seq) const;
 
 private:
     static constexpr uint64_t SYMBOL_ID_BASE = 10000000;
     static constexpr size_t SYMBOL_INDEX_SIZE = 65536;
+    static constexpr size_t CHANGE_LOG_MASK = MARKET_SNAPSHOT_CHANGE_LOG_SIZE - 1;
+    static constexpr int CHANGE_SLOT_BITS = 16; // 日志条目低 16 位存槽位，高 48 位存序号
+    static_assert((MARKET_SNAPSHOT_CHANGE_LOG_SIZE & CHANGE_LOG_MASK) == 0, "Change log size must be power of 2");
+    static_assert(MARKET_SNAPSHOT_MAX_SYMBOLS <= (1u << CHANGE_SLOT_BITS), "Slot index must fit in change entry");
 
+    // 注意：新字段只能追加在末尾，rust_tools 按相同前缀布局映射
     struct ShmLayout {
         uint64_t magic;
         int32_t symbol_index[SYMBOL_INDEX_SIZE]; // symbol_id - BASE -> slot_idx
         MarketSnapshotSlot slots[MARKET_SNAPSHOT_MAX_SYMBOLS];
         std::atomic<int32_t> slot_count;
+
+        // --- 变更通知区 ---
+        alignas(64) std::atomic<uint64_t> update_seq;                        // 最新已发布的全局序号
+        std::atomic<uint64_t> slot_update_seq[MARKET_SNAPSHOT_MAX_SYMBOLS];  // 槽位最近一次更新的全局序号
+        uint64_t slot_symbol_id[MARKET_SNAPSHOT_MAX_SYMBOLS];                // 槽位 -> symbol_id
+        std::atomic<uint64_t> change_log[MARKET_SNAPSHOT_CHANGE_LOG_SIZE];   // (seq << 16) | slot
     };
+
+    size_t scan_changes(uint64_t since_seq, uint64_t* out_ids, size_t max_count, uint64_t* next_seq) const;
+
     ShmLayout* layout_ = nullptr;
     bool is_writer_ = false;
     size_t shm_size_ = 0;
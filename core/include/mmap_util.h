@@ -7,6 +7,7 @@
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#include <cstring>
 
 // 元数据头 (4KB 对齐)
 struct MetaHeader {
@@ -66,10 +67,13 @@ public:
             meta_ptr_->capacity = capacity;
             meta_ptr_->write_cursor = 0;
         }
+        pending_cursor_.store(meta_ptr_->write_cursor.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
 
     ~MmapWriter() {
         if (meta_ptr_ && data_ptr_) {
+            publish();
+
             // 获取最终写入位置
             uint64_t final_cursor = meta_ptr_->write_cursor.load(std::memory_order_relaxed);
             uint64_t actual_size = final_cursor * sizeof(T);
@@ -89,25 +93,72 @@ public:
     }
 
     bool write(const T& record) {
-        uint64_t cursor = meta_ptr_->write_cursor.load(std::memory_order_relaxed);
-        if (cursor >= meta_ptr_->capacity) return false;
+        T* slot = reserve();
+        if (!slot) return false;
 
         // 1. 拷贝数据
-        data_ptr_[cursor] = record;
-        
-        // 2. 内存屏障，确保数据先于游标可见
-        std::atomic_thread_fence(std::memory_order_release);
+        *slot = record;
+        commit(1);
 
-        // 3. 更新游标
-        meta_ptr_->write_cursor.fetch_add(1, std::memory_order_relaxed);
+        // 2. 发布游标 (release，确保数据先于游标可见)
+        publish();
         return true;
     }
 
+    // ---------------------------------------------------------
+    // 批量 / 两阶段接口：写入与游标发布分离，多条记录只发布一次游标
+    //   reserve -> 就地填充 -> commit (仅写者可见) -> publish (读者可见)
+    // 仅允许单个写者调用 reserve/commit/write_batch；publish 可由其他线程调用 (如定时刷新)
+    // ---------------------------------------------------------
+
+    // 连续拷贝一段记录并发布游标，返回实际写入条数 (容量不足时截断)
+    size_t write_batch(const T* records, size_t n) {
+        size_t avail = 0;
+        T* dst = reserve(&avail);
+        if (!dst) return 0;
+        size_t k = n < avail ? n : avail;
+        std::memcpy(static_cast<void*>(dst), records, k * sizeof(T));
+        commit(k);
+        publish();
+        return k;
+    }
+
+    // 返回下一个可写槽位 (未发布)，avail 返回剩余连续容量；写满返回 nullptr
+    T* reserve(size_t* avail = nullptr) {
+        uint64_t cursor = pending_cursor_.load(std::memory_order_relaxed);
+        uint64_t cap = meta_ptr_->capacity < capacity_ ? meta_ptr_->capacity : capacity_;
+        if (cursor >= cap) return nullptr;
+        if (avail) *avail = cap - cursor;
+        return &data_ptr_[cursor];
+    }
+
+    void commit(size_t n) {
+        pending_cursor_.store(pending_cursor_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // 将已 commit 的记录对读者可见；游标只增不减，多线程并发发布安全
+    void publish() {
+        uint64_t target = pending_cursor_.load(std::memory_order_acquire);
+        uint64_t cur = meta_ptr_->write_cursor.load(std::memory_order_relaxed);
+        while (cur < target &&
+               !meta_ptr_->write_cursor.compare_exchange_weak(cur, target, std::memory_order_release,
+                                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    // 已 commit 但尚未发布的条数
+    uint64_t unpublished() const {
+        uint64_t pending = pending_cursor_.load(std::memory_order_acquire);
+        uint64_t published = meta_ptr_->write_cursor.load(std::memory_order_relaxed);
+        return pending > published ? pending - published : 0;
+    }
+
 private:
     std::string base_path_;
     uint64_t capacity_;
     T* data_ptr_ = nullptr;
     MetaHeader* meta_ptr_ = nullptr;
+    std::atomic<uint64_t> pending_cursor_{0};  // 写者本地游标 (已 commit)，>= write_cursor
 };
 
 // ---------------------------------------------------------
@@ -245,6 +296,9 @@ public:
         cached_write_cursor_ = meta_ptr_->write_cursor.load(std::memory_order_acquire);
     }
 
+    // 当前读位置 (已读条数)
+    uint64_t tell() const { return local_cursor_; }
+
     uint64_t get_total_count() const {
         return meta_ptr_->write_cursor.load(std::memory_order_acquire);
     }
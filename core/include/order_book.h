@@ -0,0 +1,125 @@
+#pragma once
+
+#include "protocol.h"
+#include <cstdint>
+#include <vector>
+
+#ifndef ORDER_BOOK_LADDER_TICKS
+#define ORDER_BOOK_LADDER_TICKS 1024   // 价格阶梯容量 (以最小变动价位计, 必须为偶数)
+#endif
+
+#ifndef ORDER_BOOK_MAX_EVENTS
+#define ORDER_BOOK_MAX_EVENTS 64       // 单次更新最多派生的档位事件数
+#endif
+
+// 档位事件类型
+enum BookEventType : uint8_t {
+    BOOK_ADD = 0,           // 挂单量增加 (含新出现的价位)
+    BOOK_CANCEL,            // 挂单量减少且无成交 (撤单)
+    BOOK_TRADE,             // 挂单量因成交减少 (价位仍在)
+    BOOK_TRADE_THROUGH      // 价位被成交击穿 (整档消失)
+};
+
+enum BookSide : uint8_t {
+    BOOK_BID = 0,
+    BOOK_ASK = 1
+};
+
+// 单个档位变化事件
+struct BookLevelEvent {
+    uint8_t side;        // BookSide
+    uint8_t type;        // BookEventType
+    int32_t ticks;       // 价格的 tick 编号 (price / tick_size)
+    double price;
+    int prev_volume;
+    int volume;
+    int traded;          // 本事件中归因于成交的数量
+    int queue_ahead;     // 该档位排队估计 (在此之前入队订单前方剩余量)
+};
+
+class OrderBook;
+
+/**
+ * BookUpdate: EVENT_BOOK_UPDATE 的负载
+ * 由 OrderBookModule 在每次 Tick 重建盘口后发布，events 在回调返回后失效。
+ */
+struct BookUpdate {
+    const TickRecord* tick;
+    const OrderBook* book;
+    const BookLevelEvent* events;
+    int event_count;
+    int volume_delta;    // 本 Tick 成交量增量
+};
+
+/**
+ * OrderBook: 基于逐笔 5 档快照重建的单合约价格阶梯
+ *
+ * 阶梯为按 tick 编号寻址的平铺数组，价格 -> 下标为 O(1)；
+ * 价位滑出阶梯范围时整体重新定锚 (罕见)。
+ * 仅 5 档可见区间内的价位参与事件推导，滑出可见区间的价位保留最后已知量但标记为不可见。
+ *
+ * 排队估计 (queue_ahead) 模型：
+ *   - 价位首次出现时 queue_ahead = 当前挂单量 (假想订单排在队尾)
+ *   - 新增挂单排在其后，queue_ahead 不变
+ *   - 成交从队首消耗：queue_ahead -= traded
+ *   - 撤单按比例分摊：queue_ahead *= new / old
+ */
+class OrderBook {
+public:
+    struct Level {
+        int volume = 0;
+        int queue_ahead = 0;
+        bool visible = false;
+    };
+
+    // tick_size <= 0 时从首个 Tick 的相邻档位价差推断
+    explicit OrderBook(double tick_size = 0.0);
+
+    // 用新快照更新盘口，返回写入 out 的事件数
+    int apply(const TickRecord& tick, BookLevelEvent* out, int max_events);
+
+    void reset();
+
+    bool ready() const { return tick_size_ > 0.0 && has_anchor_; }
+    double tick_size() const { return tick_size_; }
+    int volume_delta() const { return volume_delta_; }   // 最近一次 apply 的成交量增量
+
+    // 可见的最优价 (tick 编号)，不存在时返回 false
+    bool best_bid(int32_t& ticks) const;
+    bool best_ask(int32_t& ticks) const;
+
+    // 按价格查询档位 (不在阶梯范围内返回 nullptr)
+    const Level* level(BookSide side, double price) const;
+    const Level* level_at(BookSide side, int32_t ticks) const;
+
+    // 从最优价向外依次写出可见档位 (价格/量)，返回写出档数
+    int depth(BookSide side, double* prices, int* volumes, int max_levels) const;
+
+    int32_t to_ticks(double price) const;
+    double to_price(int32_t ticks) const { return ticks * tick_size_; }
+
+private:
+    static constexpr int LADDER = ORDER_BOOK_LADDER_TICKS;
+    static constexpr int MAX_DEPTH = 5;
+
+    bool infer_tick_size(const TickRecord& tick);
+    void recenter(int32_t mid_ticks);
+    bool in_range(int32_t ticks) const { return ticks >= base_ && ticks < base_ + LADDER; }
+    Level& at(BookSide side, int32_t ticks) { return ladder_[side][ticks - base_]; }
+
+    int diff_side(BookSide side, const int32_t* ticks, const int* vols, int n,
+                  int volume_delta, int32_t trade_ticks,
+                  BookLevelEvent* out, int max_events);
+
+    double tick_size_;
+    bool has_anchor_ = false;
+    int32_t base_ = 0;             // ladder_[0] 对应的 tick 编号
+
+    std::vector<Level> ladder_[2];
+
+    // 上一次的可见档位 (tick 编号)，按从优到劣排列
+    int32_t prev_ticks_[2][MAX_DEPTH];
+    int prev_count_[2] = {0, 0};
+    int last_volume_ = -1;
+    int volume_delta_ = 0;
+};
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <chrono>
 #include "protocol.h"
+#include "clock.h"
 
 // 订单上下文，记录订单全生命周期
 struct OrderContext {
@@ -29,16 +30,12 @@ public:
     }
 
     uint64_t next_id() {
-        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        struct tm* lt = std::localtime(&now);
-        
+        // 取引擎时钟：回放时为行情时间，同一份数据回测生成的 ID 可复现
+        const IClock& clock = IClock::instance();
+
         // YYMMDDHHMMSS (12 digits)
-        uint64_t time_part = static_cast<uint64_t>(lt->tm_year % 100) * 10000000000ULL + 
-                             static_cast<uint64_t>(lt->tm_mon + 1) * 100000000ULL + 
-                             static_cast<uint64_t>(lt->tm_mday) * 1000000ULL + 
-                             static_cast<uint64_t>(lt->tm_hour) * 10000ULL + 
-                             static_cast<uint64_t>(lt->tm_min) * 100ULL + 
-                             static_cast<uint64_t>(lt->tm_sec);
+        uint64_t time_part = static_cast<uint64_t>(clock.yyyymmdd() % 1000000) * 1000000ULL +
+                             static_cast<uint64_t>(clock.hhmmss());
         
         // Seq: 0-9999 (4 digits)
         uint32_t seq = sequence_.fetch_add(1, std::memory_order_relaxed) % 10000;
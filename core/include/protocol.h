@@ -30,8 +30,25 @@ struct alignas(64) TickRecord {
     int bid_volume[5];
     double ask_price[5];
     int ask_volume[5];
+
+    // 以下字段占用 alignas(64) 的尾部填充，记录大小保持 320 字节；
+    // 增量与质量标志由 TickNormalizer 填写，未经归一化的原始记录中为 0
+    int volume_delta;        // 本 Tick 成交量增量
+    uint32_t quality_flags;  // TickQuality 位标志
+    double turnover_delta;   // 本 Tick 成交额增量
+    uint64_t recv_ns;        // 录制器收到行情的时刻 (Unix 纳秒，TSC 时钟)，0 表示未知
+};
+static_assert(sizeof(TickRecord) == 320, "TickRecord layout is shared with mmap files and rust_tools");
+
+// TickRecord::quality_flags
+enum TickQuality : uint32_t {
+    TICK_NORMALIZED = 0x1,   // 已经过 TickNormalizer，增量字段有效
+    TICK_SANITIZED  = 0x2,   // 存在被清洗的字段 (DBL_MAX/NaN/负价 -> 0)
+    TICK_FIRST      = 0x4,   // 该合约当日首个 Tick，增量按 0 计
+    TICK_NO_LAST    = 0x8    // 无有效最新价 (当日尚未成交的纯盘口更新)，last_price 为 0
 };
 
+// 时间线周期 (分钟)；任意整分钟周期直接取分钟数，非整分钟的秒线与 Tick/量/额线为 0，见 KlineRecord::type/period
 enum KlineInterval {
     K_1M = 1,
     K_5M = 5,
@@ -40,20 +57,32 @@ enum KlineInterval {
     K_1D = 1440
 };
 
+// K 线类型
+enum KlineType : uint8_t {
+    KLINE_TIME = 0,    // 时间线 (按交易时段切分)
+    KLINE_TICK = 1,    // 每 N 笔 Tick
+    KLINE_VOLUME = 2,  // 每 N 手成交量
+    KLINE_DOLLAR = 3   // 每 N 万元成交额
+};
+
 struct KlineRecord {
     char symbol[32];
     uint64_t symbol_id;    // Mapped ID
     uint32_t trading_day; // 交易日 YYYYMMDD
+    uint32_t period;      // 时间线为周期秒数 (日线 86400)；其余类型为阈值 N (原对齐填充位，旧文件为 0)
     uint64_t start_time;  // 周期起始时间 HHMMSSmmm
     double open;
     double high;
     double low;
     double close;
     int volume;           // 周期内成交量增量
+    KlineType type;       // 原对齐填充位，旧文件为 0 (KLINE_TIME)
+    uint8_t reserved[3];
     double turnover;      // 周期内成交额增量
     double open_interest; // 周期末持仓量
     KlineInterval interval;
 };
+static_assert(sizeof(KlineRecord) == 120, "KlineRecord layout is shared with kline mmap files");
 
 struct AccountDetail {
     char broker_id[11];
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "protocol.h"
+#include "tick_normalizer.h"
+
+#include <immintrin.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/**
+ * ReplayPacer: 按原始行情时间节奏回放
+ *
+ * 第 i 条 Tick 的计划发布时刻 = 起点 + (tick_time_i - tick_time_0) / speed。
+ * 等待采用 sleep + spin 混合：距离目标超过 spin_us 时先 sleep 到目标前 spin_us，剩余部分 _mm_pause 自旋，
+ * 兼顾 CPU 占用与微秒级精度。午休、夜盘收盘等超过 max_gap_ms 的行情空档压缩为 max_gap_ms。
+ * speed <= 0 且 interval_us == 0 时不限速；speed <= 0 且 interval_us > 0 时按固定间隔发布。
+ */
+class ReplayPacer {
+public:
+    using SteadyClock = std::chrono::steady_clock;
+
+    ReplayPacer(double speed, uint64_t interval_us, uint64_t max_gap_ms = 5000, uint64_t spin_us = 200)
+        : speed_(speed), interval_(std::chrono::microseconds(interval_us)),
+          max_gap_ms_(max_gap_ms), spin_(std::chrono::microseconds(spin_us)) {}
+
+    bool enabled() const { return speed_ > 0.0 || interval_.count() > 0; }
+
+    // 阻塞到该 Tick 的计划发布时刻
+    void wait(const TickRecord& tick) {
+        if (speed_ > 0.0) {
+            uint64_t t = static_cast<uint64_t>(tick.trading_day) * 86400000ULL + TickNormalizer::session_ms(tick.update_time);
+            if (!started_) {
+                started_ = true;
+                base_wall_ = SteadyClock::now();
+                base_tick_ms_ = t;
+                last_tick_ms_ = t;
+                return;
+            }
+            if (t <= last_tick_ms_) return;  // 同一时刻或时间倒退：立即发布
+            uint64_t gap = t - last_tick_ms_;
+            if (gap > max_gap_ms_) {
+                base_tick_ms_ += gap - max_gap_ms_;  // 压缩空档
+            }
+            last_tick_ms_ = t;
+            auto offset = std::chrono::duration<double, std::milli>((t - base_tick_ms_) / speed_);
+            sleep_until(base_wall_ + std::chrono::duration_cast<SteadyClock::duration>(offset));
+        } else if (interval_.count() > 0) {
+            SteadyClock::time_point now = SteadyClock::now();
+            if (!started_ || next_ < now) {
+                started_ = true;
+                next_ = now;
+            }
+            sleep_until(next_);
+            next_ += interval_;
+        }
+    }
+
+    void reset() { started_ = false; }
+
+private:
+    void sleep_until(SteadyClock::time_point target) const {
+        SteadyClock::time_point now = SteadyClock::now();
+        if (target <= now) return;
+        if (target - now > spin_) {
+            std::this_thread::sleep_for(target - now - spin_);
+        }
+        while (SteadyClock::now() < target) {
+            _mm_pause();
+        }
+    }
+
+    double speed_;
+    std::chrono::microseconds interval_;
+    uint64_t max_gap_ms_;
+    std::chrono::microseconds spin_;
+
+    bool started_ = false;
+    SteadyClock::time_point base_wall_;
+    uint64_t base_tick_ms_ = 0;
+    uint64_t last_tick_ms_ = 0;
+    SteadyClock::time_point next_;  // 固定间隔模式的下一发布时刻
+};
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 增量滚动指标：每次 push 为 O(1) (RollingQuantile 为 O(log w) 查找 + 一次 memmove)，
+// 窗口长度在构造 / reset 时确定并一次性分配，之后不再分配内存。
+// 窗口未满时各统计量基于已有样本计算，full() 表示已达到窗口长度。
+
+// 固定容量环形窗口，下标 0 为最旧样本
+class RollingWindow {
+public:
+    explicit RollingWindow(size_t capacity = 1) { reset(capacity); }
+
+    void reset(size_t capacity) {
+        capacity_ = capacity ? capacity : 1;
+        data_.assign(capacity_, 0.0);
+        clear();
+    }
+
+    void clear() {
+        size_ = 0;
+        head_ = 0;
+    }
+
+    // 压入 x；窗口已满时挤出最旧样本并通过 evicted 返回
+    bool push(double x, double& evicted) {
+        bool full = size_ == capacity_;
+        evicted = data_[head_];
+        data_[head_] = x;
+        if (++head_ == capacity_) head_ = 0;
+        if (!full) ++size_;
+        return full;
+    }
+
+    double operator[](size_t i) const {
+        size_t p = head_ + capacity_ - size_ + i;
+        return data_[p >= capacity_ ? p - capacity_ : p];
+    }
+    double back() const { return data_[head_ ? head_ - 1 : capacity_ - 1]; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool full() const { return size_ == capacity_; }
+
+private:
+    std::vector<double> data_;
+    size_t capacity_ = 1;
+    size_t size_ = 0;
+    size_t head_ = 0;  // 下一个写入位置
+};
+
+// Neumaier 补偿求和：长时间加减不累积舍入误差
+class KahanSum {
+public:
+    void add(double x) {
+        double t = sum_ + x;
+        if (std::fabs(sum_) >= std::fabs(x)) {
+            comp_ += (sum_ - t) + x;
+        } else {
+            comp_ += (x - t) + sum_;
+        }
+        sum_ = t;
+    }
+    void clear() { sum_ = comp_ = 0.0; }
+    double value() const { return sum_ + comp_; }
+
+private:
+    double sum_ = 0.0;
+    double comp_ = 0.0;
+};
+
+// 滚动和 / 均值 (补偿求和)
+class RollingSum {
+public:
+    explicit RollingSum(size_t window = 1) : win_(window) {}
+
+    void reset(size_t window) {
+        win_.reset(window);
+        sum_.clear();
+    }
+
+    void push(double x) {
+        double old;
+        if (win_.push(x, old)) sum_.add(-old);
+        sum_.add(x);
+    }
+
+    double sum() const { return sum_.value(); }
+    double mean() const { return win_.size() ? sum_.value() / win_.size() : 0.0; }
+    size_t size() const { return win_.size(); }
+    bool full() const { return win_.full(); }
+    const RollingWindow& window() const { return win_; }
+
+private:
+    RollingWindow win_;
+    KahanSum sum_;
+};
+
+// 滚动均值 / 方差 / 标准差 / Z-Score (Welford 增删，定期按窗口重算消除漂移)
+class RollingStats {
+public:
+    static constexpr uint32_t RESYNC_PERIOD = 4096;  // 每 max(4096, 窗口长度) 次更新重算一次，均摊不到一次加法
+
+    explicit RollingStats(size_t window = 1) : win_(window) {}
+
+    void reset(size_t window) {
+        win_.reset(window);
+        clear_stats();
+    }
+
+    void push(double x) {
+        double old;
+        if (win_.push(x, old)) {
+            // 等长替换：一步完成删 old 加 x
+            double n = static_cast<double>(win_.size());
+            double delta = x - old;
+            double mean_new = mean_ + delta / n;
+            m2_ += delta * ((x - mean_new) + (old - mean_));
+            mean_ = mean_new;
+        } else {
+            double n = static_cast<double>(win_.size());
+            double d = x - mean_;
+            mean_ += d / n;
+            m2_ += d * (x - mean_);
+        }
+        if (m2_ < 0.0) m2_ = 0.0;
+        if (++since_resync_ >= RESYNC_PERIOD && since_resync_ >= win_.capacity()) resync();
+    }
+
+    double mean() const { return mean_; }
+    // 总体方差 (除以 n)；sample=true 时除以 n-1
+    double var(bool sample = false) const {
+        size_t n = win_.size();
+        if (n < (sample ? 2u : 1u)) return 0.0;
+        return m2_ / static_cast<double>(sample ? n - 1 : n);
+    }
+    double stdev(bool sample = false) const { return std::sqrt(var(sample)); }
+
+    // (x - mean) / stdev；标准差小于 eps 时返回 0
+    double zscore(double x, double eps = 1e-12) const {
+        double sd = stdev();
+        return sd > eps ? (x - mean_) / sd : 0.0;
+    }
+
+    size_t size() const { return win_.size(); }
+    bool full() const { return win_.full(); }
+    const RollingWindow& window() const { return win_; }
+
+    // 两遍法按窗口重算
+    void resync() {
+        since_resync_ = 0;
+        size_t n = win_.size();
+        if (n == 0) return;
+        KahanSum s;
+        for (size_t i = 0; i < n; ++i) s.add(win_[i]);
+        double mean = s.value() / n;
+        double m2 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double d = win_[i] - mean;
+            m2 += d * d;
+        }
+        mean_ = mean;
+        m2_ = m2;
+    }
+
+private:
+    void clear_stats() {
+        mean_ = m2_ = 0.0;
+        since_resync_ = 0;
+    }
+
+    RollingWindow win_;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    uint32_t since_resync_ = 0;
+};
+
+// 指数移动平均：alpha 为新样本权重，首个样本直接作为初值
+class Ema {
+public:
+    explicit Ema(double alpha = 0.1) : alpha_(alpha) {}
+    // 与 N 周期 SMA 重心相同的 alpha = 2 / (N + 1)
+    static Ema from_span(size_t n) { return Ema(2.0 / (static_cast<double>(n) + 1.0)); }
+
+    void push(double x) {
+        if (count_ == 0) {
+            value_ = x;
+        } else {
+            value_ += alpha_ * (x - value_);
+        }
+        ++count_;
+    }
+
+    void clear() {
+        value_ = 0.0;
+        count_ = 0;
+    }
+    double value() const { return value_; }
+    double alpha() const { return alpha_; }
+    uint64_t count() const { return count_; }
+
+private:
+    double alpha_;
+    double value_ = 0.0;
+    uint64_t count_ = 0;
+};
+
+// 滚动最小 / 最大值：两个单调队列，元素存 (序号, 值)，均摊 O(1)
+class RollingMinMax {
+public:
+    explicit RollingMinMax(size_t window = 1) { reset(window); }
+
+    void reset(size_t window) {
+        window_ = window ? window : 1;
+        max_q_.reset(window_);
+        min_q_.reset(window_);
+        seq_ = 0;
+    }
+
+    void push(double x) {
+        const uint64_t expire = seq_ >= window_ ? seq_ - window_ + 1 : 0;  // 窗口内最旧序号
+        max_q_.push(seq_, x, expire, [](double a, double b) { return a <= b; });
+        min_q_.push(seq_, x, expire, [](double a, double b) { return a >= b; });
+        ++seq_;
+    }
+
+    double max() const { return max_q_.front(); }
+    double min() const { return min_q_.front(); }
+    size_t size() const { return static_cast<size_t>(std::min<uint64_t>(seq_, window_)); }
+    bool full() const { return seq_ >= window_; }
+
+private:
+    // 固定容量双端队列 (容量 = 窗口长度，单调性保证不会溢出)
+    struct MonoQueue {
+        std::vector<uint64_t> seq;
+        std::vector<double> val;
+        size_t cap = 1, head = 0, count = 0;
+
+        void reset(size_t c) {
+            cap = c;
+            seq.assign(cap, 0);
+            val.assign(cap, 0.0);
+            head = count = 0;
+        }
+
+        template <typename Dominated>
+        void push(uint64_t s, double x, uint64_t expire, Dominated dominated) {
+            while (count && seq[head] < expire) {
+                if (++head == cap) head = 0;
+                --count;
+            }
+            // 队尾被新值支配的元素永远不会成为极值
+            while (count) {
+                size_t tail = head + count - 1;
+                if (tail >= cap) tail -= cap;
+                if (!dominated(val[tail], x)) break;
+                --count;
+            }
+            size_t pos = head + count;
+            if (pos >= cap) pos -= cap;
+            seq[pos] = s;
+            val[pos] = x;
+            ++count;
+        }
+
+        double front() const { return count ? val[head] : 0.0; }
+    };
+
+    size_t window_ = 1;
+    uint64_t seq_ = 0;
+    MonoQueue max_q_;
+    MonoQueue min_q_;
+};
+
+// 滚动分位数：窗口内样本维护为有序数组，二分定位后 memmove 增删 (w 为数百时仍在几十 ns 量级)
+class RollingQuantile {
+public:
+    explicit RollingQuantile(size_t window = 1) : win_(window) { sorted_.reserve(win_.capacity()); }
+
+    void reset(size_t window) {
+        win_.reset(window);
+        sorted_.clear();
+        sorted_.reserve(win_.capacity());
+    }
+
+    void push(double x) {
+        double old;
+        if (win_.push(x, old)) {
+            auto it = std::lower_bound(sorted_.begin(), sorted_.end(), old);
+            auto ins = std::lower_bound(sorted_.begin(), sorted_.end(), x);
+            // 删 old 与插 x 合并为一次区间平移
+            if (ins <= it) {
+                std::memmove(&*ins + 1, &*ins, static_cast<size_t>(it - ins) * sizeof(double));
+                *ins = x;
+            } else {
+                --ins;
+                std::memmove(&*it, &*it + 1, static_cast<size_t>(ins - it) * sizeof(double));
+                *ins = x;
+            }
+        } else {
+            sorted_.insert(std::lower_bound(sorted_.begin(), sorted_.end(), x), x);  // 容量已预留
+        }
+    }
+
+    // q ∈ [0, 1]，相邻两个顺序统计量线性插值
+    double quantile(double q) const {
+        size_t n = sorted_.size();
+        if (n == 0) return 0.0;
+        q = std::min(1.0, std::max(0.0, q));
+        double pos = q * static_cast<double>(n - 1);
+        size_t lo = static_cast<size_t>(pos);
+        if (lo + 1 >= n) return sorted_[n - 1];
+        double frac = pos - static_cast<double>(lo);
+        return sorted_[lo] + (sorted_[lo + 1] - sorted_[lo]) * frac;
+    }
+    double median() const { return quantile(0.5); }
+
+    size_t size() const { return win_.size(); }
+    bool full() const { return win_.full(); }
+
+private:
+    RollingWindow win_;
+    std::vector<double> sorted_;
+};
+
+// 滚动协方差 / 相关系数 / 回归 beta (y 对 x)，Welford 成对增删
+class RollingCorr {
+public:
+    static constexpr uint32_t RESYNC_PERIOD = RollingStats::RESYNC_PERIOD;  // 重算周期同 RollingStats
+
+    explicit RollingCorr(size_t window = 1) : x_(window), y_(window) {}
+
+    void reset(size_t window) {
+        x_.reset(window);
+        y_.reset(window);
+        mx_ = my_ = cxx_ = cyy_ = cxy_ = 0.0;
+        since_resync_ = 0;
+    }
+
+    void push(double x, double y) {
+        double ox, oy;
+        bool full = x_.push(x, ox);
+        y_.push(y, oy);
+        const double n = static_cast<double>(x_.size());
+        if (full) {
+            // 等长替换：与 RollingStats 相同的一步更新，交叉项展开为
+            // dCxy = dx*(oy - my) + dy*(ox - mx) + dx*dy*(n-1)/n
+            double dx = x - ox, dy = y - oy;
+            double mx = mx_ + dx / n, my = my_ + dy / n;
+            cxx_ += dx * ((x - mx) + (ox - mx_));
+            cyy_ += dy * ((y - my) + (oy - my_));
+            cxy_ += dx * (oy - my_) + dy * (ox - mx_) + dx * dy * (n - 1.0) / n;
+            mx_ = mx;
+            my_ = my;
+        } else {
+            double dx = x - mx_;
+            double dy = y - my_;
+            mx_ += dx / n;
+            my_ += dy / n;
+            cxx_ += dx * (x - mx_);
+            cyy_ += dy * (y - my_);
+            cxy_ += dx * (y - my_);
+        }
+        if (++since_resync_ >= RESYNC_PERIOD && since_resync_ >= x_.capacity()) resync();
+    }
+
+    double mean_x() const { return mx_; }
+    double mean_y() const { return my_; }
+    double cov() const { return x_.size() ? cxy_ / x_.size() : 0.0; }
+    double var_x() const { return x_.size() ? std::max(cxx_, 0.0) / x_.size() : 0.0; }
+    double var_y() const { return x_.size() ? std::max(cyy_, 0.0) / x_.size() : 0.0; }
+
+    // 任一序列方差为 0 时返回 0
+    double corr() const {
+        double d = std::max(cxx_, 0.0) * std::max(cyy_, 0.0);
+        return d > 0.0 ? cxy_ / std::sqrt(d) : 0.0;
+    }
+    // y = alpha + beta * x 的最小二乘斜率
+    double beta() const { return cxx_ > 0.0 ? cxy_ / cxx_ : 0.0; }
+
+    size_t size() const { return x_.size(); }
+    bool full() const { return x_.full(); }
+
+    void resync() {
+        since_resync_ = 0;
+        size_t n = x_.size();
+        if (n == 0) return;
+        KahanSum sx, sy;
+        for (size_t i = 0; i < n; ++i) {
+            sx.add(x_[i]);
+            sy.add(y_[i]);
+        }
+        mx_ = sx.value() / n;
+        my_ = sy.value() / n;
+        cxx_ = cyy_ = cxy_ = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double dx = x_[i] - mx_, dy = y_[i] - my_;
+            cxx_ += dx * dx;
+            cyy_ += dy * dy;
+            cxy_ += dx * dy;
+        }
+    }
+
+private:
+    RollingWindow x_;
+    RollingWindow y_;
+    double mx_ = 0.0, my_ = 0.0;
+    double cxx_ = 0.0, cyy_ = 0.0, cxy_ = 0.0;  // 离差平方和 / 交叉积和
+    uint32_t since_resync_ = 0;
+};
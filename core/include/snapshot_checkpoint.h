@@ -0,0 +1,40 @@
+#pragma once
+
+#include "market_snapshot.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * SnapshotCheckpoint
+ * 行情截面的落盘检查点：引擎退出/定时将每个合约的最新 Tick 写入磁盘，
+ * 重启时回灌到 MarketSnapshot，使首笔报单无需等待冷门合约的新行情。
+ *
+ * 文件格式 (mmap 写入，先写临时文件再 rename，保证读端不会看到半成品):
+ *   [CheckpointHeader][TickRecord x count]
+ */
+class SnapshotCheckpoint {
+public:
+    struct CheckpointHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t trading_day;  // 记录中最大的交易日
+        uint64_t count;        // TickRecord 条数
+        int64_t saved_at;      // 保存时刻 (unix 秒)
+        char padding[32];
+    };
+
+    static constexpr uint64_t MAGIC = 0x434B5054534E4150; // "PANSTPKC"
+    static constexpr uint32_t VERSION = 1;
+
+    // 保存截面全部槽位，成功返回写入条数，失败返回 -1
+    static long save(const MarketSnapshot& snap, const std::string& path);
+
+    /**
+     * 从检查点回灌截面
+     * @param trading_day 仅加载该交易日的记录；0 表示使用检查点自身的最新交易日
+     * @param max_age_sec 检查点超过该时长视为过期不加载；0 表示不检查
+     * @return 回灌条数；文件不存在/损坏/过期返回 0
+     */
+    static size_t load(MarketSnapshot& snap, const std::string& path,
+                       uint32_t trading_day = 0, int64_t max_age_sec = 0);
+};
@@ -25,6 +25,11 @@ public:
     double get_multiplier(uint64_t id) const;
     double get_multiplier(const char* symbol) const;
 
+    // 稠密下标 (0..count()-1，按文件顺序分配)，供按合约平铺的数组寻址；未知合约返回 -1
+    int get_index(uint64_t id) const;
+    size_t count() const { return index_to_id_.size(); }
+    uint64_t id_at(size_t index) const { return index_to_id_[index]; }
+
     // 交易所管理
     void set_exchange(const std::string& symbol, const std::string& exchange);
     std::string get_exchange(const std::string& symbol) const;
@@ -36,6 +41,12 @@ private:
     std::unordered_map<std::string, uint64_t> symbol_to_id_;
     std::unordered_map<uint64_t, double> id_to_multiplier_;
     std::unordered_map<std::string, std::string> symbol_to_exchange_;
+
+    // id -> 稠密下标：id 区间较小时用平铺表 (id - min_id_)，否则回退到哈希表
+    std::vector<uint64_t> index_to_id_;
+    std::vector<int32_t> index_table_;
+    std::unordered_map<uint64_t, int32_t> id_to_index_;
+    uint64_t min_id_ = 0;
     mutable std::mutex mtx_;
     std::atomic<bool> loaded_;
 };
\ No newline at end of file
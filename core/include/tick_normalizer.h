@@ -0,0 +1,73 @@
+#pragma once
+
+#include "protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 过滤计数 (单写者，其他线程可随时读取)
+struct TickFilterStats {
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> passed{0};
+    std::atomic<uint64_t> duplicate{0};     // (symbol, update_time, volume) 与上一条相同
+    std::atomic<uint64_t> out_of_order{0};  // 时间倒退 / 成交量倒退 / 旧交易日
+    std::atomic<uint64_t> invalid{0};       // 时间非法 / 最新价与盘口皆空
+    std::atomic<uint64_t> sanitized{0};     // 放行但有字段被清洗
+};
+
+/**
+ * TickNormalizer: 行情质量过滤与归一化
+ *
+ * 位于数据源 (Replay/Recorder) 与总线之间，下游无需再各自防御：
+ *   1. 清洗：DBL_MAX/NaN/负价格置 0，无效档位的量同时置 0
+ *   2. 去重：与该合约上一条 (update_time, volume) 相同则丢弃
+ *   3. 单调：按交易时段排序的时间 (夜盘跨午夜) 或累计成交量倒退则丢弃
+ *   4. 增量：计算 volume_delta / turnover_delta，写入 TickRecord 尾部字段
+ *
+ * 合约状态按 SymbolManager 稠密下标平铺存放。非线程安全，每个数据源一个实例。
+ */
+class TickNormalizer {
+public:
+    enum Result {
+        PASS = 0,
+        DROP_DUPLICATE,
+        DROP_OUT_OF_ORDER,
+        DROP_INVALID
+    };
+
+    TickNormalizer();
+
+    // 原地归一化，返回 PASS 时 tick 可发布
+    Result process(TickRecord& tick);
+
+    // 仅清洗字段 (不依赖历史状态)，返回是否有字段被修改
+    static bool sanitize(TickRecord& tick);
+
+    // 交易时段内的毫秒序 (18:00 起算)，夜盘跨午夜仍单调
+    static uint64_t session_ms(uint64_t update_time);
+
+    const TickFilterStats& stats() const { return stats_; }
+    std::string stats_string() const;
+    void reset();
+
+private:
+    struct SymbolState {
+        uint32_t trading_day = 0;
+        uint64_t session_ms = 0;
+        uint64_t update_time = 0;
+        int volume = 0;
+        double turnover = 0.0;
+    };
+
+    SymbolState& state_for(const TickRecord& tick);
+
+    static void bump(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::vector<SymbolState> states_;
+    std::unordered_map<std::string, SymbolState> extra_states_; // 未在 symbols.txt 中的合约
+    TickFilterStats stats_;
+};
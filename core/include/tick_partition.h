@@ -0,0 +1,221 @@
+#pragma once
+
+#include "protocol.h"
+#include "mmap_util.h"
+#include "tick_normalizer.h"
+
+#include <cctype>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * TickPartitioner: 录制文件按合约分区的规则与清单
+ *
+ * 分区文件与合并文件同目录：<base>.p.<key>.dat/.meta，清单 <base>.parts 记录模式与已创建的分区键。
+ *   product : 按品种 (合约代码的前导字母，如 au2606 -> au)
+ *   hash:N  : 按合约代码 FNV-1a 取模 N (键为 h00..h{N-1})，与 symbols.txt 无关，跨日稳定
+ */
+struct TickPartitioner {
+    enum Mode {
+        NONE = 0,
+        PRODUCT,
+        HASH
+    };
+
+    Mode mode = NONE;
+    uint32_t buckets = 16;
+
+    // 解析 "none" / "product" / "hash" / "hash:16"，非法返回 false
+    static bool parse(const std::string& spec, TickPartitioner& out) {
+        if (spec.empty() || spec == "none") {
+            out.mode = NONE;
+        } else if (spec == "product") {
+            out.mode = PRODUCT;
+        } else if (spec.compare(0, 4, "hash") == 0) {
+            out.mode = HASH;
+            if (spec.size() > 5 && spec[4] == ':') {
+                out.buckets = static_cast<uint32_t>(std::stoul(spec.substr(5)));
+            }
+            if (out.buckets == 0) return false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    std::string spec() const {
+        if (mode == PRODUCT) return "product";
+        if (mode == HASH) return "hash:" + std::to_string(buckets);
+        return "none";
+    }
+
+    static std::string product_of(const char* symbol) {
+        size_t n = 0;
+        while (n < 31 && symbol[n] && std::isalpha(static_cast<unsigned char>(symbol[n]))) ++n;
+        return std::string(symbol, n);
+    }
+
+    std::string key_for(const char* symbol) const {
+        if (mode == PRODUCT) {
+            std::string p = product_of(symbol);
+            return p.empty() ? "_" : p;
+        }
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < 31 && symbol[i]; ++i) {
+            h ^= static_cast<unsigned char>(symbol[i]);
+            h *= 1099511628211ULL;
+        }
+        char buf[16];
+        snprintf(buf, sizeof(buf), "h%02u", static_cast<unsigned>(h % buckets));
+        return buf;
+    }
+
+    static std::string path(const std::string& base, const std::string& key) { return base + ".p." + key; }
+    static std::string manifest_path(const std::string& base) { return base + ".parts"; }
+
+    // 先写临时文件再 rename，读者不会看到半份清单
+    void write_manifest(const std::string& base, const std::vector<std::string>& keys) const {
+        std::string tmp = manifest_path(base) + ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::trunc);
+            ofs << "mode " << spec() << '\n';
+            for (const auto& k : keys) ofs << "part " << k << '\n';
+        }
+        std::rename(tmp.c_str(), manifest_path(base).c_str());
+    }
+
+    static bool read_manifest(const std::string& base, TickPartitioner& out, std::vector<std::string>& keys) {
+        std::ifstream ifs(manifest_path(base));
+        if (!ifs) return false;
+        std::string tag, val;
+        keys.clear();
+        while (ifs >> tag >> val) {
+            if (tag == "mode") {
+                if (!parse(val, out)) return false;
+            } else if (tag == "part") {
+                keys.push_back(val);
+            }
+        }
+        return out.mode != NONE;
+    }
+
+    // 目录内的录制文件 (不含 .dat 后缀，按名称排序)。合并文件 <base>.dat 存在时跳过它的分区 <base>.p.<key>.dat，
+    // 录制器默认同时保留两者 (keep_merged)，全部列出会使每条 Tick 读两遍；只有分区时照常列出各分区
+    static std::vector<std::string> dir_inputs(const std::string& dir) {
+        std::set<std::string> bases;
+        for (const auto& e : std::filesystem::directory_iterator(dir)) {
+            if (e.path().extension() != ".dat") continue;
+            std::string p = e.path().string();
+            bases.insert(p.substr(0, p.size() - 4));
+        }
+        std::vector<std::string> out;
+        for (const auto& b : bases) {
+            size_t pos = b.rfind(".p.");
+            if (pos != std::string::npos && bases.count(b.substr(0, pos))) continue;
+            out.push_back(b);
+        }
+        return out;
+    }
+};
+
+/**
+ * PartitionedTickReader: 多个 Mmap 文件按时间归并读取
+ *
+ * 单文件时直接转发 MmapReader::read_batch (零额外开销)；多文件时按 (交易日, 交易时段毫秒序) 归并，
+ * 同一时刻按文件顺序。实时场景只在已发布记录中归并，尚未创建的分区文件在空闲时定期重试打开。
+ */
+class PartitionedTickReader {
+public:
+    PartitionedTickReader(const std::vector<std::string>& base_paths, uint64_t max_capacity = 0)
+        : max_capacity_(max_capacity) {
+        for (const auto& p : base_paths) {
+            pending_.push_back(p);
+        }
+        open_pending();
+        if (readers_.empty()) {
+            throw std::runtime_error("无可用的数据文件: " + (base_paths.empty() ? std::string() : base_paths[0]));
+        }
+    }
+
+    size_t read_batch(const TickRecord** out, size_t max_count) {
+        if (readers_.size() == 1 && pending_.empty()) {
+            return readers_[0].reader->read_batch(out, max_count);
+        }
+
+        size_t n = 0;
+        while (n < max_count) {
+            Source* best = nullptr;
+            for (auto& s : readers_) {
+                if (!s.head) s.head = s.reader->read_ptr();
+                if (s.head && (!best || order(*s.head) < order(*best->head))) best = &s;
+            }
+            if (!best) break;
+            out[n++] = best->head;
+            best->head = nullptr;
+        }
+
+        if (n == 0 && !pending_.empty() && ++idle_polls_ >= RETRY_POLLS) {
+            idle_polls_ = 0;
+            open_pending();
+        }
+        return n;
+    }
+
+    // 跳到所有已打开文件的末尾，只读之后新发布的记录
+    void seek_to_end() {
+        for (auto& s : readers_) {
+            s.reader->seek_to_end();
+            s.head = nullptr;
+        }
+    }
+
+    // 各文件写者游标与本地游标之差的和 (已取出待归并的记录不计入)
+    uint64_t lag() const {
+        uint64_t n = 0;
+        for (const auto& s : readers_) {
+            uint64_t total = s.reader->get_total_count();
+            uint64_t pos = s.reader->tell() - (s.head ? 1 : 0);
+            n += total > pos ? total - pos : 0;
+        }
+        return n;
+    }
+
+    size_t source_count() const { return readers_.size(); }
+    size_t pending_count() const { return pending_.size(); }
+
+private:
+    static constexpr uint32_t RETRY_POLLS = 100000;
+
+    struct Source {
+        std::unique_ptr<MmapReader<TickRecord>> reader;
+        const TickRecord* head = nullptr;  // 已取出、待归并的记录 (指向 mmap)
+    };
+
+    static uint64_t order(const TickRecord& t) {
+        return (static_cast<uint64_t>(t.trading_day) << 32) | TickNormalizer::session_ms(t.update_time);
+    }
+
+    void open_pending() {
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            try {
+                Source s;
+                s.reader = std::make_unique<MmapReader<TickRecord>>(*it, max_capacity_);
+                readers_.push_back(std::move(s));
+                it = pending_.erase(it);
+            } catch (const std::exception&) {
+                ++it;
+            }
+        }
+    }
+
+    uint64_t max_capacity_;
+    std::vector<Source> readers_;
+    std::vector<std::string> pending_;
+    uint32_t idle_polls_ = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 交易时段 [begin, end)，单位为交易日毫秒序 (见 TickNormalizer::session_ms：18:00 起算，夜盘跨午夜单调)
+struct SessionSegment {
+    uint32_t begin;
+    uint32_t end;
+};
+
+/**
+ * SessionCalendar: 单个品种的交易时段日历
+ *
+ * 把交易日内的时刻映射为「交易时钟」偏移 (只累计开市时间)。K 线按交易时钟切分，
+ * 天然跳过小节休息与午休，夜盘跨午夜也无需特殊处理；定时收线同样用交易时钟判断 Bar 是否已到期。
+ */
+class SessionCalendar {
+public:
+    // 收盘后仍归入上一时段最后一根 Bar 的尾包宽限 (如 11:30:00.500 的最后一笔)
+    static constexpr uint32_t CLOSE_GRACE_MS = 5000;
+
+    SessionCalendar() = default;
+    explicit SessionCalendar(std::vector<SessionSegment> segments);
+
+    // 解析 "21:00-23:00,09:00-10:15,10:30-11:30,13:30-15:00" (按时间先后，夜盘在前)；
+    // 时刻须为两位数字的 HH:MM 或 HH:MM:SS，格式、范围、顺序有误时返回 false，error 非空时写入出错的时段
+    static bool parse(const std::string& spec, SessionCalendar& out, std::string* error = nullptr);
+
+    // Tick 归属的交易时钟偏移：时段内取实际偏移；收盘宽限内的尾包归入该段最后一毫秒；
+    // 其余休市时间 (集合竞价、提前到达) 归入下一段开头；全天收盘后归入最后一毫秒
+    uint32_t tick_offset(uint32_t session_ms) const;
+
+    // 时钟推进到 session_ms 时已流逝的交易时长：休市期间停在上一段结束，收盘后为 trading_ms()
+    uint32_t clock_offset(uint32_t session_ms) const;
+
+    // 交易时钟偏移 -> 交易日毫秒序 (Bar 起始时刻)
+    uint32_t offset_to_session_ms(uint32_t offset) const;
+
+    uint32_t trading_ms() const { return trading_ms_; }
+    bool empty() const { return segments_.empty(); }
+    const std::vector<SessionSegment>& segments() const { return segments_; }
+    std::string to_string() const;
+
+private:
+    std::vector<SessionSegment> segments_;
+    uint32_t trading_ms_ = 0;
+};
+
+/**
+ * TradingSessions: 品种 -> 交易时段日历
+ *
+ * 内置国内期货各交易所的常见时段 (商品日盘/夜盘至 23:00、01:00、02:30，中金所股指与国债)，
+ * 可用 load() 从文本覆盖或补充，每行 "品种:时段列表"，如 "rb:21:00-23:00,09:00-10:15,10:30-11:30,13:30-15:00"，
+ * 品种为 "*" 时替换默认日历。合约按前缀字母取品种 (rb2605 -> rb)。
+ */
+class TradingSessions {
+public:
+    TradingSessions();
+
+    // 任一行无效时打印文件行号与原因并返回 false，已有日历不变
+    bool load(const std::string& path);
+    void set(const std::string& product, const SessionCalendar& calendar);
+    void set_default(const SessionCalendar& calendar) { default_ = calendar; }
+
+    const SessionCalendar& for_symbol(const char* symbol) const;
+    const SessionCalendar& default_calendar() const { return default_; }
+    size_t size() const { return calendars_.size(); }
+
+    static std::string product_of(const char* symbol);
+
+    // 本地当日毫秒 [0, 86400000) -> 交易日毫秒序
+    static uint32_t session_ms_of_day(uint32_t time_of_day_ms);
+    // 交易日毫秒序 -> HHMMSSmmm
+    static uint64_t to_hhmmssmmm(uint32_t session_ms);
+
+private:
+    SessionCalendar default_;
+    std::unordered_map<std::string, SessionCalendar> calendars_;
+};
@@ -0,0 +1,216 @@
+#include "../include/clock.h"
+#include <cpuid.h>
+#include <x86intrin.h>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+namespace {
+
+constexpr uint64_t MS_PER_DAY = 86400000ULL;
+
+IClock* g_clock = nullptr;
+
+// 纪元日 -> 公历 (Howard Hinnant days_from_civil 的逆运算)
+uint32_t civil_from_days(int64_t z) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint64_t doe = static_cast<uint64_t>(z - era * 146097);
+    uint64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t y = static_cast<int64_t>(yoe) + era * 400;
+    uint64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint64_t mp = (5 * doy + 2) / 153;
+    uint64_t d = doy - (153 * mp + 2) / 5 + 1;
+    uint64_t m = mp < 10 ? mp + 3 : mp - 9;
+    if (m <= 2) ++y;
+    return static_cast<uint32_t>(y * 10000 + static_cast<int64_t>(m) * 100 + static_cast<int64_t>(d));
+}
+
+uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+}
+
+// ==========================================
+// 单例管理
+// ==========================================
+IClock& IClock::instance() {
+    if (g_clock == nullptr) {
+        static WallClock default_clock;
+        return default_clock;
+    }
+    return *g_clock;
+}
+
+void IClock::set_instance(IClock* inst) {
+    g_clock = inst;
+}
+
+int64_t IClock::tz_offset_ms() {
+    static const int64_t offset = [] {
+        std::time_t now = std::time(nullptr);
+        std::tm lt{};
+        localtime_r(&now, &lt);
+        return static_cast<int64_t>(lt.tm_gmtoff) * 1000;
+    }();
+    return offset;
+}
+
+uint32_t IClock::time_of_day_ms() const {
+    int64_t ms = static_cast<int64_t>(now_ns() / 1000000) + tz_offset_ms();
+    return static_cast<uint32_t>(ms % static_cast<int64_t>(MS_PER_DAY));
+}
+
+uint32_t IClock::hhmmss() const {
+    uint32_t s = time_of_day_ms() / 1000;
+    return (s / 3600) * 10000 + (s / 60 % 60) * 100 + s % 60;
+}
+
+uint32_t IClock::yyyymmdd() const {
+    int64_t ms = static_cast<int64_t>(now_ns() / 1000000) + tz_offset_ms();
+    return civil_from_days(ms / static_cast<int64_t>(MS_PER_DAY));
+}
+
+uint32_t IClock::trading_day() const {
+    int64_t ms = static_cast<int64_t>(now_ns() / 1000000) + tz_offset_ms();
+    int64_t days = ms / static_cast<int64_t>(MS_PER_DAY);
+    if (ms % static_cast<int64_t>(MS_PER_DAY) >= 18 * 3600000LL) ++days;
+    int weekday = static_cast<int>((days + 4) % 7);  // 1970-01-01 为周四，0 = 周日
+    if (weekday == 6) days += 2;
+    else if (weekday == 0) days += 1;
+    return civil_from_days(days);
+}
+
+// ==========================================
+// WallClock
+// ==========================================
+uint64_t WallClock::now_ns() const {
+    return realtime_ns();
+}
+
+// ==========================================
+// TscClock
+// ==========================================
+bool TscClock::supported() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;  // Invariant TSC
+}
+
+// 取一对紧邻的 (tsc, realtime)：取两次 rdtsc 中间读 realtime，窗口最小的一次误差最小
+void TscClock::sample(uint64_t& tsc, uint64_t& ns) {
+    uint64_t best = ~0ULL;
+    for (int i = 0; i < 5; ++i) {
+        uint64_t t0 = __rdtsc();
+        uint64_t n = realtime_ns();
+        uint64_t t1 = __rdtsc();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+            tsc = t0 + (t1 - t0) / 2;
+            ns = n;
+        }
+    }
+}
+
+TscClock::TscClock() {
+    sample(origin_tsc_, origin_ns_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t tsc, ns;
+    sample(tsc, ns);
+
+    Params p;
+    p.base_tsc = tsc;
+    p.base_ns = ns;
+    p.mult = static_cast<uint64_t>((static_cast<unsigned __int128>(ns - origin_ns_) << 32) / (tsc - origin_tsc_));
+    params_ = p;
+}
+
+uint64_t TscClock::now_ns() const {
+    Params p;
+    uint32_t s1, s2;
+    do {
+        s1 = seq_.load(std::memory_order_acquire);
+        p = params_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = seq_.load(std::memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+
+    uint64_t dt = __rdtsc() - p.base_tsc;
+    return p.base_ns + static_cast<uint64_t>((static_cast<unsigned __int128>(dt) * p.mult) >> 32);
+}
+
+void TscClock::resync() {
+    uint64_t tsc, ns;
+    sample(tsc, ns);
+    if (tsc <= origin_tsc_) return;
+
+    Params p;
+    p.base_tsc = tsc;
+    p.base_ns = ns;  // 直接对齐 CLOCK_REALTIME，步进通常在微秒以内
+    p.mult = static_cast<uint64_t>((static_cast<unsigned __int128>(ns - origin_ns_) << 32) / (tsc - origin_tsc_));
+
+    // 不回退：CLOCK_REALTIME 落后于旧参数在同一 TSC 处的读数时 (采样抖动 / 系统对时回拨)，
+    // 锚在旧读数上，放慢速率 (最多减半) 在下一个同长度间隔内追平，调用方的时间差不会下溢
+    const Params& old = params_;
+    if (tsc > old.base_tsc) {
+        uint64_t span_tsc = tsc - old.base_tsc;
+        uint64_t prev = old.base_ns + static_cast<uint64_t>((static_cast<unsigned __int128>(span_tsc) * old.mult) >> 32);
+        if (ns < prev) {
+            uint64_t lead = prev - ns;
+            uint64_t span_ns = static_cast<uint64_t>((static_cast<unsigned __int128>(span_tsc) * p.mult) >> 32);
+            uint64_t target_ns = span_ns > 2 * lead ? span_ns - lead : span_ns / 2;
+            p.base_ns = prev;
+            p.mult = static_cast<uint64_t>((static_cast<unsigned __int128>(target_ns) << 32) / span_tsc);
+        }
+    }
+
+    uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    params_ = p;
+    seq_.store(s + 2, std::memory_order_release);
+}
+
+double TscClock::ghz() const {
+    return 4294967296.0 / static_cast<double>(params_.mult);
+}
+
+// ==========================================
+// SimClock
+// ==========================================
+void SimClock::advance(uint32_t trading_day, uint64_t update_time) {
+    if (trading_day != cached_day_) {
+        std::tm tm{};
+        tm.tm_year = static_cast<int>(trading_day / 10000) - 1900;
+        tm.tm_mon = static_cast<int>(trading_day / 100 % 100) - 1;
+        tm.tm_mday = static_cast<int>(trading_day % 100);
+        tm.tm_isdst = -1;
+        day_base_s_ = static_cast<int64_t>(mktime(&tm));
+        cached_day_ = trading_day;
+    }
+
+    uint64_t hh = update_time / 10000000;
+    uint64_t mm = (update_time / 100000) % 100;
+    uint64_t ss = (update_time / 1000) % 100;
+    uint64_t tod = ((hh * 60 + mm) * 60 + ss) * 1000 + update_time % 1000;
+
+    int64_t base_s = hh >= 18 ? day_base_s_ - 86400 : day_base_s_;
+    uint64_t ns = static_cast<uint64_t>(base_s) * 1000000000ULL + tod * 1000000ULL;
+    if (ns <= ns_.load(std::memory_order_relaxed)) return;
+    ns_.store(ns, std::memory_order_release);
+
+    uint64_t sec = ns / 1000000000ULL;
+    if (sec != last_sec_) {
+        last_sec_ = sec;
+        if (on_second_) on_second_(sec);
+    }
+}
+
+void SimClock::reset() {
+    ns_.store(0, std::memory_order_relaxed);
+    cached_day_ = 0;
+    last_sec_ = 0;
+}
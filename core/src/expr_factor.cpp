@@ -0,0 +1,565 @@
+#include "../include/expr_factor.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+constexpr uint32_t MAX_WINDOW = 1u << 20;
+
+struct Field {
+    const char* name;
+    uint32_t offset;
+    bool i32;
+    bool indexed;  // bid[i] 形式，i = 0..4
+};
+
+const Field FIELDS[] = {
+    {"last", offsetof(TickRecord, last_price), false, false},
+    {"volume", offsetof(TickRecord, volume), true, false},
+    {"turnover", offsetof(TickRecord, turnover), false, false},
+    {"oi", offsetof(TickRecord, open_interest), false, false},
+    {"open", offsetof(TickRecord, open_price), false, false},
+    {"high", offsetof(TickRecord, highest_price), false, false},
+    {"low", offsetof(TickRecord, lowest_price), false, false},
+    {"pre_close", offsetof(TickRecord, pre_close_price), false, false},
+    {"upper_limit", offsetof(TickRecord, upper_limit), false, false},
+    {"lower_limit", offsetof(TickRecord, lower_limit), false, false},
+    {"vol_delta", offsetof(TickRecord, volume_delta), true, false},
+    {"turnover_delta", offsetof(TickRecord, turnover_delta), false, false},
+    {"bid", offsetof(TickRecord, bid_price), false, true},
+    {"ask", offsetof(TickRecord, ask_price), false, true},
+    {"bid_vol", offsetof(TickRecord, bid_volume), true, true},
+    {"ask_vol", offsetof(TickRecord, ask_volume), true, true},
+};
+
+const char* op_name(ExprOp op) {
+    switch (op) {
+        case ExprOp::LOAD_F64: return "load";
+        case ExprOp::LOAD_I32: return "load_i32";
+        case ExprOp::ADD: return "add";
+        case ExprOp::SUB: return "sub";
+        case ExprOp::MUL: return "mul";
+        case ExprOp::DIV: return "div";
+        case ExprOp::MIN: return "min";
+        case ExprOp::MAX: return "max";
+        case ExprOp::NEG: return "neg";
+        case ExprOp::ABS: return "abs";
+        case ExprOp::LOG: return "log";
+        case ExprOp::SQRT: return "sqrt";
+        case ExprOp::SIGN: return "sign";
+        case ExprOp::CLIP: return "clip";
+        case ExprOp::PUSH_SUM: return "push_sum";
+        case ExprOp::PUSH_STATS: return "push_stats";
+        case ExprOp::PUSH_MINMAX: return "push_minmax";
+        case ExprOp::PUSH_CORR: return "push_corr";
+        case ExprOp::SMA: return "sma";
+        case ExprOp::SUM: return "sum";
+        case ExprOp::STD: return "std";
+        case ExprOp::ZSCORE: return "zscore";
+        case ExprOp::TSMIN: return "tsmin";
+        case ExprOp::TSMAX: return "tsmax";
+        case ExprOp::CORR: return "corr";
+        case ExprOp::EMA: return "ema";
+        case ExprOp::DELAY: return "delay";
+    }
+    return "?";
+}
+
+bool is_pure(ExprOp op) { return op >= ExprOp::ADD && op <= ExprOp::CLIP; }
+
+bool commutative(ExprOp op) {
+    return op == ExprOp::ADD || op == ExprOp::MUL || op == ExprOp::MIN || op == ExprOp::MAX;
+}
+
+// 纯算子的标量语义：求值与常量折叠共用，保证两者一致；NaN 沿 min / max 传播
+inline double apply(ExprOp op, double x, double y, double z) {
+    switch (op) {
+        case ExprOp::ADD: return x + y;
+        case ExprOp::SUB: return x - y;
+        case ExprOp::MUL: return x * y;
+        case ExprOp::DIV: return x / y;
+        case ExprOp::MIN: return (x < y || std::isnan(x)) ? x : y;
+        case ExprOp::MAX: return (x > y || std::isnan(x)) ? x : y;
+        case ExprOp::NEG: return -x;
+        case ExprOp::ABS: return std::fabs(x);
+        case ExprOp::LOG: return std::log(x);
+        case ExprOp::SQRT: return std::sqrt(x);
+        case ExprOp::SIGN: return std::isnan(x) ? x : static_cast<double>((x > 0.0) - (x < 0.0));
+        case ExprOp::CLIP: return x < y ? y : (x > z ? z : x);
+        default: return NaN;
+    }
+}
+
+}  // namespace
+
+/**
+ * 递归下降解析 + 哈希合并建图：节点下标即寄存器号，子节点总是先于父节点创建，创建顺序即拓扑序。
+ */
+class ExprProgram::Compiler {
+public:
+    explicit Compiler(ExprProgram& p) : p_(p) {}
+
+    uint32_t compile(const std::string& name, const std::string& src) {
+        name_ = name;
+        src_ = src;
+        pos_ = 0;
+        uint32_t r = parse_expr();
+        skip_space();
+        if (pos_ < src_.size()) fail("多余的字符 '" + std::string(1, src_[pos_]) + "'");
+        return r;
+    }
+
+    // 只为输出可达的非常量节点生成指令
+    void emit() {
+        std::vector<char> live(nodes_.size(), 0);
+        for (uint32_t r : p_.outputs_) live[r] = 1;
+        for (size_t i = nodes_.size(); i-- > 0;) {
+            if (!live[i]) continue;
+            const Node& n = nodes_[i];
+            if (n.is_const || n.op == ExprOp::LOAD_F64 || n.op == ExprOp::LOAD_I32) continue;
+            for (uint32_t c : {n.a, n.b, n.c}) {
+                if (c != NONE) live[c] = 1;
+            }
+        }
+        p_.consts_.assign(nodes_.size(), 0.0);
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            const Node& n = nodes_[i];
+            if (n.is_const) {
+                p_.consts_[i] = n.value;
+            } else if (live[i]) {
+                p_.code_.push_back({n.op, static_cast<uint32_t>(i), n.a, n.b, n.c, n.state});
+            }
+        }
+    }
+
+private:
+    struct Node {
+        ExprOp op;
+        uint32_t a, b, c;
+        uint32_t state;
+        bool is_const;
+        double value;
+    };
+    using Key = std::tuple<int, uint32_t, uint32_t, uint32_t, uint64_t>;
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        throw std::invalid_argument("因子 " + name_ + ": " + msg + " (第 " + std::to_string(pos_ + 1) + " 列): " + src_);
+    }
+
+    // ---------- 建图 ----------
+
+    uint32_t constant(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        Key key{-1, 0, 0, 0, bits};
+        auto it = index_.find(key);
+        if (it != index_.end()) return it->second;
+        nodes_.push_back({ExprOp::ADD, NONE, NONE, NONE, NONE, true, v});
+        return index_[key] = static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    bool is_const(uint32_t r) const { return r != NONE && nodes_[r].is_const; }
+
+    uint32_t node(ExprOp op, uint32_t a, uint32_t b = NONE, uint32_t c = NONE, uint32_t window = 0) {
+        if (commutative(op) && b < a) std::swap(a, b);
+        if (is_pure(op) && is_const(a) && (b == NONE || is_const(b)) && (c == NONE || is_const(c))) {
+            return constant(apply(op, nodes_[a].value, b == NONE ? 0.0 : nodes_[b].value, c == NONE ? 0.0 : nodes_[c].value));
+        }
+        Key key{static_cast<int>(op), a, b, c, window};
+        auto it = index_.find(key);
+        if (it != index_.end()) return it->second;
+
+        uint32_t state = NONE;
+        switch (op) {
+            case ExprOp::PUSH_SUM: state = alloc(p_.sum_windows_, window); break;
+            case ExprOp::PUSH_STATS: state = alloc(p_.stats_windows_, window); break;
+            case ExprOp::PUSH_MINMAX: state = alloc(p_.minmax_windows_, window); break;
+            case ExprOp::PUSH_CORR: state = alloc(p_.corr_windows_, window); break;
+            case ExprOp::EMA: state = alloc(p_.ema_spans_, window); break;
+            case ExprOp::DELAY: state = alloc(p_.delay_windows_, window); break;
+            case ExprOp::SMA: case ExprOp::SUM: case ExprOp::STD: case ExprOp::ZSCORE:
+            case ExprOp::TSMIN: case ExprOp::TSMAX: case ExprOp::CORR:
+                state = nodes_[a].state;  // 读取算子：a 为对应的 PUSH 节点
+                break;
+            default: break;
+        }
+        nodes_.push_back({op, a, b, c, state, false, 0.0});
+        return index_[key] = static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    static uint32_t alloc(std::vector<uint32_t>& windows, uint32_t window) {
+        windows.push_back(window);
+        return static_cast<uint32_t>(windows.size() - 1);
+    }
+
+    // ---------- 词法 ----------
+
+    void skip_space() {
+        while (pos_ < src_.size() && std::isspace(static_cast<unsigned char>(src_[pos_]))) ++pos_;
+    }
+
+    bool accept(char ch) {
+        skip_space();
+        if (pos_ < src_.size() && src_[pos_] == ch) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char ch) {
+        if (!accept(ch)) fail(std::string("缺少 '") + ch + "'");
+    }
+
+    std::string ident() {
+        size_t start = pos_;
+        while (pos_ < src_.size() && (std::isalnum(static_cast<unsigned char>(src_[pos_])) || src_[pos_] == '_')) ++pos_;
+        return src_.substr(start, pos_ - start);
+    }
+
+    // ---------- 语法 ----------
+
+    uint32_t parse_expr() {
+        uint32_t lhs = parse_term();
+        for (;;) {
+            if (accept('+')) {
+                lhs = node(ExprOp::ADD, lhs, parse_term());
+            } else if (accept('-')) {
+                lhs = node(ExprOp::SUB, lhs, parse_term());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    uint32_t parse_term() {
+        uint32_t lhs = parse_unary();
+        for (;;) {
+            if (accept('*')) {
+                lhs = node(ExprOp::MUL, lhs, parse_unary());
+            } else if (accept('/')) {
+                lhs = node(ExprOp::DIV, lhs, parse_unary());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    uint32_t parse_unary() {
+        if (accept('-')) return node(ExprOp::NEG, parse_unary());
+        if (accept('+')) return parse_unary();
+        return parse_primary();
+    }
+
+    uint32_t parse_primary() {
+        skip_space();
+        if (pos_ >= src_.size()) fail("表达式不完整");
+        if (accept('(')) {
+            uint32_t r = parse_expr();
+            expect(')');
+            return r;
+        }
+        char ch = src_[pos_];
+        if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.') {
+            char* end = nullptr;
+            double v = std::strtod(src_.c_str() + pos_, &end);
+            if (end == src_.c_str() + pos_) fail("非法数字");
+            pos_ = end - src_.c_str();
+            return constant(v);
+        }
+        if (!std::isalpha(static_cast<unsigned char>(ch)) && ch != '_') fail(std::string("意外的字符 '") + ch + "'");
+
+        size_t at = pos_;
+        std::string id = ident();
+        if (accept('(')) return parse_call(id, at);
+        return parse_field(id, at);
+    }
+
+    uint32_t parse_field(const std::string& id, size_t at) {
+        // 派生字段：展开为表达式，与手写的同名子表达式合并
+        if (id == "mid") return node(ExprOp::MUL, node(ExprOp::ADD, load("bid"), load("ask")), constant(0.5));
+        if (id == "spread") return node(ExprOp::SUB, load("ask"), load("bid"));
+
+        for (const Field& f : FIELDS) {
+            if (id != f.name) continue;
+            if (!f.indexed) return load(f, 0);
+            expect('[');
+            skip_space();
+            size_t digit = pos_;
+            if (pos_ >= src_.size() || src_[pos_] < '0' || src_[pos_] > '4') fail("档位下标须为 0..4");
+            ++pos_;
+            expect(']');
+            return load(f, static_cast<uint32_t>(src_[digit] - '0'));
+        }
+        pos_ = at;
+        fail("未知字段 '" + id + "'");
+    }
+
+    uint32_t load(const char* name) {
+        for (const Field& f : FIELDS) {
+            if (std::strcmp(f.name, name) == 0) return load(f, 0);
+        }
+        fail(std::string("未知字段 '") + name + "'");
+    }
+
+    uint32_t load(const Field& f, uint32_t level) {
+        uint32_t offset = f.offset + level * (f.i32 ? sizeof(int) : sizeof(double));
+        return node(f.i32 ? ExprOp::LOAD_I32 : ExprOp::LOAD_F64, offset);
+    }
+
+    uint32_t parse_call(const std::string& fn, size_t at) {
+        std::vector<uint32_t> args;
+        if (!accept(')')) {
+            do {
+                args.push_back(parse_expr());
+            } while (accept(','));
+            expect(')');
+        }
+        auto arity = [&](size_t lo, size_t hi) {
+            if (args.size() < lo || args.size() > hi) {
+                pos_ = at;
+                fail(fn + " 的参数个数应为 " + std::to_string(lo) + (hi > lo ? "~" + std::to_string(hi) : ""));
+            }
+        };
+        auto window = [&](uint32_t r) -> uint32_t {
+            double v = is_const(r) ? nodes_[r].value : 0.0;
+            if (!is_const(r) || v < 1.0 || v > MAX_WINDOW || v != std::floor(v)) {
+                pos_ = at;
+                fail(fn + " 的窗口须为 1.." + std::to_string(MAX_WINDOW) + " 的整数常量");
+            }
+            return static_cast<uint32_t>(v);
+        };
+
+        static const std::map<std::string, ExprOp> unary = {
+            {"abs", ExprOp::ABS}, {"log", ExprOp::LOG}, {"sqrt", ExprOp::SQRT}, {"sign", ExprOp::SIGN}};
+        auto u = unary.find(fn);
+        if (u != unary.end()) {
+            arity(1, 1);
+            return node(u->second, args[0]);
+        }
+        if (fn == "min" || fn == "max") {
+            arity(2, 2);
+            return node(fn == "min" ? ExprOp::MIN : ExprOp::MAX, args[0], args[1]);
+        }
+        if (fn == "clip") {
+            arity(3, 3);
+            return node(ExprOp::CLIP, args[0], args[1], args[2]);
+        }
+        if (fn == "ema") {
+            arity(2, 2);
+            return node(ExprOp::EMA, args[0], NONE, NONE, window(args[1]));
+        }
+        if (fn == "delay") {
+            arity(2, 2);
+            return node(ExprOp::DELAY, args[0], NONE, NONE, window(args[1]));
+        }
+        if (fn == "delta") {
+            arity(1, 2);
+            uint32_t n = args.size() > 1 ? window(args[1]) : 1;
+            return node(ExprOp::SUB, args[0], node(ExprOp::DELAY, args[0], NONE, NONE, n));
+        }
+        if (fn == "sma" || fn == "sum") {
+            arity(2, 2);
+            uint32_t push = node(ExprOp::PUSH_SUM, args[0], NONE, NONE, window(args[1]));
+            return node(fn == "sma" ? ExprOp::SMA : ExprOp::SUM, push);
+        }
+        if (fn == "std" || fn == "zscore") {
+            arity(2, 2);
+            uint32_t push = node(ExprOp::PUSH_STATS, args[0], NONE, NONE, window(args[1]));
+            return fn == "std" ? node(ExprOp::STD, push) : node(ExprOp::ZSCORE, push, args[0]);
+        }
+        if (fn == "tsmin" || fn == "tsmax") {
+            arity(2, 2);
+            uint32_t push = node(ExprOp::PUSH_MINMAX, args[0], NONE, NONE, window(args[1]));
+            return node(fn == "tsmin" ? ExprOp::TSMIN : ExprOp::TSMAX, push);
+        }
+        if (fn == "corr") {
+            arity(3, 3);
+            uint32_t push = node(ExprOp::PUSH_CORR, args[0], args[1], NONE, window(args[2]));
+            return node(ExprOp::CORR, push);
+        }
+        pos_ = at;
+        fail("未知函数 '" + fn + "'");
+    }
+
+    ExprProgram& p_;
+    std::vector<Node> nodes_;
+    std::map<Key, uint32_t> index_;
+    std::string name_;
+    std::string src_;
+    size_t pos_ = 0;
+};
+
+ExprProgram::ExprProgram(const std::vector<std::pair<std::string, std::string>>& factors) {
+    Compiler c(*this);
+    for (const auto& f : factors) {
+        names_.push_back(f.first);
+        outputs_.push_back(c.compile(f.first, f.second));
+    }
+    c.emit();
+}
+
+ExprState ExprProgram::make_state() const {
+    ExprState s;
+    s.regs = consts_;
+    for (uint32_t w : sum_windows_) s.sums.emplace_back(w);
+    for (uint32_t w : stats_windows_) s.stats.emplace_back(w);
+    for (uint32_t w : minmax_windows_) s.minmax.emplace_back(w);
+    for (uint32_t w : corr_windows_) s.corrs.emplace_back(w);
+    for (uint32_t n : ema_spans_) s.emas.push_back(Ema::from_span(n));
+    for (uint32_t w : delay_windows_) s.delays.emplace_back(w + 1);
+    return s;
+}
+
+void ExprProgram::eval(const TickRecord& tick, ExprState& s, double* out) const {
+    const char* base = reinterpret_cast<const char*>(&tick);
+    double* r = s.regs.data();
+    for (const ExprInstr& in : code_) {
+        double v;
+        switch (in.op) {
+            case ExprOp::LOAD_F64: {
+                std::memcpy(&v, base + in.a, sizeof(double));
+                break;
+            }
+            case ExprOp::LOAD_I32: {
+                int x;
+                std::memcpy(&x, base + in.a, sizeof(int));
+                v = x;
+                break;
+            }
+            case ExprOp::ADD: v = r[in.a] + r[in.b]; break;
+            case ExprOp::SUB: v = r[in.a] - r[in.b]; break;
+            case ExprOp::MUL: v = r[in.a] * r[in.b]; break;
+            case ExprOp::DIV: v = r[in.a] / r[in.b]; break;
+            case ExprOp::MIN: case ExprOp::MAX: case ExprOp::NEG: case ExprOp::ABS:
+            case ExprOp::LOG: case ExprOp::SQRT: case ExprOp::SIGN:
+                v = apply(in.op, r[in.a], in.b == NONE ? 0.0 : r[in.b], 0.0);
+                break;
+            case ExprOp::CLIP: v = apply(in.op, r[in.a], r[in.b], r[in.c]); break;
+
+            // PUSH_*: 输入有限时推进状态并输出 0，否则不推进、输出 NaN (读取算子据此输出 NaN)
+            case ExprOp::PUSH_SUM: {
+                double x = r[in.a];
+                v = std::isfinite(x) ? (s.sums[in.state].push(x), 0.0) : NaN;
+                break;
+            }
+            case ExprOp::PUSH_STATS: {
+                double x = r[in.a];
+                v = std::isfinite(x) ? (s.stats[in.state].push(x), 0.0) : NaN;
+                break;
+            }
+            case ExprOp::PUSH_MINMAX: {
+                double x = r[in.a];
+                v = std::isfinite(x) ? (s.minmax[in.state].push(x), 0.0) : NaN;
+                break;
+            }
+            case ExprOp::PUSH_CORR: {
+                double x = r[in.a], y = r[in.b];
+                v = std::isfinite(x) && std::isfinite(y) ? (s.corrs[in.state].push(x, y), 0.0) : NaN;
+                break;
+            }
+            case ExprOp::SMA: {
+                const RollingSum& st = s.sums[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.mean();
+                break;
+            }
+            case ExprOp::SUM: {
+                const RollingSum& st = s.sums[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.sum();
+                break;
+            }
+            case ExprOp::STD: {
+                const RollingStats& st = s.stats[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.stdev();
+                break;
+            }
+            case ExprOp::ZSCORE: {
+                const RollingStats& st = s.stats[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.zscore(r[in.b]);
+                break;
+            }
+            case ExprOp::TSMIN: {
+                const RollingMinMax& st = s.minmax[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.min();
+                break;
+            }
+            case ExprOp::TSMAX: {
+                const RollingMinMax& st = s.minmax[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.max();
+                break;
+            }
+            case ExprOp::CORR: {
+                const RollingCorr& st = s.corrs[in.state];
+                v = std::isnan(r[in.a]) || !st.full() ? NaN : st.corr();
+                break;
+            }
+            case ExprOp::EMA: {
+                double x = r[in.a];
+                Ema& e = s.emas[in.state];
+                v = std::isfinite(x) ? (e.push(x), e.value()) : NaN;
+                break;
+            }
+            case ExprOp::DELAY: {
+                double x = r[in.a];
+                RollingWindow& w = s.delays[in.state];
+                if (std::isfinite(x)) {
+                    double evicted;
+                    w.push(x, evicted);
+                    v = w.full() ? w[0] : NaN;
+                } else {
+                    v = NaN;
+                }
+                break;
+            }
+            default: v = NaN; break;
+        }
+        r[in.dst] = v;
+    }
+    for (size_t i = 0; i < outputs_.size(); ++i) out[i] = r[outputs_[i]];
+}
+
+std::string ExprProgram::dump() const {
+    std::ostringstream os;
+    auto reg = [this](uint32_t i) {
+        // 常量寄存器直接显示数值
+        bool is_code = false;
+        for (const auto& in : code_) {
+            if (in.dst == i) {
+                is_code = true;
+                break;
+            }
+        }
+        std::ostringstream r;
+        if (is_code) {
+            r << "r" << i;
+        } else {
+            r << consts_[i];
+        }
+        return r.str();
+    };
+    for (const auto& in : code_) {
+        os << "r" << in.dst << " = " << op_name(in.op);
+        if (in.op == ExprOp::LOAD_F64 || in.op == ExprOp::LOAD_I32) {
+            os << " +" << in.a;
+        } else {
+            for (uint32_t x : {in.a, in.b, in.c}) {
+                if (x != NONE) os << " " << reg(x);
+            }
+        }
+        if (in.state != NONE) os << " [s" << in.state << "]";
+        os << "\n";
+    }
+    for (size_t i = 0; i < names_.size(); ++i) os << names_[i] << " = " << reg(outputs_[i]) << "\n";
+    return os.str();
+}
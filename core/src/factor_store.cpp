@@ -0,0 +1,293 @@
+#include "../include/factor_store.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t FACTOR_MAGIC = 0x31524F5453544346ULL;  // "FCTSTOR1"
+constexpr uint32_t FACTOR_VERSION = 1;
+constexpr size_t PAGE = 4096;
+
+size_t round_page(size_t n) { return (n + PAGE - 1) / PAGE * PAGE; }
+
+size_t names_bytes(uint32_t n) { return round_page(static_cast<size_t>(n) * FactorStore::NAME_LEN); }
+
+}
+
+// 共享内存头 (独占首页)
+struct FactorStore::Header {
+    std::atomic<uint64_t> magic;     // 写者初始化完成后最后写入
+    uint32_t version;
+    uint32_t max_symbols;
+    uint32_t max_factors;
+    uint32_t reserved;
+    std::atomic<uint32_t> symbols;   // 已分配行数 (release 发布)
+    std::atomic<uint32_t> factors;   // 已分配列数
+    alignas(64) std::atomic<uint64_t> update_seq;
+};
+
+// 单元格：seq 偶数为稳定，奇数为写入中
+struct alignas(32) FactorStore::Cell {
+    std::atomic<uint32_t> seq;
+    uint32_t reserved;
+    double value;
+    uint64_t timestamp;
+    uint64_t update_seq;
+};
+
+FactorStore::FactorStore(const std::string& shm_name, bool writer, uint32_t max_symbols, uint32_t max_factors)
+    : shm_name_(shm_name), writer_(writer), max_symbols_(max_symbols), max_factors_(max_factors) {
+    static_assert(sizeof(Header) <= PAGE, "Header must fit in one page");
+    static_assert(sizeof(Cell) == 32, "Cell layout is part of the SHM format");
+    int fd = shm_open(shm_name.c_str(), writer ? (O_RDWR | O_CREAT) : O_RDONLY, 0666);
+    if (fd < 0) throw std::runtime_error("Failed to shm_open: " + shm_name);
+
+    if (!writer) {
+        // 读者：先映射首页取得尺寸
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < PAGE) {
+            close(fd);
+            throw std::runtime_error("Factor SHM not initialized: " + shm_name);
+        }
+        void* p = mmap(nullptr, PAGE, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Failed to mmap factor SHM header");
+        }
+        const Header* h = static_cast<const Header*>(p);
+        bool ok = h->magic.load(std::memory_order_acquire) == FACTOR_MAGIC && h->version == FACTOR_VERSION;
+        max_symbols_ = h->max_symbols;
+        max_factors_ = h->max_factors;
+        munmap(p, PAGE);
+        if (!ok) {
+            close(fd);
+            throw std::runtime_error("Invalid factor SHM magic/version: " + shm_name);
+        }
+    }
+
+    size_ = PAGE + names_bytes(max_factors_) + names_bytes(max_symbols_) +
+            static_cast<size_t>(max_symbols_) * max_factors_ * sizeof(Cell);
+    if (writer && ftruncate(fd, size_) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to ftruncate factor SHM");
+    }
+    void* p = mmap(nullptr, size_, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("Failed to mmap factor SHM");
+
+    base_ = static_cast<uint8_t*>(p);
+    header_ = reinterpret_cast<Header*>(base_);
+    factor_names_ = reinterpret_cast<char*>(base_ + PAGE);
+    symbol_names_ = factor_names_ + names_bytes(max_factors_);
+    cells_ = reinterpret_cast<Cell*>(symbol_names_ + names_bytes(max_symbols_));
+
+    if (writer) {
+        // 每次启动重置：先撤销 magic，清空后再发布
+        header_->magic.store(0, std::memory_order_relaxed);
+        std::memset(static_cast<void*>(base_ + sizeof(uint64_t)), 0, size_ - sizeof(uint64_t));
+        header_->version = FACTOR_VERSION;
+        header_->max_symbols = max_symbols_;
+        header_->max_factors = max_factors_;
+        header_->magic.store(FACTOR_MAGIC, std::memory_order_release);
+    }
+}
+
+FactorStore::~FactorStore() {
+    log_.reset();
+    if (names_) fclose(names_);
+    if (base_) munmap(base_, size_);
+}
+
+// ---------- 写入 ----------
+
+bool FactorStore::open_log(const std::string& base_path, uint64_t capacity) {
+    if (!writer_) return false;
+    std::vector<std::string> symbols, factors;
+    load_names(base_path, &symbols, &factors);
+    for (const auto& s : symbols) symbol_index(s.c_str());
+    for (const auto& f : factors) factor_index(f.c_str());
+
+    try {
+        log_ = std::make_unique<MmapWriter<FactorLogRecord>>(base_path, capacity);
+    } catch (const std::exception& e) {
+        std::cerr << "[FactorStore] 打开日志失败: " << e.what() << std::endl;
+        return false;
+    }
+    names_ = fopen((base_path + ".names").c_str(), "a");
+    if (!names_) {
+        std::cerr << "[FactorStore] 打开名称表失败: " << base_path << ".names" << std::endl;
+        log_.reset();
+        return false;
+    }
+    return true;
+}
+
+int FactorStore::assign(bool symbol, const char* name) {
+    std::atomic<uint32_t>& count = symbol ? header_->symbols : header_->factors;
+    uint32_t n = count.load(std::memory_order_relaxed);
+    if (n >= (symbol ? max_symbols_ : max_factors_)) return -1;
+    char* slot = (symbol ? symbol_names_ : factor_names_) + static_cast<size_t>(n) * NAME_LEN;
+    std::strncpy(slot, name, NAME_LEN - 1);
+    count.store(n + 1, std::memory_order_release);
+    if (names_) {
+        std::fprintf(names_, "%c %u %s\n", symbol ? 'S' : 'F', n, slot);
+        std::fflush(names_);
+    }
+    return static_cast<int>(n);
+}
+
+int FactorStore::symbol_index(const char* symbol) {
+    std::string key(symbol, strnlen(symbol, NAME_LEN - 1));
+    auto it = symbol_ids_.find(key);
+    if (it != symbol_ids_.end()) return it->second;
+    int idx = assign(true, key.c_str());
+    if (idx >= 0) symbol_ids_.emplace(std::move(key), idx);
+    return idx;
+}
+
+int FactorStore::factor_index(const char* name) {
+    for (size_t i = 0; i < factor_list_.size(); ++i) {
+        if (std::strncmp(factor_list_[i].c_str(), name, NAME_LEN - 1) == 0) return static_cast<int>(i);
+    }
+    std::string key(name, strnlen(name, NAME_LEN - 1));
+    int idx = assign(false, key.c_str());
+    if (idx >= 0) factor_list_.push_back(std::move(key));
+    return idx;
+}
+
+FactorStore::Cell& FactorStore::cell(int symbol_idx, int factor_idx) const {
+    return cells_[static_cast<size_t>(symbol_idx) * max_factors_ + factor_idx];
+}
+
+void FactorStore::update(int symbol_idx, int factor_idx, double value, uint64_t timestamp) {
+    const uint64_t seq = ++seq_;
+    Cell& c = cell(symbol_idx, factor_idx);
+    const uint32_t s = c.seq.load(std::memory_order_relaxed);
+    c.seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    c.value = value;
+    c.timestamp = timestamp;
+    c.update_seq = seq;
+    c.seq.store(s + 2, std::memory_order_release);
+    header_->update_seq.store(seq, std::memory_order_release);
+
+    if (log_) {
+        FactorLogRecord* rec = log_->reserve();
+        if (!rec) {
+            ++dropped_;
+            return;
+        }
+        rec->trading_day = trading_day_;
+        rec->timestamp = static_cast<uint32_t>(timestamp);
+        rec->symbol_idx = static_cast<uint32_t>(symbol_idx);
+        rec->factor_idx = static_cast<uint32_t>(factor_idx);
+        rec->value = value;
+        log_->commit(1);
+        log_->publish();
+        ++logged_;
+    }
+}
+
+bool FactorStore::update(const SignalRecord& sig) {
+    // 同一 Tick 的多个因子来自同一合约：先比对上一条的合约名，命中时免去哈希查找
+    int sym = last_symbol_idx_;
+    if (sym < 0 || std::strncmp(last_symbol_, sig.symbol, NAME_LEN - 1) != 0) {
+        sym = symbol_index(sig.symbol);
+        const size_t len = strnlen(sig.symbol, NAME_LEN - 1);
+        std::memcpy(last_symbol_, sig.symbol, len);
+        last_symbol_[len] = '\0';
+        last_symbol_idx_ = sym;
+    }
+    int f;
+    if (last_factor_ < factor_list_.size() &&
+        std::strncmp(factor_list_[last_factor_].c_str(), sig.factor_name, NAME_LEN) == 0) {
+        f = static_cast<int>(last_factor_);
+    } else {
+        f = factor_index(sig.factor_name);
+        if (f >= 0) last_factor_ = static_cast<size_t>(f);
+    }
+    if (sym < 0 || f < 0) {
+        ++dropped_;
+        return false;
+    }
+    update(sym, f, sig.value, sig.timestamp);
+    return true;
+}
+
+// ---------- 读取 ----------
+
+bool FactorStore::read(int symbol_idx, int factor_idx, FactorValue& out) const {
+    if (symbol_idx < 0 || factor_idx < 0 ||
+        static_cast<uint32_t>(symbol_idx) >= max_symbols_ || static_cast<uint32_t>(factor_idx) >= max_factors_) {
+        return false;
+    }
+    const Cell& c = cell(symbol_idx, factor_idx);
+    for (int retry = 0; retry < 64; ++retry) {
+        uint32_t s1 = c.seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        out.value = c.value;
+        out.timestamp = c.timestamp;
+        out.seq = c.update_seq;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (c.seq.load(std::memory_order_relaxed) == s1) return out.seq != 0;
+    }
+    return false;
+}
+
+int FactorStore::find_symbol(const char* symbol) const {
+    uint32_t n = symbols();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (std::strncmp(symbol_names_ + static_cast<size_t>(i) * NAME_LEN, symbol, NAME_LEN) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int FactorStore::find_factor(const char* name) const {
+    uint32_t n = factors();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (std::strncmp(factor_names_ + static_cast<size_t>(i) * NAME_LEN, name, NAME_LEN) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+uint32_t FactorStore::symbols() const { return header_->symbols.load(std::memory_order_acquire); }
+uint32_t FactorStore::factors() const { return header_->factors.load(std::memory_order_acquire); }
+
+const char* FactorStore::symbol_name(uint32_t idx) const {
+    return idx < symbols() ? symbol_names_ + static_cast<size_t>(idx) * NAME_LEN : "";
+}
+
+const char* FactorStore::factor_name(uint32_t idx) const {
+    return idx < factors() ? factor_names_ + static_cast<size_t>(idx) * NAME_LEN : "";
+}
+
+uint64_t FactorStore::update_seq() const { return header_->update_seq.load(std::memory_order_acquire); }
+
+bool FactorStore::load_names(const std::string& base_path, std::vector<std::string>* symbols,
+                             std::vector<std::string>* factors) {
+    std::ifstream in(base_path + ".names");
+    if (!in.is_open()) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        char kind;
+        size_t idx;
+        std::string name;
+        if (!(iss >> kind >> idx >> name)) continue;
+        std::vector<std::string>* list = kind == 'S' ? symbols : kind == 'F' ? factors : nullptr;
+        if (!list) continue;
+        if (list->size() <= idx) list->resize(idx + 1);
+        (*list)[idx] = name;
+    }
+    return true;
+}
@@ -0,0 +1,291 @@
+#include "../include/kline_engine.h"
+#include "../include/symbol_manager.h"
+#include "../include/tick_normalizer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+constexpr uint32_t MS_PER_DAY = 86400000;
+
+KlineInterval interval_of(const KlineSpec& spec) {
+    if (spec.type != KLINE_TIME) return static_cast<KlineInterval>(0);
+    if (spec.daily()) return K_1D;
+    return static_cast<KlineInterval>(spec.size % 60 == 0 ? spec.size / 60 : 0);
+}
+
+std::string time_label(uint32_t sec) {
+    if (sec >= 86400) return "1d";
+    if (sec % 3600 == 0) return std::to_string(sec / 3600) + "h";
+    if (sec % 60 == 0) return std::to_string(sec / 60) + "m";
+    return std::to_string(sec) + "s";
+}
+
+}
+
+bool KlineSpec::parse(const std::string& text, KlineSpec& out) {
+    std::string t;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) t += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (t.size() < 2) return false;
+
+    KlineSpec spec;
+    char head = t[0];
+    if (head == 't' || head == 'v' || head == 'd') {
+        // 阈值线：t500 / v1000 / d5000
+        std::string num = t.substr(1);
+        if (num.empty() || num.find_first_not_of("0123456789") != std::string::npos) return false;
+        unsigned long n = std::stoul(num);
+        if (n == 0 || n > 0xFFFFFFFFul) return false;
+        spec.type = head == 't' ? KLINE_TICK : (head == 'v' ? KLINE_VOLUME : KLINE_DOLLAR);
+        spec.size = static_cast<uint32_t>(n);
+        spec.label = std::string(1, head) + num;
+    } else {
+        // 时间线：15s / 1m / 1h / 1d
+        char unit = t.back();
+        std::string num = t.substr(0, t.size() - 1);
+        if (num.empty() || num.find_first_not_of("0123456789") != std::string::npos) return false;
+        unsigned long n = std::stoul(num);
+        unsigned long mult = unit == 's' ? 1 : unit == 'm' ? 60 : unit == 'h' ? 3600 : unit == 'd' ? 86400 : 0;
+        if (n == 0 || mult == 0 || n * mult > 86400) return false;
+        spec.type = KLINE_TIME;
+        spec.size = static_cast<uint32_t>(n * mult);
+        spec.label = time_label(spec.size);
+    }
+    out = spec;
+    return true;
+}
+
+bool KlineSpec::parse_list(const std::string& text, std::vector<KlineSpec>& out) {
+    std::vector<KlineSpec> specs;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.find_first_not_of(" \t") == std::string::npos) continue;
+        KlineSpec spec;
+        if (!parse(item, spec)) return false;
+        bool dup = std::any_of(specs.begin(), specs.end(), [&](const KlineSpec& s) { return s.label == spec.label; });
+        if (!dup) specs.push_back(spec);
+    }
+    if (specs.empty()) return false;
+    out = std::move(specs);
+    return true;
+}
+
+std::string KlineSpec::label_of(const KlineRecord& k) {
+    switch (k.type) {
+        case KLINE_TICK: return "t" + std::to_string(k.period);
+        case KLINE_VOLUME: return "v" + std::to_string(k.period);
+        case KLINE_DOLLAR: return "d" + std::to_string(k.period);
+        default: break;
+    }
+    // 旧文件 period 为 0，按 interval (分钟) 还原
+    uint32_t sec = k.period ? k.period : static_cast<uint32_t>(k.interval) * 60;
+    return sec ? time_label(sec) : "unk";
+}
+
+KlineEngine::KlineEngine(std::vector<KlineSpec> specs, const TradingSessions* sessions, EmitFn emit)
+    : specs_(std::move(specs)), sessions_(sessions), emit_(std::move(emit)) {
+    for (const auto& s : specs_) {
+        period_ms_.push_back(s.type != KLINE_TIME ? 0 : (s.daily() ? MS_PER_DAY : s.size * 1000));
+    }
+    size_t n = SymbolManager::instance().count();
+    symbols_.resize(n);
+    bars_.resize(n * specs_.size());
+}
+
+size_t KlineEngine::slot_for(const TickRecord& tick) {
+    int idx = tick.symbol_id ? SymbolManager::instance().get_index(tick.symbol_id) : -1;
+    if (idx >= 0 && static_cast<size_t>(idx) < SymbolManager::instance().count()) return static_cast<size_t>(idx);
+
+    auto it = extra_slots_.find(tick.symbol);
+    if (it != extra_slots_.end()) return it->second;
+    size_t slot = symbols_.size();
+    symbols_.emplace_back();
+    bars_.resize(bars_.size() + specs_.size());
+    extra_slots_.emplace(tick.symbol, slot);
+    return slot;
+}
+
+void KlineEngine::seed(const TickRecord& tick) {
+    SymbolState& s = symbols_[slot_for(tick)];
+    s.trading_day = tick.trading_day;
+    s.last_volume = tick.volume;
+    s.last_turnover = tick.turnover;
+    s.has_base = true;
+}
+
+void KlineEngine::on_tick(const TickRecord& tick) {
+    const size_t slot = slot_for(tick);
+    SymbolState& s = symbols_[slot];
+    if (!s.calendar) s.calendar = &sessions_->for_symbol(tick.symbol);
+    const SessionCalendar& cal = *s.calendar;
+    const uint32_t sms = static_cast<uint32_t>(TickNormalizer::session_ms(tick.update_time));
+
+    if (s.trading_day != tick.trading_day) {
+        if (tick.trading_day < s.trading_day) return;  // 旧交易日的乱序 Tick
+        close_symbol(slot);
+        s.trading_day = tick.trading_day;
+        s.has_base = false;
+    }
+
+    // 成交增量：无基准时只有开盘前集合竞价的累计量可直接计入 (盘中接入时首笔仅作基准)
+    int dv = 0;
+    double dt = 0.0;
+    if (s.has_base) {
+        if (tick.volume >= s.last_volume) {
+            dv = tick.volume - s.last_volume;
+            dt = tick.turnover - s.last_turnover;
+            s.last_volume = tick.volume;
+            s.last_turnover = tick.turnover;
+        }
+    } else {
+        if (!cal.empty() && sms < cal.segments().front().begin) {
+            dv = tick.volume;
+            dt = tick.turnover;
+        }
+        s.last_volume = tick.volume;
+        s.last_turnover = tick.turnover;
+        s.has_base = true;
+    }
+    if (!(tick.last_price > 0.0)) return;
+
+    const uint32_t off = cal.tick_offset(sms);
+    const size_t nspec = specs_.size();
+    BarState* row = &bars_[slot * nspec];
+    for (size_t k = 0; k < nspec; ++k) {
+        BarState& b = row[k];
+        const KlineSpec& spec = specs_[k];
+
+        if (spec.type == KLINE_TIME) {
+            const uint32_t idx = off / period_ms_[k];
+            const uint32_t start = static_cast<uint32_t>(static_cast<uint64_t>(idx) * period_ms_[k]);
+            if (b.open && start != b.start_off) {
+                if (start < b.start_off) {
+                    // 比当前 Bar 更早的乱序 Tick：只计增量
+                    b.bar.volume += dv;
+                    b.bar.turnover += dt;
+                    ++late_ticks_;
+                    continue;
+                }
+                close_bar(b, k);
+                ++closed_by_tick_;
+            }
+            if (!b.open) {
+                if (idx < b.next_index) {
+                    // 所属 Bar 已被定时收线：增量计入下一根
+                    b.carry_volume += dv;
+                    b.carry_turnover += dt;
+                    ++late_ticks_;
+                    continue;
+                }
+                open_bar(b, spec, tick, start, sms, cal);
+                b.end_off = std::min<uint64_t>(static_cast<uint64_t>(start) + period_ms_[k], cal.trading_ms());
+                b.next_index = idx + 1;
+                s.any_open = true;
+            }
+        } else if (!b.open) {
+            open_bar(b, spec, tick, off, sms, cal);
+            s.any_open = true;
+        }
+
+        KlineRecord& k_bar = b.bar;
+        if (tick.last_price > k_bar.high) k_bar.high = tick.last_price;
+        if (tick.last_price < k_bar.low) k_bar.low = tick.last_price;
+        k_bar.close = tick.last_price;
+        k_bar.open_interest = tick.open_interest;
+        k_bar.volume += dv;
+        k_bar.turnover += dt;
+
+        if (spec.type != KLINE_TIME) {
+            b.accum += spec.type == KLINE_TICK ? 1.0 : (spec.type == KLINE_VOLUME ? dv : dt / 10000.0);
+            if (b.accum >= spec.size) {
+                close_bar(b, k);
+                ++closed_by_tick_;
+            }
+        }
+    }
+}
+
+void KlineEngine::on_clock(uint32_t time_of_day_ms) {
+    const uint32_t now = (time_of_day_ms % MS_PER_DAY + MS_PER_DAY - close_delay_ms_ % MS_PER_DAY) % MS_PER_DAY;
+    const uint32_t sms = TradingSessions::session_ms_of_day(now);
+    const size_t nspec = specs_.size();
+
+    for (size_t slot = 0; slot < symbols_.size(); ++slot) {
+        SymbolState& s = symbols_[slot];
+        if (!s.any_open) continue;
+        const SessionCalendar& cal = *s.calendar;
+        const uint32_t clk = cal.clock_offset(sms);
+
+        bool any_open = false;
+        BarState* row = &bars_[slot * nspec];
+        for (size_t k = 0; k < nspec; ++k) {
+            BarState& b = row[k];
+            if (!b.open) continue;
+            // 时钟比开 Bar 时刻早 1 小时以上：已进入下一交易日 (18:00 翻日)
+            bool due = sms + 3600000 < b.open_sms;
+            due = due || clk >= (specs_[k].type == KLINE_TIME ? b.end_off : cal.trading_ms());
+            if (due) {
+                close_bar(b, k);
+                ++closed_by_timer_;
+            } else {
+                any_open = true;
+            }
+        }
+        s.any_open = any_open;
+    }
+}
+
+void KlineEngine::flush() {
+    for (size_t slot = 0; slot < symbols_.size(); ++slot) {
+        if (symbols_[slot].any_open) close_symbol(slot);
+    }
+}
+
+void KlineEngine::open_bar(BarState& b, const KlineSpec& spec, const TickRecord& tick, uint32_t offset,
+                           uint32_t sms, const SessionCalendar& cal) {
+    KlineRecord& k = b.bar;
+    std::memset(&k, 0, sizeof(k));
+    std::memcpy(k.symbol, tick.symbol, sizeof(k.symbol) - 1);
+    k.symbol_id = tick.symbol_id;
+    k.trading_day = tick.trading_day;
+    k.period = spec.size;
+    k.type = spec.type;
+    k.interval = interval_of(spec);
+    k.start_time = spec.type == KLINE_TIME ? TradingSessions::to_hhmmssmmm(cal.offset_to_session_ms(offset))
+                                           : tick.update_time;
+    k.open = k.high = k.low = k.close = tick.last_price;
+    k.open_interest = tick.open_interest;
+    k.volume = b.carry_volume;
+    k.turnover = b.carry_turnover;
+
+    b.carry_volume = 0;
+    b.carry_turnover = 0.0;
+    b.start_off = offset;
+    b.end_off = 0;
+    b.open_sms = sms;
+    b.accum = 0.0;
+    b.open = true;
+}
+
+void KlineEngine::close_bar(BarState& b, size_t spec_index) {
+    b.open = false;
+    emit_(b.bar, spec_index);
+}
+
+void KlineEngine::close_symbol(size_t slot) {
+    const size_t nspec = specs_.size();
+    BarState* row = &bars_[slot * nspec];
+    for (size_t k = 0; k < nspec; ++k) {
+        if (row[k].open) close_bar(row[k], k);
+        row[k].next_index = 0;
+        row[k].carry_volume = 0;
+        row[k].carry_turnover = 0.0;
+    }
+    symbols_[slot].any_open = false;
+}
@@ -0,0 +1,407 @@
+#include "../include/kline_store.h"
+#include "../include/symbol_manager.h"
+#include "../include/tick_normalizer.h"
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t STORE_MAGIC = 0x314552544F534C4BULL;  // "KLSTORE1"
+constexpr uint32_t STORE_VERSION = 1;
+constexpr size_t PAGE = 4096;
+
+// 文件头 (独占首页)
+struct StoreHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t trading_day;
+    uint32_t max_symbols;
+    uint32_t capacity;               // 每合约最多 Bar 数
+    uint32_t period;
+    KlineType type;
+    uint8_t reserved[3];
+    std::atomic<uint32_t> symbols;   // 已分配槽位数 (release 发布)
+    char interval[16];
+};
+static_assert(sizeof(StoreHeader) <= PAGE, "StoreHeader must fit in one page");
+
+// 合约索引槽位
+struct StoreSlot {
+    uint64_t symbol_id;
+    char symbol[32];
+    std::atomic<uint32_t> count;     // 已写入条数 (release 发布)
+    uint32_t reserved;
+};
+static_assert(sizeof(StoreSlot) == 48, "StoreSlot layout is part of the .kls format");
+
+size_t round_page(size_t n) { return (n + PAGE - 1) / PAGE * PAGE; }
+
+// 单合约单日容量：时间线按 12 小时交易时长估算，阈值线固定 8192 根
+uint32_t capacity_of(const KlineRecord& bar) {
+    if (bar.type != KLINE_TIME) return 8192;
+    uint32_t sec = bar.period ? bar.period : static_cast<uint32_t>(bar.interval) * 60;
+    if (sec == 0 || sec >= 86400) return 4;
+    return 12 * 3600 / sec + 16;
+}
+
+inline uint32_t session_key(const KlineRecord& k) {
+    return static_cast<uint32_t>(TickNormalizer::session_ms(k.start_time));
+}
+
+// 把某交易日的合约区裁剪到 [from, to]：只有首尾两日需要二分
+KlineSpan clip(KlineSpan s, uint32_t day, uint64_t from, uint64_t to) {
+    const KlineRecord* b = s.begin();
+    const KlineRecord* e = s.end();
+    if (day == static_cast<uint32_t>(from >> 32)) {
+        b = std::lower_bound(b, e, static_cast<uint32_t>(from),
+                             [](const KlineRecord& k, uint32_t v) { return session_key(k) < v; });
+    }
+    if (day == static_cast<uint32_t>(to >> 32)) {
+        e = std::upper_bound(b, e, static_cast<uint32_t>(to),
+                             [](uint32_t v, const KlineRecord& k) { return v < session_key(k); });
+    }
+    return {b, b < e ? static_cast<size_t>(e - b) : 0};
+}
+
+}
+
+struct KlineStore::DayFile {
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    StoreHeader* header = nullptr;
+    StoreSlot* slots = nullptr;
+    KlineRecord* data = nullptr;
+
+    uint32_t known = 0;  // 已建立索引的槽位数
+    std::unordered_map<uint64_t, uint32_t> by_id;
+    std::unordered_map<std::string, uint32_t> by_name;
+
+    ~DayFile() {
+        if (base) munmap(base, size);
+    }
+
+    static size_t data_offset(uint32_t max_symbols) {
+        return PAGE + round_page(static_cast<size_t>(max_symbols) * sizeof(StoreSlot));
+    }
+
+    bool map(int fd, size_t bytes, bool writable) {
+        void* p = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        base = static_cast<uint8_t*>(p);
+        size = bytes;
+        header = reinterpret_cast<StoreHeader*>(base);
+        slots = reinterpret_cast<StoreSlot*>(base + PAGE);
+        return true;
+    }
+
+    bool valid() {
+        const StoreHeader* h = header;
+        if (h->magic != STORE_MAGIC || h->version != STORE_VERSION || h->capacity == 0) return false;
+        if (size < data_offset(h->max_symbols) + static_cast<size_t>(h->max_symbols) * h->capacity * sizeof(KlineRecord)) {
+            return false;
+        }
+        data = reinterpret_cast<KlineRecord*>(base + data_offset(h->max_symbols));
+        return true;
+    }
+
+    // 同步写者新分配的槽位
+    void sync() {
+        uint32_t n = std::min(header->symbols.load(std::memory_order_acquire), header->max_symbols);
+        for (; known < n; ++known) {
+            if (slots[known].symbol_id) by_id.emplace(slots[known].symbol_id, known);
+            by_name.emplace(slots[known].symbol, known);
+        }
+    }
+
+    int find(uint64_t symbol_id, const char* symbol) {
+        for (int pass = 0; pass < 2; ++pass) {
+            if (symbol_id) {
+                auto it = by_id.find(symbol_id);
+                if (it != by_id.end()) return static_cast<int>(it->second);
+            } else if (symbol) {
+                auto it = by_name.find(symbol);
+                if (it != by_name.end()) return static_cast<int>(it->second);
+            }
+            if (pass == 0) sync();
+        }
+        return -1;
+    }
+
+    KlineSpan span(uint32_t slot) const {
+        uint32_t n = std::min(slots[slot].count.load(std::memory_order_acquire), header->capacity);
+        return {data + static_cast<size_t>(slot) * header->capacity, n};
+    }
+};
+
+KlineStore::KlineStore(std::string root, bool writable, uint32_t max_symbols)
+    : root_(std::move(root)), writable_(writable), max_symbols_(max_symbols) {
+    if (max_symbols_ == 0) {
+        max_symbols_ = static_cast<uint32_t>(std::max<size_t>(SymbolManager::instance().count() + 256, 1024));
+    }
+    if (writable_) {
+        std::error_code ec;
+        fs::create_directories(root_, ec);
+    }
+}
+
+KlineStore::~KlineStore() = default;
+
+uint64_t KlineStore::key(uint32_t trading_day, uint64_t hhmmssmmm) {
+    return (static_cast<uint64_t>(trading_day) << 32) | TickNormalizer::session_ms(hhmmssmmm);
+}
+
+uint64_t KlineStore::day_begin(uint32_t trading_day) {
+    return static_cast<uint64_t>(trading_day) << 32;
+}
+
+uint64_t KlineStore::day_end(uint32_t trading_day) {
+    return (static_cast<uint64_t>(trading_day) << 32) | 0xFFFFFFFFULL;
+}
+
+std::string KlineStore::path(const std::string& root, const std::string& interval, uint32_t trading_day) {
+    return root + "/kline_" + interval + "_" + std::to_string(trading_day) + ".kls";
+}
+
+KlineStore::DayFile* KlineStore::open_day(const std::string& interval, uint32_t day, bool create,
+                                          const KlineRecord* proto) {
+    auto key = std::make_pair(interval, day);
+    auto it = files_.find(key);
+    if (it != files_.end()) return it->second.get();
+
+    std::string p = path(root_, interval, day);
+    int fd = open(p.c_str(), create ? O_RDWR | O_CREAT : (writable_ ? O_RDWR : O_RDONLY), 0666);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    auto file = std::make_unique<DayFile>();
+    bool ok = fstat(fd, &st) == 0;
+    size_t bytes = ok ? static_cast<size_t>(st.st_size) : 0;
+    const bool fresh = ok && bytes == 0;
+    if (fresh) {
+        // 新建：稀疏文件，只有写入过的页占磁盘
+        ok = create && proto;
+        uint32_t cap = ok ? capacity_of(*proto) : 0;
+        bytes = DayFile::data_offset(max_symbols_) + static_cast<size_t>(max_symbols_) * cap * sizeof(KlineRecord);
+        ok = ok && ftruncate(fd, static_cast<off_t>(bytes)) == 0 && file->map(fd, bytes, true);
+        if (ok) {
+            StoreHeader* h = file->header;
+            h->version = STORE_VERSION;
+            h->trading_day = day;
+            h->max_symbols = max_symbols_;
+            h->capacity = cap;
+            h->period = proto->period;
+            h->type = proto->type;
+            h->symbols.store(0, std::memory_order_relaxed);
+            std::strncpy(h->interval, interval.c_str(), sizeof(h->interval) - 1);
+            std::atomic_thread_fence(std::memory_order_release);
+            h->magic = STORE_MAGIC;  // 最后写 magic：读者看到 magic 时头部已完整
+        }
+    } else if (ok) {
+        ok = bytes >= PAGE && file->map(fd, bytes, writable_);
+    }
+    close(fd);
+    ok = ok && file->valid();
+    if (!ok) {
+        if (create) std::cerr << "[KlineStore] Failed to open " << p << std::endl;
+        return nullptr;
+    }
+
+    file->sync();
+    auto& days = days_[interval];
+    auto pos = std::lower_bound(days.begin(), days.end(), day);
+    if (pos == days.end() || *pos != day) days.insert(pos, day);
+
+    DayFile* raw = file.get();
+    files_.emplace(std::move(key), std::move(file));
+    return raw;
+}
+
+bool KlineStore::append(const KlineRecord& bar, const std::string& interval) {
+    if (!writable_) return false;
+
+    DayFile* f = last_file_;
+    if (!f || last_day_ != bar.trading_day || last_interval_ != interval) {
+        f = open_day(interval, bar.trading_day, true, &bar);
+        if (!f) return false;
+        last_file_ = f;
+        last_day_ = bar.trading_day;
+        last_interval_ = interval;
+    }
+
+    int slot = f->find(bar.symbol_id, bar.symbol_id ? nullptr : bar.symbol);
+    if (slot < 0) {
+        // 分配新槽位：先写索引，再发布槽位数
+        StoreHeader* h = f->header;
+        uint32_t n = h->symbols.load(std::memory_order_relaxed);
+        if (n >= h->max_symbols) return false;
+        StoreSlot& s = f->slots[n];
+        s.symbol_id = bar.symbol_id;
+        std::memcpy(s.symbol, bar.symbol, sizeof(s.symbol));
+        s.symbol[sizeof(s.symbol) - 1] = '\0';
+        s.count.store(0, std::memory_order_relaxed);
+        h->symbols.store(n + 1, std::memory_order_release);
+        f->sync();
+        slot = static_cast<int>(n);
+    }
+
+    StoreSlot& s = f->slots[slot];
+    uint32_t n = s.count.load(std::memory_order_relaxed);
+    if (n >= f->header->capacity) return false;
+    KlineRecord* region = f->data + static_cast<size_t>(slot) * f->header->capacity;
+    // 区内保持时间有序：不晚于末条的时间线 Bar 视为重复写入 (如同一交易日重放)，阈值线允许同一时刻开多根
+    if (n > 0) {
+        uint32_t last = session_key(region[n - 1]);
+        uint32_t cur = session_key(bar);
+        if (cur < last || (cur == last && bar.type == KLINE_TIME)) return false;
+    }
+    region[n] = bar;
+    s.count.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+void KlineStore::scan() {
+    // readdir 而非 std::filesystem：策略 init 时的冷启动查询对这里敏感
+    DIR* dir = opendir(root_.c_str());
+    if (dir) {
+        while (struct dirent* e = readdir(dir)) {
+            // kline_<interval>_<day>.kls
+            const char* name = e->d_name;
+            size_t len = std::strlen(name);
+            if (len < 6 + 4 + 2 || std::strncmp(name, "kline_", 6) != 0 || std::strcmp(name + len - 4, ".kls") != 0) {
+                continue;
+            }
+            const char* us = static_cast<const char*>(memrchr(name, '_', len));
+            if (us == nullptr || us <= name + 6 || us + 1 >= name + len - 4) continue;
+            uint32_t day = 0;
+            bool digits = true;
+            for (const char* c = us + 1; c < name + len - 4; ++c) {
+                if (*c < '0' || *c > '9') { digits = false; break; }
+                day = day * 10 + static_cast<uint32_t>(*c - '0');
+            }
+            if (!digits) continue;
+            auto& days = days_[std::string(name + 6, us)];
+            auto pos = std::lower_bound(days.begin(), days.end(), day);
+            if (pos == days.end() || *pos != day) days.insert(pos, day);
+        }
+        closedir(dir);
+    }
+    scanned_ = true;
+}
+
+void KlineStore::refresh() { scan(); }
+
+std::vector<uint32_t>& KlineStore::day_list(const std::string& interval, uint32_t need_day) {
+    auto& days = days_[interval];
+    // 首次查询或请求的交易日晚于已知最后一日时扫描目录
+    if (!scanned_ || (need_day && (days.empty() || days.back() < need_day))) {
+        scan();
+    }
+    return days_[interval];
+}
+
+std::vector<uint32_t> KlineStore::days(const std::string& interval) {
+    return day_list(interval, 0);
+}
+
+std::vector<std::string> KlineStore::intervals() {
+    if (!scanned_) scan();
+    std::vector<std::string> out;
+    for (const auto& kv : days_) {
+        if (!kv.second.empty()) out.push_back(kv.first);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<KlineSpan> KlineStore::get_bars(uint64_t symbol_id, const std::string& interval,
+                                            uint64_t from, uint64_t to) {
+    std::vector<KlineSpan> out;
+    const uint32_t from_day = static_cast<uint32_t>(from >> 32);
+    const uint32_t to_day = static_cast<uint32_t>(to >> 32);
+    const auto& days = day_list(interval, to == KEY_MAX ? 0 : to_day);
+
+    auto first = std::lower_bound(days.begin(), days.end(), from_day);
+    for (auto d = first; d != days.end() && *d <= to_day; ++d) {
+        DayFile* f = open_day(interval, *d, false, nullptr);
+        if (!f) continue;
+        int slot = f->find(symbol_id, nullptr);
+        if (slot < 0) continue;
+        KlineSpan s = clip(f->span(static_cast<uint32_t>(slot)), *d, from, to);
+        if (!s.empty()) out.push_back(s);
+    }
+    return out;
+}
+
+std::vector<KlineSpan> KlineStore::get_bars(const char* symbol, const std::string& interval,
+                                            uint64_t from, uint64_t to) {
+    uint64_t id = SymbolManager::instance().get_id(symbol);
+    if (id) return get_bars(id, interval, from, to);
+
+    // 未注册合约：按名字逐日查找
+    std::vector<KlineSpan> out;
+    const uint32_t from_day = static_cast<uint32_t>(from >> 32);
+    const uint32_t to_day = static_cast<uint32_t>(to >> 32);
+    const auto& days = day_list(interval, to == KEY_MAX ? 0 : to_day);
+    for (auto d = std::lower_bound(days.begin(), days.end(), from_day); d != days.end() && *d <= to_day; ++d) {
+        DayFile* f = open_day(interval, *d, false, nullptr);
+        int slot = f ? f->find(0, symbol) : -1;
+        if (slot < 0) continue;
+        uint64_t sid = f->slots[slot].symbol_id;
+        if (sid) {
+            // 文件中记录了 ID，转回按 ID 的区间查询
+            return get_bars(sid, interval, from, to);
+        }
+        KlineSpan s = clip(f->span(static_cast<uint32_t>(slot)), *d, from, to);
+        if (!s.empty()) out.push_back(s);
+    }
+    return out;
+}
+
+std::vector<KlineSpan> KlineStore::last_bars(uint64_t symbol_id, const std::string& interval, size_t n,
+                                             uint64_t to) {
+    std::vector<KlineSpan> out;
+    if (n == 0) return out;
+    const uint32_t to_day = static_cast<uint32_t>(to >> 32);
+    const auto& days = day_list(interval, to == KEY_MAX ? 0 : to_day);
+
+    auto d = std::upper_bound(days.begin(), days.end(), to_day);
+    while (d != days.begin() && n > 0) {
+        --d;
+        DayFile* f = open_day(interval, *d, false, nullptr);
+        if (!f) continue;
+        int slot = f->find(symbol_id, nullptr);
+        if (slot < 0) continue;
+        KlineSpan s = clip(f->span(static_cast<uint32_t>(slot)), *d, 0, to);
+        size_t take = std::min(s.size, n);
+        if (take > 0) {
+            out.push_back({s.end() - take, take});
+            n -= take;
+        }
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+std::vector<KlineSpan> KlineStore::day_bars(const std::string& interval, uint32_t trading_day) {
+    std::vector<KlineSpan> out;
+    day_list(interval, trading_day);
+    DayFile* f = open_day(interval, trading_day, false, nullptr);
+    if (!f) return out;
+    f->sync();
+    for (uint32_t i = 0; i < f->known; ++i) {
+        KlineSpan s = f->span(i);
+        if (!s.empty()) out.push_back(s);
+    }
+    return out;
+}
@@ -0,0 +1,62 @@
+#include "../include/latency_trace.h"
+#include "../include/clock.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+std::atomic<ILatencySink*> g_sink{nullptr};
+std::atomic<IClock*> g_clock{nullptr};
+WallClock g_wall_clock;
+
+// 当前线程正在传递的链路 (行情段在 begin_tick 时填写，报单段随调用栈逐级打点)
+thread_local OrderLatency t_trace{};
+
+}
+
+void LatencyTrace::set_sink(ILatencySink* sink) {
+    g_sink.store(sink, std::memory_order_release);
+}
+
+void LatencyTrace::set_clock(IClock* clock) {
+    g_clock.store(clock, std::memory_order_release);
+}
+
+bool LatencyTrace::enabled() {
+    return g_sink.load(std::memory_order_relaxed) != nullptr;
+}
+
+uint64_t LatencyTrace::now_ns() {
+    IClock* clock = g_clock.load(std::memory_order_acquire);
+    return clock ? clock->now_ns() : g_wall_clock.now_ns();
+}
+
+void LatencyTrace::begin_tick(const TickRecord& tick, uint64_t recv_ns) {
+    if (!enabled()) return;
+    std::memset(&t_trace, 0, sizeof(t_trace));
+    t_trace.symbol_id = tick.symbol_id;
+    t_trace.ts[LAT_MD_RECV] = recv_ns;
+    t_trace.ts[LAT_MD_PUB] = now_ns();
+}
+
+void LatencyTrace::end_tick() {
+    if (!enabled()) return;
+    std::memset(&t_trace, 0, sizeof(t_trace));
+}
+
+void LatencyTrace::stamp(LatencyStage stage) {
+    if (!enabled()) return;
+    t_trace.ts[stage] = now_ns();
+}
+
+void LatencyTrace::egress(const OrderReq& req) {
+    ILatencySink* sink = g_sink.load(std::memory_order_acquire);
+    if (!sink) return;
+    t_trace.ts[LAT_API_RET] = now_ns();
+    t_trace.client_id = req.client_id;
+    sink->on_order(t_trace);
+
+    t_trace.client_id = 0;
+    for (int s = LAT_RISK; s < LAT_STAGE_COUNT; ++s) t_trace.ts[s] = 0;
+}
@@ -26,31 +26,8 @@ void MarketSnapshot::set_instance(MarketSnapshot* inst) {
     g_instance = inst;
 }
 
-// ==========================================
-// LocalMarketSnapshot 实现
-// ==========================================
-LocalMarketSnapshot::LocalMarketSnapshot() {
-    std::memset(slots_, 0, sizeof(slots_));
-}
-
-void LocalMarketSnapshot::update(const TickRecord& rec) {
-    uint64_t id = rec.symbol_id;
-    if (id >= MARKET_SNAPSHOT_MAX_SYMBOLS) return;
-    
-    MarketSnapshotSlot& slot = slots_[id];
-    uint32_t s = slot.seq.load(std::memory_order_relaxed);
-    slot.seq.store(s + 1, std::memory_order_release);
-    
-    std::atomic_thread_fence(std::memory_order_release);
-    slot.tick = rec;
-    
-    slot.seq.store(s + 2, std::memory_order_release);
-}
-
-bool LocalMarketSnapshot::get(uint64_t symbol_id, TickRecord& out) const {
-    if (symbol_id >= MARKET_SNAPSHOT_MAX_SYMBOLS) return false;
-    
-    const MarketSnapshotSlot& slot = slots_[symbol_id];
+// SeqLock 读：成功且槽位写入过返回 true
+bool MarketSnapshot::read_slot(const MarketSnapshotSlot& slot, TickRecord& out) {
     uint32_t s1, s2;
     int retries = 0;
     
@@ -73,6 +50,41 @@ bool LocalMarketSnapshot::get(uint64_t symbol_id, TickRecord& out) const {
     return false;
 }
 
+// ==========================================
+// LocalMarketSnapshot 实现
+// ==========================================
+LocalMarketSnapshot::LocalMarketSnapshot() {
+    std::memset(slots_, 0, sizeof(slots_));
+}
+
+void LocalMarketSnapshot::update(const TickRecord& rec) {
+    uint64_t idx = slot_index(rec.symbol_id);
+    if (idx >= MARKET_SNAPSHOT_MAX_SYMBOLS) return;
+    
+    MarketSnapshotSlot& slot = slots_[idx];
+    uint32_t s = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(s + 1, std::memory_order_release);
+    
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.tick = rec;
+    
+    slot.seq.store(s + 2, std::memory_order_release);
+}
+
+bool LocalMarketSnapshot::get(uint64_t symbol_id, TickRecord& out) const {
+    uint64_t idx = slot_index(symbol_id);
+    if (idx >= MARKET_SNAPSHOT_MAX_SYMBOLS) return false;
+    return read_slot(slots_[idx], out);
+}
+
+size_t LocalMarketSnapshot::copy_all(TickRecord* out, size_t max_count) const {
+    size_t count = 0;
+    for (size_t i = 0; i < MARKET_SNAPSHOT_MAX_SYMBOLS && count < max_count; ++i) {
+        if (read_slot(slots_[i], out[count])) ++count;
+    }
+    return count;
+}
+
 void LocalMarketSnapshot::clear() {
     for (auto& slot : slots_) {
         slot.seq.store(0, std::memory_order_release);
@@ -100,6 +112,13 @@ ShmMarketSnapshot::ShmMarketSnapshot(const std::string& shm_name, bool is_writer
             close(fd);
             throw std::runtime_error("Failed to ftruncate SHM");
         }
+    } else {
+        // 旧版本写端创建的 SHM 不含变更通知区，映射越界会 SIGBUS
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < shm_size_) {
+            close(fd);
+            throw std::runtime_error("SHM size mismatch: " + shm_name);
+        }
     }
 
     void* ptr = mmap(nullptr, shm_size_, PROT_READ | (is_writer ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
@@ -144,6 +163,7 @@ void ShmMarketSnapshot::update(const TickRecord& rec) {
             layout_->slot_count.fetch_sub(1, std::memory_order_relaxed);
             return; // 满了
         }
+        layout_->slot_symbol_id[target_idx] = id;
         layout_->symbol_index[idx] = target_idx;
     }
 
@@ -155,6 +175,13 @@ void ShmMarketSnapshot::update(const TickRecord& rec) {
     slot.tick = rec;
     
     slot.seq.store(s + 2, std::memory_order_release);
+
+    // 变更通知：先写日志条目，最后发布全局序号 (单写者，无需 CAS)
+    uint64_t gseq = layout_->update_seq.load(std::memory_order_relaxed) + 1;
+    layout_->slot_update_seq[target_idx].store(gseq, std::memory_order_relaxed);
+    layout_->change_log[gseq & CHANGE_LOG_MASK].store(
+        (gseq << CHANGE_SLOT_BITS) | static_cast<uint64_t>(target_idx), std::memory_order_relaxed);
+    layout_->update_seq.store(gseq, std::memory_order_release);
 }
 
 bool ShmMarketSnapshot::get(uint64_t symbol_id, TickRecord& out) const {
@@ -164,28 +191,18 @@ bool ShmMarketSnapshot::get(uint64_t symbol_id, TickRecord& out) const {
     int32_t target_idx = layout_->symbol_index[idx];
 
     if (target_idx == -1 || target_idx >= MARKET_SNAPSHOT_MAX_SYMBOLS) return false;
-    
-    const MarketSnapshotSlot& slot = layout_->slots[target_idx];
-    uint32_t s1, s2;
-    int retries = 0;
-    
-    do {
-        s1 = slot.seq.load(std::memory_order_acquire);
-        if (s1 & 1) {
-            _mm_pause();
-            continue;
-        }
-        
-        out = slot.tick;
-        std::atomic_thread_fence(std::memory_order_acquire);
-        
-        s2 = slot.seq.load(std::memory_order_acquire);
-        if (s1 == s2) return s1 != 0;
-        
-        _mm_pause();
-    } while (++retries < 16);
-    
-    return false;
+    return read_slot(layout_->slots[target_idx], out);
+}
+
+size_t ShmMarketSnapshot::copy_all(TickRecord* out, size_t max_count) const {
+    int32_t n = layout_->slot_count.load(std::memory_order_acquire);
+    if (n > MARKET_SNAPSHOT_MAX_SYMBOLS) n = MARKET_SNAPSHOT_MAX_SYMBOLS;
+
+    size_t count = 0;
+    for (int32_t i = 0; i < n && count < max_count; ++i) {
+        if (read_slot(layout_->slots[i], out[count])) ++count;
+    }
+    return count;
 }
 
 void ShmMarketSnapshot::clear() {
@@ -196,5 +213,65 @@ void ShmMarketSnapshot::clear() {
     layout_->slot_count.store(0, std::memory_order_release);
     for (int i = 0; i < MARKET_SNAPSHOT_MAX_SYMBOLS; ++i) {
         layout_->slots[i].seq.store(0, std::memory_order_release);
+        layout_->slot_update_seq[i].store(0, std::memory_order_relaxed);
+    }
+    // update_seq 保持单调，读者据此感知不到回退
+}
+
+uint64_t ShmMarketSnapshot::update_seq() const {
+    return layout_->update_seq.load(std::memory_order_acquire);
+}
+
+size_t ShmMarketSnapshot::collect_changes(uint64_t since_seq, uint64_t* out_ids, size_t max_count, uint64_t* next_seq) const {
+    const uint64_t cur = layout_->update_seq.load(std::memory_order_acquire);
+    if (next_seq) *next_seq = cur;
+    if (cur <= since_seq) return 0;
+
+    // 读者落后超过日志容量：条目已被覆盖，退化为槽位扫描
+    if (cur - since_seq > MARKET_SNAPSHOT_CHANGE_LOG_SIZE) {
+        return scan_changes(since_seq, out_ids, max_count, next_seq);
+    }
+
+    // 读者私有的脏位图，用于同一槽位多次更新的去重
+    uint64_t seen[(MARKET_SNAPSHOT_MAX_SYMBOLS + 63) / 64] = {0};
+    size_t count = 0;
+    constexpr uint64_t slot_mask = (1ull << CHANGE_SLOT_BITS) - 1;
+    constexpr uint64_t seq_mask = ~0ull >> CHANGE_SLOT_BITS;
+
+    for (uint64_t s = since_seq + 1; s <= cur; ++s) {
+        uint64_t entry = layout_->change_log[s & CHANGE_LOG_MASK].load(std::memory_order_acquire);
+        if ((entry >> CHANGE_SLOT_BITS) != (s & seq_mask)) {
+            // 遍历过程中被写端追上覆盖
+            return scan_changes(since_seq, out_ids, max_count, next_seq);
+        }
+        uint32_t slot = static_cast<uint32_t>(entry & slot_mask);
+        uint64_t bit = 1ull << (slot & 63);
+        if (seen[slot >> 6] & bit) continue;
+        seen[slot >> 6] |= bit;
+
+        if (count >= max_count) {
+            // 输出已满：从当前序号之前截断，剩余部分留给下次调用
+            if (next_seq) *next_seq = s - 1;
+            return count;
+        }
+        out_ids[count++] = layout_->slot_symbol_id[slot];
+    }
+    return count;
+}
+
+size_t ShmMarketSnapshot::scan_changes(uint64_t since_seq, uint64_t* out_ids, size_t max_count, uint64_t* next_seq) const {
+    int32_t n = layout_->slot_count.load(std::memory_order_acquire);
+    if (n > MARKET_SNAPSHOT_MAX_SYMBOLS) n = MARKET_SNAPSHOT_MAX_SYMBOLS;
+
+    size_t count = 0;
+    for (int32_t i = 0; i < n; ++i) {
+        if (layout_->slot_update_seq[i].load(std::memory_order_relaxed) <= since_seq) continue;
+        if (count >= max_count) {
+            // 扫描模式无法按序号截断，下次从原位置重来
+            if (next_seq) *next_seq = since_seq;
+            break;
+        }
+        out_ids[count++] = layout_->slot_symbol_id[i];
     }
+    return count;
 }
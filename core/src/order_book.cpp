@@ -0,0 +1,283 @@
+#include "../include/order_book.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+inline bool valid_level(double price, int volume) {
+    // CTP 空档位价格为 DBL_MAX 或 0
+    return volume > 0 && price > 0.0 && price < 1e300;
+}
+
+}
+
+OrderBook::OrderBook(double tick_size) : tick_size_(tick_size > 0.0 ? tick_size : 0.0) {
+    ladder_[BOOK_BID].resize(LADDER);
+    ladder_[BOOK_ASK].resize(LADDER);
+}
+
+void OrderBook::reset() {
+    has_anchor_ = false;
+    prev_count_[BOOK_BID] = prev_count_[BOOK_ASK] = 0;
+    last_volume_ = -1;
+    volume_delta_ = 0;
+    std::fill(ladder_[BOOK_BID].begin(), ladder_[BOOK_BID].end(), Level());
+    std::fill(ladder_[BOOK_ASK].begin(), ladder_[BOOK_ASK].end(), Level());
+}
+
+int32_t OrderBook::to_ticks(double price) const {
+    return static_cast<int32_t>(std::llround(price / tick_size_));
+}
+
+bool OrderBook::infer_tick_size(const TickRecord& tick) {
+    constexpr int CAP = 2 * MAX_DEPTH;
+    double prices[CAP];
+    int n = 0;
+    for (int i = 0; i < MAX_DEPTH; ++i) {
+        if (valid_level(tick.bid_price[i], tick.bid_volume[i])) prices[n++] = tick.bid_price[i];
+        if (valid_level(tick.ask_price[i], tick.ask_volume[i])) prices[n++] = tick.ask_price[i];
+    }
+    if (n < 2) return false;
+    // 至多 CAP 个价格，插入排序；循环显式以数组长度为界 (std::sort 的 16 元素分支在 -O2 下触发 -Warray-bounds)
+    for (int i = 1; i < n && i < CAP; ++i) {
+        double v = prices[i];
+        int j = i;
+        for (; j > 0 && prices[j - 1] > v; --j) prices[j] = prices[j - 1];
+        prices[j] = v;
+    }
+
+    double best = 0.0;
+    for (int i = 1; i < n; ++i) {
+        double d = prices[i] - prices[i - 1];
+        if (d > 1e-9 && (best == 0.0 || d < best)) best = d;
+    }
+    if (best <= 0.0) return false;
+
+    // 消除浮点噪声：保留 6 位有效小数
+    tick_size_ = std::round(best * 1e6) / 1e6;
+    return tick_size_ > 0.0;
+}
+
+void OrderBook::recenter(int32_t mid_ticks) {
+    std::fill(ladder_[BOOK_BID].begin(), ladder_[BOOK_BID].end(), Level());
+    std::fill(ladder_[BOOK_ASK].begin(), ladder_[BOOK_ASK].end(), Level());
+    base_ = mid_ticks - LADDER / 2;
+    prev_count_[BOOK_BID] = prev_count_[BOOK_ASK] = 0;
+    has_anchor_ = true;
+}
+
+bool OrderBook::best_bid(int32_t& ticks) const {
+    if (prev_count_[BOOK_BID] == 0) return false;
+    ticks = prev_ticks_[BOOK_BID][0];
+    return true;
+}
+
+bool OrderBook::best_ask(int32_t& ticks) const {
+    if (prev_count_[BOOK_ASK] == 0) return false;
+    ticks = prev_ticks_[BOOK_ASK][0];
+    return true;
+}
+
+const OrderBook::Level* OrderBook::level_at(BookSide side, int32_t ticks) const {
+    if (!has_anchor_ || !in_range(ticks)) return nullptr;
+    return &ladder_[side][ticks - base_];
+}
+
+const OrderBook::Level* OrderBook::level(BookSide side, double price) const {
+    if (tick_size_ <= 0.0) return nullptr;
+    return level_at(side, to_ticks(price));
+}
+
+int OrderBook::depth(BookSide side, double* prices, int* volumes, int max_levels) const {
+    int n = std::min(max_levels, prev_count_[side]);
+    for (int i = 0; i < n; ++i) {
+        int32_t t = prev_ticks_[side][i];
+        prices[i] = to_price(t);
+        volumes[i] = ladder_[side][t - base_].volume;
+    }
+    return n;
+}
+
+int OrderBook::apply(const TickRecord& tick, BookLevelEvent* out, int max_events) {
+    if (tick_size_ <= 0.0 && !infer_tick_size(tick)) return 0;
+
+    // 1. 提取有效档位并转换为 tick 编号 (按从优到劣，遇到无效或乱序即截断)
+    int32_t ticks[2][MAX_DEPTH];
+    int vols[2][MAX_DEPTH];
+    int count[2] = {0, 0};
+    bool off_grid = false;
+
+    for (int s = 0; s < 2; ++s) {
+        const double* px = (s == BOOK_BID) ? tick.bid_price : tick.ask_price;
+        const int* vx = (s == BOOK_BID) ? tick.bid_volume : tick.ask_volume;
+        for (int i = 0; i < MAX_DEPTH; ++i) {
+            if (!valid_level(px[i], vx[i])) break;
+            int32_t t = to_ticks(px[i]);
+            if (std::fabs(px[i] - t * tick_size_) > tick_size_ * 1e-4) off_grid = true;
+            if (count[s] > 0) {
+                int32_t last = ticks[s][count[s] - 1];
+                if ((s == BOOK_BID && t >= last) || (s == BOOK_ASK && t <= last)) break;
+            }
+            ticks[s][count[s]] = t;
+            vols[s][count[s]] = vx[i];
+            ++count[s];
+        }
+    }
+
+    // 推断的 tick 过大 (价格不在网格上)：重新推断并重建
+    if (off_grid) {
+        double old = tick_size_;
+        tick_size_ = 0.0;
+        if (infer_tick_size(tick) && tick_size_ < old) {
+            has_anchor_ = false;
+            return apply(tick, out, max_events);
+        }
+        tick_size_ = old;
+    }
+
+    if (count[BOOK_BID] == 0 && count[BOOK_ASK] == 0) return 0;
+
+    // 2. 定锚：首次或价位超出阶梯范围时以中间价重新定锚，本次不派生事件
+    bool fresh = !has_anchor_;
+    for (int s = 0; s < 2 && !fresh; ++s) {
+        for (int i = 0; i < count[s]; ++i) {
+            if (!in_range(ticks[s][i])) { fresh = true; break; }
+        }
+    }
+
+    int volume_delta = (last_volume_ >= 0 && tick.volume > last_volume_) ? tick.volume - last_volume_ : 0;
+    last_volume_ = tick.volume;
+    volume_delta_ = volume_delta;
+
+    if (fresh) {
+        int32_t mid = count[BOOK_BID] > 0 ? ticks[BOOK_BID][0] : ticks[BOOK_ASK][0];
+        if (count[BOOK_BID] > 0 && count[BOOK_ASK] > 0) {
+            mid = ticks[BOOK_BID][0] + (ticks[BOOK_ASK][0] - ticks[BOOK_BID][0]) / 2;
+        }
+        recenter(mid);
+        for (int s = 0; s < 2; ++s) {
+            for (int i = 0; i < count[s]; ++i) {
+                Level& lv = at(static_cast<BookSide>(s), ticks[s][i]);
+                lv.volume = vols[s][i];
+                lv.queue_ahead = vols[s][i];
+                lv.visible = true;
+                prev_ticks_[s][i] = ticks[s][i];
+            }
+            prev_count_[s] = count[s];
+        }
+        return 0;
+    }
+
+    // 3. 逐侧推导档位事件
+    int32_t trade_ticks = (tick.last_price > 0.0 && tick.last_price < 1e300) ? to_ticks(tick.last_price) : 0;
+    int n = 0;
+    for (int s = 0; s < 2; ++s) {
+        n += diff_side(static_cast<BookSide>(s), ticks[s], vols[s], count[s],
+                       trade_ticks > 0 ? volume_delta : 0, trade_ticks,
+                       out + n, max_events - n);
+        for (int i = 0; i < count[s]; ++i) prev_ticks_[s][i] = ticks[s][i];
+        prev_count_[s] = count[s];
+    }
+    return n;
+}
+
+int OrderBook::diff_side(BookSide side, const int32_t* ticks, const int* vols, int n,
+                         int volume_delta, int32_t trade_ticks,
+                         BookLevelEvent* out, int max_events) {
+    const bool bid = (side == BOOK_BID);
+    // better(a, b): a 价位优于 b
+    auto better = [bid](int32_t a, int32_t b) { return bid ? a > b : a < b; };
+    // 成交价穿过该价位 (买档: 成交价 <= 价位；卖档: 成交价 >= 价位)
+    auto tradeable = [bid, trade_ticks](int32_t t) { return bid ? trade_ticks <= t : trade_ticks >= t; };
+
+    int emitted = 0;
+    int budget = volume_delta;
+    auto emit = [&](uint8_t type, int32_t t, int prev_vol, int vol, int traded, int queue) {
+        if (emitted >= max_events) return;
+        BookLevelEvent& e = out[emitted++];
+        e.side = side;
+        e.type = type;
+        e.ticks = t;
+        e.price = to_price(t);
+        e.prev_volume = prev_vol;
+        e.volume = vol;
+        e.traded = traded;
+        e.queue_ahead = queue;
+    };
+
+    const int32_t* prev = prev_ticks_[side];
+    const int prev_n = prev_count_[side];
+    // 快照档位数不足 5 时，可见区间即为整侧盘口
+    const bool new_full = (n == MAX_DEPTH);
+    const bool prev_full = (prev_n == MAX_DEPTH);
+
+    // 3.1 上次可见、本次消失的价位：击穿 / 撤单 / 滑出可见区间
+    for (int i = 0; i < prev_n; ++i) {
+        int32_t p = prev[i];
+        bool still = false;
+        for (int j = 0; j < n; ++j) {
+            if (ticks[j] == p) { still = true; break; }
+        }
+        if (still) continue;
+
+        Level& lv = at(side, p);
+        if (new_full && better(ticks[n - 1], p)) {
+            // 落到第 5 档之外：不可见但保留最后已知量
+            lv.visible = false;
+            continue;
+        }
+
+        int old = lv.volume;
+        int traded = 0;
+        if (budget > 0 && tradeable(p)) {
+            traded = std::min(old, budget);
+            budget -= traded;
+        }
+        emit(traded > 0 ? BOOK_TRADE_THROUGH : BOOK_CANCEL, p, old, 0, traded, 0);
+        lv = Level();
+    }
+
+    // 3.2 本次可见的价位：新增 / 撤单 / 成交
+    for (int j = 0; j < n; ++j) {
+        int32_t t = ticks[j];
+        int v = vols[j];
+        Level& lv = at(side, t);
+
+        if (!lv.visible) {
+            // 从第 5 档之外回到可见区间：量的变化不可观测，不派生事件
+            bool reentered = prev_full && prev_n > 0 && better(prev[prev_n - 1], t);
+            if (!reentered) emit(BOOK_ADD, t, 0, v, 0, v);
+            lv.volume = v;
+            lv.queue_ahead = v;
+            lv.visible = true;
+            continue;
+        }
+
+        int old = lv.volume;
+        if (v == old) continue;
+
+        if (v > old) {
+            // 新增挂单排在队尾，不影响排队估计
+            lv.volume = v;
+            emit(BOOK_ADD, t, old, v, 0, lv.queue_ahead);
+            continue;
+        }
+
+        int dec = old - v;
+        int traded = 0;
+        if (budget > 0 && tradeable(t)) {
+            traded = std::min(dec, budget);
+            budget -= traded;
+        }
+        int q = lv.queue_ahead - traded;
+        int remain = old - traded;
+        if (dec > traded && remain > 0 && q > 0) {
+            // 撤单按比例分摊到队列前后
+            q = static_cast<int>(static_cast<int64_t>(q) * v / remain);
+        }
+        lv.queue_ahead = std::max(0, std::min(q, v));
+        lv.volume = v;
+        emit(traded > 0 ? BOOK_TRADE : BOOK_CANCEL, t, old, v, traded, lv.queue_ahead);
+    }
+    return emitted;
+}
@@ -0,0 +1,96 @@
+#include "../include/snapshot_checkpoint.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+long SnapshotCheckpoint::save(const MarketSnapshot& snap, const std::string& path) {
+    std::vector<TickRecord> ticks(MARKET_SNAPSHOT_MAX_SYMBOLS);
+    size_t count = snap.copy_all(ticks.data(), ticks.size());
+
+    uint32_t max_day = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ticks[i].trading_day > max_day) max_day = ticks[i].trading_day;
+    }
+
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        std::cerr << "[Checkpoint] 无法创建文件: " << tmp_path << std::endl;
+        return -1;
+    }
+
+    size_t size = sizeof(CheckpointHeader) + count * sizeof(TickRecord);
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) return -1;
+
+    auto* header = static_cast<CheckpointHeader*>(ptr);
+    std::memset(header, 0, sizeof(CheckpointHeader));
+    header->version = VERSION;
+    header->trading_day = max_day;
+    header->count = count;
+    header->saved_at = static_cast<int64_t>(std::time(nullptr));
+    std::memcpy(header + 1, ticks.data(), count * sizeof(TickRecord));
+
+    // magic 最后写入，作为完整性标记
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC;
+
+    msync(ptr, size, MS_SYNC);
+    munmap(ptr, size);
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        perror("[Checkpoint] rename failed");
+        return -1;
+    }
+    return static_cast<long>(count);
+}
+
+size_t SnapshotCheckpoint::load(MarketSnapshot& snap, const std::string& path,
+                                uint32_t trading_day, int64_t max_age_sec) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CheckpointHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) return 0;
+
+    const auto* header = static_cast<const CheckpointHeader*>(ptr);
+    size_t loaded = 0;
+
+    if (header->magic != MAGIC || header->version != VERSION ||
+        sizeof(CheckpointHeader) + header->count * sizeof(TickRecord) > size) {
+        std::cerr << "[Checkpoint] 文件无效或已损坏: " << path << std::endl;
+    } else if (max_age_sec > 0 && std::time(nullptr) - header->saved_at > max_age_sec) {
+        std::cout << "[Checkpoint] 检查点已过期 (saved_at=" << header->saved_at << ")，跳过预热" << std::endl;
+    } else {
+        uint32_t day = trading_day ? trading_day : header->trading_day;
+        const auto* ticks = reinterpret_cast<const TickRecord*>(header + 1);
+        for (uint64_t i = 0; i < header->count; ++i) {
+            if (ticks[i].trading_day != day) continue;
+            snap.update(ticks[i]);
+            ++loaded;
+        }
+    }
+
+    munmap(ptr, size);
+    return loaded;
+}
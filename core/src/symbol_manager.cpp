@@ -50,6 +50,10 @@ void SymbolManager::load(const std::string& path) {
                     multiplier = std::stod(mul_str);
             }
 
+            if (id_to_symbol_.find(id) == id_to_symbol_.end()) {
+                id_to_index_[id] = static_cast<int32_t>(index_to_id_.size());
+                index_to_id_.push_back(id);
+            }
             id_to_symbol_[id] = symbol;
             symbol_to_id_[symbol] = id;
             id_to_multiplier_[id] = multiplier;
@@ -57,6 +61,20 @@ void SymbolManager::load(const std::string& path) {
             continue;
         }
     }
+
+    // 构建平铺下标表 (symbols.txt 的 id 连续分布，通常只有数千项)
+    if (!index_to_id_.empty()) {
+        auto mm = std::minmax_element(index_to_id_.begin(), index_to_id_.end());
+        uint64_t span = *mm.second - *mm.first + 1;
+        if (span <= (1u << 20)) {
+            min_id_ = *mm.first;
+            index_table_.assign(span, -1);
+            for (size_t i = 0; i < index_to_id_.size(); ++i) {
+                index_table_[index_to_id_[i] - min_id_] = static_cast<int32_t>(i);
+            }
+        }
+    }
+
     loaded_.store(true);
     std::cout << "[SymbolManager] Loaded " << symbol_to_id_.size() << " symbols." << std::endl;
 }
@@ -84,6 +102,15 @@ double SymbolManager::get_multiplier(uint64_t id) const {
     return 1.0;
 }
 
+int SymbolManager::get_index(uint64_t id) const {
+    if (!index_table_.empty()) {
+        uint64_t off = id - min_id_;
+        return off < index_table_.size() ? index_table_[off] : -1;
+    }
+    auto it = id_to_index_.find(id);
+    return it != id_to_index_.end() ? it->second : -1;
+}
+
 double SymbolManager::get_multiplier(const char* symbol) const {
     uint64_t id = get_id(symbol);
     return id ? get_multiplier(id) : 1.0;
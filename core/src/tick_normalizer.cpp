@@ -0,0 +1,144 @@
+#include "../include/tick_normalizer.h"
+#include "../include/symbol_manager.h"
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+constexpr uint64_t MS_PER_HOUR = 3600000ULL;
+
+// 合法价格：有限、非负且不是 CTP 的 DBL_MAX 占位
+inline bool clean(double& v) {
+    if (std::isfinite(v) && v >= 0.0 && v < 1e300) return false;
+    v = 0.0;
+    return true;
+}
+
+}
+
+TickNormalizer::TickNormalizer() {
+    states_.resize(SymbolManager::instance().count());
+}
+
+void TickNormalizer::reset() {
+    std::fill(states_.begin(), states_.end(), SymbolState());
+    extra_states_.clear();
+}
+
+uint64_t TickNormalizer::session_ms(uint64_t update_time) {
+    uint64_t hh = update_time / 10000000;
+    uint64_t mm = (update_time / 100000) % 100;
+    uint64_t ss = (update_time / 1000) % 100;
+    uint64_t ms = ((hh * 60 + mm) * 60 + ss) * 1000 + update_time % 1000;
+    // 夜盘 (>=18:00) 排在同一交易日日盘之前
+    return hh >= 18 ? ms - 18 * MS_PER_HOUR : ms + 6 * MS_PER_HOUR;
+}
+
+bool TickNormalizer::sanitize(TickRecord& tick) {
+    bool changed = false;
+    changed |= clean(tick.last_price);
+    changed |= clean(tick.turnover);
+    changed |= clean(tick.open_interest);
+    changed |= clean(tick.upper_limit);
+    changed |= clean(tick.lower_limit);
+    changed |= clean(tick.open_price);
+    changed |= clean(tick.highest_price);
+    changed |= clean(tick.lowest_price);
+    changed |= clean(tick.pre_close_price);
+
+    for (int i = 0; i < 5; ++i) {
+        // 空档位：价格与量一起置 0，下游只需判断 volume > 0
+        if (clean(tick.bid_price[i]) || tick.bid_volume[i] < 0) {
+            tick.bid_price[i] = 0.0;
+            tick.bid_volume[i] = 0;
+            changed = true;
+        }
+        if (clean(tick.ask_price[i]) || tick.ask_volume[i] < 0) {
+            tick.ask_price[i] = 0.0;
+            tick.ask_volume[i] = 0;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+TickNormalizer::SymbolState& TickNormalizer::state_for(const TickRecord& tick) {
+    int idx = SymbolManager::instance().get_index(tick.symbol_id);
+    if (idx >= 0 && static_cast<size_t>(idx) < states_.size()) return states_[idx];
+    return extra_states_[tick.symbol];
+}
+
+TickNormalizer::Result TickNormalizer::process(TickRecord& tick) {
+    bump(stats_.total);
+
+    uint64_t hh = tick.update_time / 10000000;
+    uint64_t mm = (tick.update_time / 100000) % 100;
+    uint64_t ss = (tick.update_time / 1000) % 100;
+    if (tick.symbol[0] == '\0' || hh >= 24 || mm >= 60 || ss >= 61 || tick.volume < 0) {
+        bump(stats_.invalid);
+        return DROP_INVALID;
+    }
+
+    bool sanitized = sanitize(tick);
+    // 当日尚未成交的合约只有盘口：照常放行并以 TICK_NO_LAST 标记，最新价与一档盘口皆空时才丢弃
+    const bool no_last = !(tick.last_price > 0.0);
+    if (no_last && tick.bid_volume[0] <= 0 && tick.ask_volume[0] <= 0) {
+        bump(stats_.invalid);
+        return DROP_INVALID;
+    }
+
+    SymbolState& st = state_for(tick);
+    uint64_t sms = session_ms(tick.update_time);
+    bool first = (st.trading_day != tick.trading_day);
+
+    if (!first) {
+        if (tick.update_time == st.update_time && tick.volume == st.volume) {
+            bump(stats_.duplicate);
+            return DROP_DUPLICATE;
+        }
+        if (sms < st.session_ms || tick.volume < st.volume) {
+            bump(stats_.out_of_order);
+            return DROP_OUT_OF_ORDER;
+        }
+    } else if (st.trading_day != 0 && tick.trading_day < st.trading_day) {
+        bump(stats_.out_of_order);
+        return DROP_OUT_OF_ORDER;
+    }
+
+    uint32_t flags = TICK_NORMALIZED;
+    if (sanitized) {
+        flags |= TICK_SANITIZED;
+        bump(stats_.sanitized);
+    }
+    if (no_last) flags |= TICK_NO_LAST;
+    if (first) {
+        flags |= TICK_FIRST;
+        tick.volume_delta = 0;
+        tick.turnover_delta = 0.0;
+    } else {
+        tick.volume_delta = tick.volume - st.volume;
+        double td = tick.turnover - st.turnover;
+        tick.turnover_delta = td > 0.0 ? td : 0.0;
+    }
+    tick.quality_flags = flags;
+
+    st.trading_day = tick.trading_day;
+    st.session_ms = sms;
+    st.update_time = tick.update_time;
+    st.volume = tick.volume;
+    st.turnover = tick.turnover;
+
+    bump(stats_.passed);
+    return PASS;
+}
+
+std::string TickNormalizer::stats_string() const {
+    std::ostringstream oss;
+    oss << "total=" << stats_.total.load(std::memory_order_relaxed)
+        << " passed=" << stats_.passed.load(std::memory_order_relaxed)
+        << " dup=" << stats_.duplicate.load(std::memory_order_relaxed)
+        << " out_of_order=" << stats_.out_of_order.load(std::memory_order_relaxed)
+        << " invalid=" << stats_.invalid.load(std::memory_order_relaxed)
+        << " sanitized=" << stats_.sanitized.load(std::memory_order_relaxed);
+    return oss.str();
+}
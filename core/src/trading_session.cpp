@@ -0,0 +1,210 @@
+#include "../include/trading_session.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr uint32_t MS_PER_HOUR = 3600000;
+
+// 严格的 "HH:MM" 或 "HH:MM:SS" (各两位数字，时 00-23，分秒 00-59) -> 本地当日毫秒
+bool parse_clock(const std::string& s, uint32_t& tod_ms) {
+    if (s.size() != 5 && s.size() != 8) return false;
+    int field[3] = {0, 0, 0};
+    for (size_t i = 0; i < s.size(); i += 3) {
+        if (!std::isdigit(static_cast<unsigned char>(s[i])) || !std::isdigit(static_cast<unsigned char>(s[i + 1]))) {
+            return false;
+        }
+        if (i + 2 < s.size() && s[i + 2] != ':') return false;
+        field[i / 3] = (s[i] - '0') * 10 + (s[i + 1] - '0');
+    }
+    if (field[0] > 23 || field[1] > 59 || field[2] > 59) return false;
+    tod_ms = static_cast<uint32_t>(((field[0] * 60 + field[1]) * 60 + field[2]) * 1000);
+    return true;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+// 国内期货常见时段 (如有调整，用 sessions_file 覆盖)
+const char* const DAY_COMMODITY = "09:00-10:15,10:30-11:30,13:30-15:00";
+const char* const NIGHT_2300 = "21:00-23:00,09:00-10:15,10:30-11:30,13:30-15:00";
+const char* const NIGHT_0100 = "21:00-01:00,09:00-10:15,10:30-11:30,13:30-15:00";
+const char* const NIGHT_0230 = "21:00-02:30,09:00-10:15,10:30-11:30,13:30-15:00";
+const char* const CFFEX_INDEX = "09:30-11:30,13:00-15:00";
+const char* const CFFEX_BOND = "09:30-11:30,13:00-15:15";
+
+struct BuiltinGroup {
+    const char* sessions;
+    const char* products;
+};
+
+const BuiltinGroup BUILTIN[] = {
+    // 上期所 / 上期能源
+    {NIGHT_0230, "au ag sc"},
+    {NIGHT_0100, "cu al zn pb ni sn ss ao bc ad"},
+    {NIGHT_2300, "rb hc bu ru fu sp br op nr lu"},
+    // 大商所
+    {NIGHT_2300, "a b m y p c cs i j jm l v pp eg rr eb pg bz"},
+    // 郑商所
+    {NIGHT_2300, "CF CY SR TA MA OI RM FG ZC SA PF PX SH PR PL"},
+    // 中金所
+    {CFFEX_INDEX, "IF IH IC IM"},
+    {CFFEX_BOND, "T TF TS TL"},
+};
+
+}
+
+SessionCalendar::SessionCalendar(std::vector<SessionSegment> segments) : segments_(std::move(segments)) {
+    for (const auto& s : segments_) trading_ms_ += s.end - s.begin;
+}
+
+bool SessionCalendar::parse(const std::string& spec, SessionCalendar& out, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    std::vector<SessionSegment> segs;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) return fail("空时段");
+        size_t dash = item.find('-');
+        uint32_t b = 0, e = 0;
+        if (dash == std::string::npos || !parse_clock(trim(item.substr(0, dash)), b) ||
+            !parse_clock(trim(item.substr(dash + 1)), e)) {
+            return fail("'" + item + "' 不是 HH:MM[:SS]-HH:MM[:SS]");
+        }
+        SessionSegment seg{TradingSessions::session_ms_of_day(b), TradingSessions::session_ms_of_day(e)};
+        // 结束于 18:00 的时段按当日末尾处理
+        if (seg.end == 0) seg.end = 24 * MS_PER_HOUR;
+        if (seg.end <= seg.begin) return fail("'" + item + "' 结束不晚于开始 (交易日自 18:00 起算)");
+        if (!segs.empty() && seg.begin < segs.back().end) return fail("'" + item + "' 与前一时段重叠或顺序颠倒");
+        segs.push_back(seg);
+    }
+    if (segs.empty()) return fail("时段列表为空");
+    out = SessionCalendar(std::move(segs));
+    return true;
+}
+
+uint32_t SessionCalendar::tick_offset(uint32_t session_ms) const {
+    uint32_t cum = 0;
+    for (const auto& s : segments_) {
+        if (session_ms < s.begin) return cum;
+        if (session_ms < s.end) return cum + (session_ms - s.begin);
+        cum += s.end - s.begin;
+        if (session_ms < s.end + CLOSE_GRACE_MS) return cum - 1;
+    }
+    return trading_ms_ > 0 ? trading_ms_ - 1 : 0;
+}
+
+uint32_t SessionCalendar::clock_offset(uint32_t session_ms) const {
+    uint32_t cum = 0;
+    for (const auto& s : segments_) {
+        if (session_ms < s.begin) return cum;
+        if (session_ms < s.end) return cum + (session_ms - s.begin);
+        cum += s.end - s.begin;
+    }
+    return cum;
+}
+
+uint32_t SessionCalendar::offset_to_session_ms(uint32_t offset) const {
+    for (const auto& s : segments_) {
+        uint32_t len = s.end - s.begin;
+        if (offset < len) return s.begin + offset;
+        offset -= len;
+    }
+    return segments_.empty() ? 0 : segments_.back().end;
+}
+
+std::string SessionCalendar::to_string() const {
+    std::ostringstream oss;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        uint64_t b = TradingSessions::to_hhmmssmmm(segments_[i].begin) / 100000;
+        uint64_t e = TradingSessions::to_hhmmssmmm(segments_[i].end % (24 * MS_PER_HOUR)) / 100000;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s%02u:%02u-%02u:%02u", i ? "," : "", static_cast<unsigned>(b / 100),
+                 static_cast<unsigned>(b % 100), static_cast<unsigned>(e / 100), static_cast<unsigned>(e % 100));
+        oss << buf;
+    }
+    return oss.str();
+}
+
+TradingSessions::TradingSessions() {
+    SessionCalendar::parse(DAY_COMMODITY, default_);
+    for (const auto& g : BUILTIN) {
+        SessionCalendar cal;
+        SessionCalendar::parse(g.sessions, cal);
+        std::istringstream iss(g.products);
+        std::string product;
+        while (iss >> product) calendars_[product] = cal;
+    }
+}
+
+bool TradingSessions::load(const std::string& path) {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "[TradingSessions] Cannot open " << path << std::endl;
+        return false;
+    }
+    // 全部行校验通过后才生效，任一行有误时保留原有日历
+    std::vector<std::pair<std::string, SessionCalendar>> parsed;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(ifs, line)) {
+        ++line_no;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        size_t colon = line.find(':');
+        std::string product = colon == std::string::npos ? "" : trim(line.substr(0, colon));
+        SessionCalendar cal;
+        std::string error = "缺少 '品种:'";
+        if (product.empty() || !SessionCalendar::parse(line.substr(colon + 1), cal, &error)) {
+            std::cerr << "[TradingSessions] " << path << ":" << line_no << " invalid '" << line << "': " << error
+                      << std::endl;
+            return false;
+        }
+        parsed.emplace_back(std::move(product), std::move(cal));
+    }
+    for (auto& [product, cal] : parsed) {
+        if (product == "*") {
+            default_ = cal;
+        } else {
+            calendars_[product] = cal;
+        }
+    }
+    std::cout << "[TradingSessions] Loaded " << parsed.size() << " calendars from " << path << std::endl;
+    return true;
+}
+
+void TradingSessions::set(const std::string& product, const SessionCalendar& calendar) {
+    calendars_[product] = calendar;
+}
+
+const SessionCalendar& TradingSessions::for_symbol(const char* symbol) const {
+    auto it = calendars_.find(product_of(symbol));
+    return it != calendars_.end() ? it->second : default_;
+}
+
+std::string TradingSessions::product_of(const char* symbol) {
+    size_t n = 0;
+    while (symbol[n] && std::isalpha(static_cast<unsigned char>(symbol[n]))) ++n;
+    return std::string(symbol, n);
+}
+
+uint32_t TradingSessions::session_ms_of_day(uint32_t time_of_day_ms) {
+    return time_of_day_ms >= 18 * MS_PER_HOUR ? time_of_day_ms - 18 * MS_PER_HOUR : time_of_day_ms + 6 * MS_PER_HOUR;
+}
+
+uint64_t TradingSessions::to_hhmmssmmm(uint32_t session_ms) {
+    uint32_t tod = (session_ms + 18 * MS_PER_HOUR) % (24 * MS_PER_HOUR);
+    uint64_t ms = tod % 1000;
+    uint64_t sec = tod / 1000;
+    return ((sec / 3600) * 10000 + (sec / 60 % 60) * 100 + sec % 60) * 1000 + ms;
+}
@@ -0,0 +1,166 @@
+#include "../core/include/book_features.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <cfloat>
+
+// 编译: g++ -std=c++17 -O3 -march=native demo/bench_book_features.cpp -o bench_book_features
+
+constexpr size_t TICK_COUNT = 1 << 12;   // 4K ticks (~1.3MB，L2 驻留，测算力而非内存带宽)
+constexpr int ROUNDS = 1000;
+
+// 现有因子节点的写法：各特征分别逐档标量遍历
+static void legacy_scalar(const TickRecord& t, BookFeatures& out) {
+    double bd = 0, ad = 0;
+    for (int i = 0; i < 5; ++i) { bd += t.bid_volume[i]; ad += t.ask_volume[i]; }
+
+    double bw = 0, aw = 0;
+    for (int i = 0; i < 5; ++i) { bw += t.bid_volume[i] / (i + 1.0); aw += t.ask_volume[i] / (i + 1.0); }
+    out.imbalance = (bw + aw) > 0 ? (bw - aw) / (bw + aw) : 0;
+
+    double bpv = 0, apv = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (t.bid_volume[i] > 0) bpv += t.bid_price[i] * t.bid_volume[i];
+        if (t.ask_volume[i] > 0) apv += t.ask_price[i] * t.ask_volume[i];
+    }
+    out.bid_vwap = bd > 0 ? bpv / bd : 0;
+    out.ask_vwap = ad > 0 ? apv / ad : 0;
+    out.mid = (t.bid_price[0] + t.ask_price[0]) * 0.5;
+    out.microprice = (t.bid_price[0] * t.ask_volume[0] + t.ask_price[0] * t.bid_volume[0]) / (t.bid_volume[0] + t.ask_volume[0]);
+    out.weighted_spread = out.ask_vwap - out.bid_vwap;
+    out.bid_slope = bd > 0 ? (t.bid_price[0] - out.bid_vwap) / bd : 0;
+    out.ask_slope = ad > 0 ? (out.ask_vwap - t.ask_price[0]) / ad : 0;
+    out.bid_depth = bd;
+    out.ask_depth = ad;
+}
+
+constexpr int REPEATS = 7;  // 取最快一次，降低调度噪声
+
+// fn 处理一整轮 (全部 ticks)
+template <typename F>
+void run(const std::string& name, F&& fn) {
+    double best = 1e30;
+    for (int k = 0; k < REPEATS; ++k) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) fn();
+        auto end_time = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end_time - start_time).count());
+    }
+    double ns = best * 1e9 / (ROUNDS * TICK_COUNT);
+    std::cout << "[" << std::setw(14) << name << "] " << std::fixed << std::setprecision(2)
+              << ns << " ns/tick  (" << (ROUNDS * TICK_COUNT) / best / 1e6 << " M ticks/s)" << std::endl;
+}
+
+static bool same(const BookFeatures& a, const BookFeatures& b) {
+    const double* x = reinterpret_cast<const double*>(&a);
+    const double* y = reinterpret_cast<const double*>(&b);
+    for (size_t i = 0; i < sizeof(BookFeatures) / sizeof(double); ++i) {
+        if (!std::isfinite(x[i]) || !std::isfinite(y[i])) return false;  // 分母为 0 的保护失效
+        if (std::fabs(x[i] - y[i]) > 1e-9 * (1 + std::fabs(x[i]))) return false;
+    }
+    return true;
+}
+
+// 边界盘口：空档位 (量 0、价 DBL_MAX)、单侧无挂单、双侧总量为 0
+static std::vector<TickRecord> edge_ticks(std::mt19937& rng) {
+    std::vector<TickRecord> out;
+    for (int k = 0; k < 64; ++k) {
+        TickRecord t;
+        std::memset(&t, 0, sizeof(t));
+        double bid = 3000 + (rng() % 200) * 0.2;
+        for (int i = 0; i < 5; ++i) {
+            t.bid_price[i] = bid - 0.2 * i;
+            t.ask_price[i] = bid + 0.2 * (i + 1);
+            t.bid_volume[i] = static_cast<int>(rng() % 300 + 1);
+            t.ask_volume[i] = static_cast<int>(rng() % 300 + 1);
+        }
+        int empty_from = k % 6;                       // 第 empty_from 档起为空
+        bool bid_empty = k % 4 == 1, ask_empty = k % 4 == 2, both_empty = k % 4 == 3;
+        for (int i = 0; i < 5; ++i) {
+            bool clear_bid = i >= empty_from || bid_empty || both_empty;
+            bool clear_ask = i >= empty_from || ask_empty || both_empty;
+            if (clear_bid) { t.bid_volume[i] = 0; t.bid_price[i] = DBL_MAX; }
+            if (clear_ask) { t.ask_volume[i] = 0; t.ask_price[i] = DBL_MAX; }
+        }
+        out.push_back(t);
+    }
+    return out;
+}
+
+// 各实现与 compute_scalar 逐条比对：单 Tick AVX2、连续数组批量、指针数组批量 (乱序、不连续)
+static bool check_all(const BookFeatureCalc& calc, const std::vector<TickRecord>& ticks, const char* what) {
+    const size_t n = ticks.size();
+    std::vector<BookFeatures> ref(n), out(n);
+    for (size_t i = 0; i < n; ++i) calc.compute_scalar(ticks[i], ref[i]);
+
+    auto verify = [&](const char* path, const std::vector<BookFeatures>& got, const std::vector<size_t>& order) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!same(ref[order[i]], got[i])) {
+                std::cerr << "MISMATCH " << what << " levels=" << calc.levels() << " " << path
+                          << " at " << order[i] << std::endl;
+                return false;
+            }
+        }
+        return true;
+    };
+    std::vector<size_t> identity(n);
+    for (size_t i = 0; i < n; ++i) identity[i] = i;
+
+#if defined(__AVX2__)
+    for (size_t i = 0; i < n; ++i) calc.compute_avx2(ticks[i], out[i]);
+    if (!verify("compute_avx2", out, identity)) return false;
+#endif
+    calc.compute_batch(ticks.data(), n, out.data());
+    if (!verify("compute_batch", out, identity)) return false;
+
+    std::vector<size_t> order(identity.rbegin(), identity.rend());
+    for (size_t i = 0; i + 1 < n; i += 3) std::swap(order[i], order[i + 1]);
+    std::vector<const TickRecord*> ptrs(n);
+    for (size_t i = 0; i < n; ++i) ptrs[i] = &ticks[order[i]];
+    calc.compute_batch(ptrs.data(), n, out.data());
+    return verify("compute_batch(ptrs)", out, order);
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> vol(1, 500);
+    std::vector<TickRecord> ticks(TICK_COUNT);
+    for (auto& t : ticks) {
+        std::memset(&t, 0, sizeof(t));
+        double bid = 3000 + (rng() % 200) * 0.2;
+        for (int i = 0; i < 5; ++i) {
+            t.bid_price[i] = bid - 0.2 * i;
+            t.ask_price[i] = bid + 0.2 * (i + 1);
+            t.bid_volume[i] = vol(rng);
+            t.ask_volume[i] = vol(rng);
+        }
+    }
+
+    BookFeatureCalc calc;
+    std::vector<BookFeatures> out(TICK_COUNT);
+
+    // 正确性校验：随机盘口 + 边界盘口，各档数配置
+    std::vector<TickRecord> edges = edge_ticks(rng);
+    for (int levels = 1; levels <= BookFeatureCalc::MAX_LEVELS; ++levels) {
+        BookFeatureCalc c(levels);
+        if (!check_all(c, ticks, "random") || !check_all(c, edges, "edge")) return 1;
+    }
+    std::cout << "Correctness: compute_avx2 / compute_batch / compute_batch(ptrs) match compute_scalar" << std::endl;
+
+    std::cout << "Benchmarking book features (" << TICK_COUNT << " ticks x " << ROUNDS << " rounds)..." << std::endl;
+    const TickRecord* tp = ticks.data();
+    BookFeatures* op = out.data();
+    run("legacy_scalar", [&] { for (size_t i = 0; i < TICK_COUNT; ++i) legacy_scalar(tp[i], op[i]); });
+    run("calc_scalar", [&] { for (size_t i = 0; i < TICK_COUNT; ++i) calc.compute_scalar(tp[i], op[i]); });
+#if defined(__AVX2__)
+    run("calc_avx2", [&] { for (size_t i = 0; i < TICK_COUNT; ++i) calc.compute_avx2(tp[i], op[i]); });
+#endif
+    run("calc_batch", [&] { calc.compute_batch(tp, TICK_COUNT, op); });
+    std::cout << "checksum=" << out[TICK_COUNT / 2].imbalance << std::endl;
+    return 0;
+}
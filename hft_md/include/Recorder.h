@@ -3,6 +3,11 @@
 #include "protocol.h"
 #include "ring_buffer.h"
 #include "market_snapshot.h"
+#include "instrument_cache.h"
+#include "feed_arbiter.h"
+#include "tick_partition.h"
+#include "mmap_util.h"
+#include "clock.h"
 #include "ThostFtdcMdApi.h"
 
 #include <atomic>
@@ -11,16 +16,19 @@
 #include <thread>
 #include <vector>
 
-class TickRecorder : public CThostFtdcMdSpi {
+class TickRecorder;
+
+// 单个 CTP 行情会话：独立的 API 实例、回调线程与合约缓存
+class MdSession : public CThostFtdcMdSpi {
 public:
-    explicit TickRecorder(const std::string& config_path);
-    ~TickRecorder();
+    MdSession(TickRecorder* owner, int feed_id, const std::string& front);
+    ~MdSession();
 
     void start();
     void stop();
-    bool is_in_time_range() const;
 
     void OnFrontConnected() override;
+    void OnFrontDisconnected(int nReason) override;
     void OnRspUserLogin(
         CThostFtdcRspUserLoginField* pRspUserLogin,
         CThostFtdcRspInfoField* pRspInfo,
@@ -29,14 +37,42 @@ public:
     void OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* pData) override;
 
 private:
+    TickRecorder* owner_;
+    int feed_id_;
+    std::string front_;
+    CThostFtdcMdApi* api_ = nullptr;
+    InstrumentCache instruments_;  // 订阅时预填充，本会话回调线程独占
+};
+
+class TickRecorder {
+public:
+    explicit TickRecorder(const std::string& config_path);
+    ~TickRecorder();
+
+    void start();
+    void stop();
+    bool is_in_time_range() const;
+
+private:
+    friend class MdSession;
     struct WriterContext;
 
+    // 会话回调入口：单会话直接发布，多会话经 FeedArbiter 择先发布
+    // recv_ns: 回调入口的 TSC 时刻，写入 TickRecord::recv_ns 供引擎计算端到端延迟
+    void on_tick(int feed_id, const CThostFtdcDepthMarketDataField& d, const InstrumentCache::Entry& inst,
+                 uint64_t recv_ns);
+    void emit_tick(const CThostFtdcDepthMarketDataField& d, const InstrumentCache::Entry& inst, uint64_t recv_ns);
+    void report_feeds() const;
+
     void load_config(const std::string& config_path);
     uint32_t parse_time(const std::string& time_str);
+    void open_writer();
     void writer_loop();
-    void save_to_file(const TickRecord& rec);
+    size_t drain_ring();
+    MmapWriter<TickRecord>* partition_writer(const TickRecord& rec);
+    void publish_all();
 
-    std::string md_front_;
+    std::vector<std::string> md_fronts_;  // 每个元素一个 CTP 会话 (可重复以对同一前置开多路)
     std::string broker_id_;
     std::string user_id_;
     std::string password_;
@@ -47,12 +83,27 @@ private:
     uint32_t end_time_ = 0;
     uint64_t initial_capacity_ = 50000000;
 
+    bool direct_mmap_ = false;          // write_mode: direct
+    uint64_t max_batch_ = 256;          // 累计多少条发布一次游标
+    uint64_t max_batch_delay_us_ = 200; // 未发布记录最长等待 (实时读者的延迟上限)
+    uint64_t idle_sleep_us_ = 50;       // 写线程空闲轮询间隔
+
     bool use_shm_ = false;
     std::string shm_path_ = "/hft_md_snapshot";
     std::unique_ptr<MarketSnapshot> shm_impl_;
 
-    CThostFtdcMdApi* md_api_ = nullptr;
-    RingBuffer<TickRecord, 65536> rb_;
+    TickPartitioner partitioner_;          // partition: none / product / hash:N
+    bool keep_merged_ = true;              // 分区时是否同时写合并文件
+    uint64_t partition_capacity_ = 0;      // 每个分区文件的预分配条数 (默认同 initial_capacity)
+
+    uint64_t stats_interval_s_ = 60;      // 多路行情统计打印周期
+
+    std::vector<std::unique_ptr<MdSession>> sessions_;
+    std::unique_ptr<FeedArbiter> arbiter_;   // 仅多会话时创建
+    std::unique_ptr<IClock> clock_;          // 接收时刻时间源 (TscClock，不支持时为 WallClock)
+    TscClock* tsc_clock_ = nullptr;          // 写线程每秒 resync
+    BatchRingBuffer<TickRecord, 65536> rb_;  // 发布方 reserve 后就地填充 (多会话时由仲裁锁保证单生产者)
+    std::atomic<uint64_t> dropped_{0};
     std::thread writer_thread_;
     std::atomic<bool> running_{false};
     uint32_t trading_day_int_ = 0;
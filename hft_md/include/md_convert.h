@@ -0,0 +1,70 @@
+#pragma once
+
+#include "protocol.h"
+#include "fixed_parse.h"
+#include "instrument_cache.h"
+#include "ThostFtdcUserApiStruct.h"
+
+// 行情时间 HHMMSSmmm；UpdateTime 为空或格式非法时为 0 (与逐字段 sscanf 失败时一致)
+inline uint64_t md_update_time(const CThostFtdcDepthMarketDataField& d) {
+    uint32_t hhmmss;
+    return parse_hhmmss(d.UpdateTime, hhmmss) ? static_cast<uint64_t>(hhmmss) * 1000 + d.UpdateMillisec : 0;
+}
+
+// 交易日 YYYYMMDD；TradingDay 为空或格式非法时取 default_trading_day
+inline uint32_t md_trading_day(const CThostFtdcDepthMarketDataField& d, uint32_t default_trading_day) {
+    uint32_t day;
+    return parse_yyyymmdd(d.TradingDay, day) ? day : default_trading_day;
+}
+
+/**
+ * CTP 深度行情 -> TickRecord 就地转换 (写入 BatchRingBuffer 预留的槽位)
+ *
+ * 不做整体 memset：所有业务字段逐一赋值，symbol 由 InstrumentCache 中已补零的 32 字节整体拷贝，
+ * 交易日与时间使用定长 SWAR 解析并校验格式。结构体内部对齐空洞保留槽位旧值，不参与任何读取。
+ */
+inline void fill_tick(const CThostFtdcDepthMarketDataField& d, const InstrumentCache::Entry& inst,
+                      uint32_t default_trading_day, TickRecord& rec) {
+    std::memcpy(rec.symbol, inst.symbol, sizeof(rec.symbol));
+    rec.symbol_id = inst.symbol_id;
+    rec.trading_day = md_trading_day(d, default_trading_day);
+    rec.update_time = md_update_time(d);
+
+    rec.last_price = d.LastPrice;
+    rec.volume = d.Volume;
+    rec.turnover = d.Turnover;
+    rec.open_interest = d.OpenInterest;
+
+    rec.upper_limit = d.UpperLimitPrice;
+    rec.lower_limit = d.LowerLimitPrice;
+    rec.open_price = d.OpenPrice;
+    rec.highest_price = d.HighestPrice;
+    rec.lowest_price = d.LowestPrice;
+    rec.pre_close_price = d.PreClosePrice;
+
+    rec.bid_price[0] = d.BidPrice1;
+    rec.bid_volume[0] = d.BidVolume1;
+    rec.bid_price[1] = d.BidPrice2;
+    rec.bid_volume[1] = d.BidVolume2;
+    rec.bid_price[2] = d.BidPrice3;
+    rec.bid_volume[2] = d.BidVolume3;
+    rec.bid_price[3] = d.BidPrice4;
+    rec.bid_volume[3] = d.BidVolume4;
+    rec.bid_price[4] = d.BidPrice5;
+    rec.bid_volume[4] = d.BidVolume5;
+
+    rec.ask_price[0] = d.AskPrice1;
+    rec.ask_volume[0] = d.AskVolume1;
+    rec.ask_price[1] = d.AskPrice2;
+    rec.ask_volume[1] = d.AskVolume2;
+    rec.ask_price[2] = d.AskPrice3;
+    rec.ask_volume[2] = d.AskVolume3;
+    rec.ask_price[3] = d.AskPrice4;
+    rec.ask_volume[3] = d.AskVolume4;
+    rec.ask_price[4] = d.AskPrice5;
+    rec.ask_volume[4] = d.AskVolume5;
+
+    rec.volume_delta = 0;
+    rec.quality_flags = 0;
+    rec.turnover_delta = 0.0;
+}
@@ -2,18 +2,34 @@
 
 #include "mmap_util.h"
 #include "symbol_manager.h"
+#include "tick_normalizer.h"
+#include "md_convert.h"
+#include "tick_partition.h"
 
 #include <yaml-cpp/yaml.h>
 
 #include <chrono>
 #include <cstring>
+#include <ctime>
 #include <filesystem>
+#include <algorithm>
 #include <iostream>
+#include <tuple>
+#include <unordered_map>
 
 namespace fs = std::filesystem;
 
 struct TickRecorder::WriterContext {
-    std::unique_ptr<MmapWriter<TickRecord>> writer;
+    std::unique_ptr<MmapWriter<TickRecord>> writer;  // 合并文件 (partition_keep_merged: false 时为空)
+
+    // 分区输出：写线程按合约路由，分区文件在首个 Tick 到达时创建
+    std::string base_path;
+    std::vector<std::unique_ptr<MmapWriter<TickRecord>>> parts;
+    std::vector<std::string> part_keys;
+    std::unordered_map<std::string, int> part_by_key;
+    std::vector<int> part_by_index;                 // SymbolManager 稠密下标 -> 分区，-1 表示未解析
+    std::unordered_map<std::string, int> part_by_symbol;  // 未登记合约
+    uint64_t part_pending = 0;                      // 已 commit 未发布的分区记录数
 };
 
 TickRecorder::TickRecorder(const std::string& config_path) {
@@ -22,6 +38,9 @@ TickRecorder::TickRecorder(const std::string& config_path) {
 
 TickRecorder::~TickRecorder() {
     stop();
+    if (clock_ && &IClock::instance() == clock_.get()) {
+        IClock::set_instance(nullptr);
+    }
 }
 
 void TickRecorder::start() {
@@ -42,19 +61,32 @@ void TickRecorder::start() {
         }
     }
 
-    writer_thread_ = std::thread(&TickRecorder::writer_loop, this);
+    // 接收时刻与引擎同样以 CLOCK_REALTIME 校准的 TSC 计，两进程的纳秒时刻可直接相减
+    if (TscClock::supported()) {
+        auto tsc = std::make_unique<TscClock>();
+        tsc_clock_ = tsc.get();
+        clock_ = std::move(tsc);
+    } else {
+        clock_ = std::make_unique<WallClock>();
+    }
+    IClock::set_instance(clock_.get());
 
-    md_api_ = CThostFtdcMdApi::CreateFtdcMdApi("./log/");
-    if (!md_api_) {
-        std::cerr << "FATAL: Failed to create CTP API!" << std::endl;
-        return;
+    if (md_fronts_.size() > 1) {
+        arbiter_ = std::make_unique<FeedArbiter>(md_fronts_.size());
+    }
+
+    if (direct_mmap_) {
+        open_writer();  // 直写模式下 MD 回调线程需要在首个 Tick 前拿到 writer
     }
+    writer_thread_ = std::thread(&TickRecorder::writer_loop, this);
 
-    md_api_->RegisterSpi(this);
-    md_api_->RegisterFront(const_cast<char*>(md_front_.c_str()));
-    md_api_->Init();
+    for (size_t i = 0; i < md_fronts_.size(); ++i) {
+        sessions_.push_back(std::make_unique<MdSession>(this, static_cast<int>(i), md_fronts_[i]));
+        sessions_.back()->start();
+    }
 
-    std::cout << "[Recorder] Running independently (Mmap Mode). Output: " << output_path_ << std::endl;
+    std::cout << "[Recorder] Running independently (Mmap Mode). Sessions: " << sessions_.size()
+              << (arbiter_ ? " (arbitrated)" : "") << " | Output: " << output_path_ << std::endl;
 }
 
 void TickRecorder::stop() {
@@ -63,15 +95,15 @@ void TickRecorder::stop() {
     }
     running_ = false;
 
-    if (md_api_) {
-        md_api_->RegisterSpi(nullptr);
-        md_api_->Release();
-        md_api_ = nullptr;
+    for (auto& session : sessions_) {
+        session->stop();
     }
 
     if (writer_thread_.joinable()) {
         writer_thread_.join();
     }
+    report_feeds();
+    sessions_.clear();
 }
 
 bool TickRecorder::is_in_time_range() const {
@@ -90,16 +122,132 @@ bool TickRecorder::is_in_time_range() const {
     return current_time >= start_time_ || current_time <= end_time_;
 }
 
-void TickRecorder::OnFrontConnected() {
-    std::cout << "[Recorder] Front connected. Logging in..." << std::endl;
+void TickRecorder::on_tick(int feed_id, const CThostFtdcDepthMarketDataField& d, const InstrumentCache::Entry& inst,
+                           uint64_t recv_ns) {
+    if (!arbiter_) {
+        emit_tick(d, inst, recv_ns);
+        return;
+    }
+
+    // 多会话：(trading_day, update_time, volume) 严格更新的版本才发布，保证落盘序列对每个合约单调；
+    // 交易日参与比较，进程从日盘收盘跨到夜盘时新交易日的 Tick 不会因时段毫秒序回绕被判为旧版本
+    uint64_t update_time = md_update_time(d);
+    uint32_t trading_day = md_trading_day(d, trading_day_int_);
+    int index = SymbolManager::instance().get_index(inst.symbol_id);
+    if (index < 0) index = arbiter_->overflow_index(inst.symbol);
+    FeedArbiter::Verdict v = arbiter_->arbitrate(feed_id, index, trading_day, FeedArbiter::make_key(update_time, d.Volume),
+                                                 recv_ns, [&] { emit_tick(d, inst, recv_ns); });
+
+    if (v == FeedArbiter::FIRST) {
+        int64_t local_ms = (static_cast<int64_t>(recv_ns / 1000000) + IClock::tz_offset_ms()) % 86400000;
+        int64_t exch_ms = static_cast<int64_t>(TickNormalizer::session_ms(update_time) + 18 * 3600000) % 86400000;
+        int64_t delay = local_ms - exch_ms;
+        if (delay < -43200000) delay += 86400000;  // 跨午夜
+        arbiter_->record_delay(feed_id, delay);
+    }
+}
+
+void TickRecorder::emit_tick(const CThostFtdcDepthMarketDataField& d, const InstrumentCache::Entry& inst,
+                             uint64_t recv_ns) {
+    if (direct_mmap_) {
+        // 直写模式：跳过环形缓冲区，直接在 mmap 槽位上构造；游标按 max_batch 发布，余量由写线程定时刷新
+        MmapWriter<TickRecord>& writer = *global_ctx_->writer;
+        TickRecord* slot = writer.reserve();
+        if (!slot) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        fill_tick(d, inst, trading_day_int_, *slot);
+        slot->recv_ns = recv_ns;
+        TickNormalizer::sanitize(*slot);
+        if (use_shm_) {
+            MarketSnapshot::instance().update(*slot);
+        }
+        writer.commit(1);
+        if (writer.unpublished() >= max_batch_) {
+            writer.publish();
+        }
+        return;
+    }
+
+    // 直接在环形缓冲区槽位上构造，省去临时对象与 push 拷贝
+    auto [slot, avail] = rb_.reserve();
+    if (avail == 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TickRecord& rec = *slot;
+    fill_tick(d, inst, trading_day_int_, rec);
+    rec.recv_ns = recv_ns;
+
+    // 空档位 DBL_MAX 等占位值在落盘前清洗；去重/乱序留给消费端的 TickNormalizer，保持原始序列可追溯
+    TickNormalizer::sanitize(rec);
+
+    if (use_shm_) {
+        MarketSnapshot::instance().update(rec);
+    }
+    rb_.commit(1);
+}
+
+void TickRecorder::report_feeds() const {
+    if (arbiter_) {
+        std::cout << "[Recorder] Feeds:\n" << arbiter_->stats_string() << std::endl;
+    }
+}
+
+// ============================================================================
+//  MdSession
+// ============================================================================
+
+MdSession::MdSession(TickRecorder* owner, int feed_id, const std::string& front)
+    : owner_(owner), feed_id_(feed_id), front_(front) {}
+
+MdSession::~MdSession() {
+    stop();
+}
+
+void MdSession::start() {
+    // 每个 API 实例需要独立的流文件目录
+    std::string flow_path = "./log/md" + std::to_string(feed_id_) + "/";
+    fs::create_directories(flow_path);
+
+    api_ = CThostFtdcMdApi::CreateFtdcMdApi(flow_path.c_str());
+    if (!api_) {
+        std::cerr << "FATAL: Failed to create CTP API for feed " << feed_id_ << "!" << std::endl;
+        return;
+    }
+    api_->RegisterSpi(this);
+    api_->RegisterFront(const_cast<char*>(front_.c_str()));
+    api_->Init();
+    std::cout << "[Recorder] Feed " << feed_id_ << " -> " << front_ << std::endl;
+}
+
+void MdSession::stop() {
+    if (api_) {
+        api_->RegisterSpi(nullptr);
+        api_->Release();
+        api_ = nullptr;
+    }
+}
+
+void MdSession::OnFrontConnected() {
+    std::cout << "[Recorder] Feed " << feed_id_ << " front connected. Logging in..." << std::endl;
     CThostFtdcReqUserLoginField req = {0};
-    strncpy(req.BrokerID, broker_id_.c_str(), sizeof(req.BrokerID) - 1);
-    strncpy(req.UserID, user_id_.c_str(), sizeof(req.UserID) - 1);
-    strncpy(req.Password, password_.c_str(), sizeof(req.Password) - 1);
-    md_api_->ReqUserLogin(&req, 0);
+    strncpy(req.BrokerID, owner_->broker_id_.c_str(), sizeof(req.BrokerID) - 1);
+    strncpy(req.UserID, owner_->user_id_.c_str(), sizeof(req.UserID) - 1);
+    strncpy(req.Password, owner_->password_.c_str(), sizeof(req.Password) - 1);
+    api_->ReqUserLogin(&req, 0);
 }
 
-void TickRecorder::OnRspUserLogin(
+void MdSession::OnFrontDisconnected(int nReason) {
+    // CTP 会自动重连；其余会话继续供数，断线期间由它们补位
+    std::cerr << "[Recorder] Feed " << feed_id_ << " disconnected, reason=" << nReason << std::endl;
+    if (owner_->arbiter_) {
+        owner_->arbiter_->set_connected(feed_id_, false);
+    }
+}
+
+void MdSession::OnRspUserLogin(
     CThostFtdcRspUserLoginField* pRspUserLogin,
     CThostFtdcRspInfoField* pRspInfo,
     int nRequestID,
@@ -109,82 +257,36 @@ void TickRecorder::OnRspUserLogin(
 
     if (pRspInfo && pRspInfo->ErrorID == 0) {
         std::string tday = pRspUserLogin->TradingDay;
-        std::cout << "[Recorder] Login Success. Exchange TradingDay: " << tday
-                  << " | Using Config TradingDay: " << trading_day_int_ << std::endl;
+        std::cout << "[Recorder] Feed " << feed_id_ << " Login Success. Exchange TradingDay: " << tday
+                  << " | Using Config TradingDay: " << owner_->trading_day_int_ << std::endl;
 
         std::vector<char*> subs;
-        for (auto& s : symbols_) {
+        for (auto& s : owner_->symbols_) {
             subs.push_back(const_cast<char*>(s.c_str()));
+            instruments_.insert(s.c_str(), SymbolManager::instance().get_id(s.c_str()));
+        }
+        api_->SubscribeMarketData(subs.data(), subs.size());
+        if (owner_->arbiter_) {
+            owner_->arbiter_->set_connected(feed_id_, true);
         }
-        md_api_->SubscribeMarketData(subs.data(), subs.size());
-        std::cout << "[Recorder] Login Success. Day: " << tday << std::endl;
     }
 }
 
-void TickRecorder::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* pData) {
+void MdSession::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* pData) {
     if (!pData) {
         return;
     }
+    uint64_t recv_ns = IClock::instance().now_ns();
 
-    TickRecord rec;
-    memset(&rec, 0, sizeof(TickRecord));
-
-    strncpy(rec.symbol, pData->InstrumentID, sizeof(rec.symbol) - 1);
-    rec.symbol_id = SymbolManager::instance().get_id(rec.symbol);
-
-    if (pData->TradingDay[0] != '\0') {
-        rec.trading_day = std::stoi(pData->TradingDay);
-    } else {
-        rec.trading_day = trading_day_int_;
-    }
-
-    rec.last_price = pData->LastPrice;
-    rec.volume = pData->Volume;
-    rec.turnover = pData->Turnover;
-    rec.open_interest = pData->OpenInterest;
-
-    rec.upper_limit = pData->UpperLimitPrice;
-    rec.lower_limit = pData->LowerLimitPrice;
-    rec.open_price = pData->OpenPrice;
-    rec.highest_price = pData->HighestPrice;
-    rec.lowest_price = pData->LowestPrice;
-    rec.pre_close_price = pData->PreClosePrice;
-
-    rec.bid_price[0] = pData->BidPrice1;
-    rec.bid_volume[0] = pData->BidVolume1;
-    rec.bid_price[1] = pData->BidPrice2;
-    rec.bid_volume[1] = pData->BidVolume2;
-    rec.bid_price[2] = pData->BidPrice3;
-    rec.bid_volume[2] = pData->BidVolume3;
-    rec.bid_price[3] = pData->BidPrice4;
-    rec.bid_volume[3] = pData->BidVolume4;
-    rec.bid_price[4] = pData->BidPrice5;
-    rec.bid_volume[4] = pData->BidVolume5;
-
-    rec.ask_price[0] = pData->AskPrice1;
-    rec.ask_volume[0] = pData->AskVolume1;
-    rec.ask_price[1] = pData->AskPrice2;
-    rec.ask_volume[1] = pData->AskVolume2;
-    rec.ask_price[2] = pData->AskPrice3;
-    rec.ask_volume[2] = pData->AskVolume3;
-    rec.ask_price[3] = pData->AskPrice4;
-    rec.ask_volume[3] = pData->AskVolume4;
-    rec.ask_price[4] = pData->AskPrice5;
-    rec.ask_volume[4] = pData->AskVolume5;
-
-    int hh = 0;
-    int mm = 0;
-    int ss = 0;
-    if (sscanf(pData->UpdateTime, "%d:%d:%d", &hh, &mm, &ss) == 3) {
-        rec.update_time =
-            (static_cast<uint64_t>(hh) * 10000 + mm * 100 + ss) * 1000 + pData->UpdateMillisec;
-    }
-
-    if (use_shm_) {
-        MarketSnapshot::instance().update(rec);
-    }
-    if (!rb_.push(rec)) {
+    // 合约缓存在订阅时预填充；未订阅的合约 (极少) 回退到 SymbolManager 并补入缓存
+    const InstrumentCache::Entry* inst = instruments_.find(pData->InstrumentID);
+    if (!inst) {
+        inst = instruments_.insert(pData->InstrumentID, SymbolManager::instance().get_id(pData->InstrumentID));
+        if (!inst) {
+            return;
+        }
     }
+    owner_->on_tick(feed_id_, *pData, *inst, recv_ns);
 }
 
 void TickRecorder::load_config(const std::string& config_path) {
@@ -195,8 +297,19 @@ void TickRecorder::load_config(const std::string& config_path) {
         throw std::runtime_error("FATAL: YAML Parse Error in " + config_path + ": " + e.what());
     }
 
-    if (doc["md_front"]) {
-        md_front_ = doc["md_front"].as<std::string>();
+    // md_fronts: 多路会话 (主备前置或同一前置多连接)，按 (update_time, volume) 择先发布；兼容单个 md_front
+    if (doc["md_fronts"] && doc["md_fronts"].IsSequence()) {
+        for (const auto& f : doc["md_fronts"]) {
+            md_fronts_.push_back(f.as<std::string>());
+        }
+    } else if (doc["md_front"]) {
+        md_fronts_.push_back(doc["md_front"].as<std::string>());
+    }
+    if (md_fronts_.empty()) {
+        throw std::runtime_error("FATAL: Missing mandatory config 'md_front' / 'md_fronts'");
+    }
+    if (md_fronts_.size() > FEED_ARBITER_MAX_FEEDS) {
+        throw std::runtime_error("FATAL: Too many md_fronts (max " + std::to_string(FEED_ARBITER_MAX_FEEDS) + ")");
     }
     if (doc["broker_id"]) {
         broker_id_ = doc["broker_id"].as<std::string>();
@@ -241,6 +354,38 @@ void TickRecorder::load_config(const std::string& config_path) {
         use_shm_ = true;
         shm_path_ = doc["shm"].as<std::string>();
     }
+
+    // 写入模式: ring (默认，MD 线程 -> 环形缓冲区 -> 写线程) / direct (MD 线程直写 mmap)
+    if (doc["write_mode"]) {
+        direct_mmap_ = (doc["write_mode"].as<std::string>() == "direct");
+    }
+    // 游标批量发布：累计 max_batch 条或最早未发布记录等待超过 max_batch_delay_us 即发布
+    if (doc["max_batch"]) {
+        max_batch_ = std::max<uint64_t>(1, doc["max_batch"].as<uint64_t>());
+    }
+    if (doc["max_batch_delay_us"]) {
+        max_batch_delay_us_ = doc["max_batch_delay_us"].as<uint64_t>();
+    }
+    if (doc["idle_sleep_us"]) {
+        idle_sleep_us_ = doc["idle_sleep_us"].as<uint64_t>();
+    }
+    // 分区输出: none (默认) / product / hash:N；分区仅在 ring 模式由写线程路由
+    if (doc["partition"]) {
+        if (!TickPartitioner::parse(doc["partition"].as<std::string>(), partitioner_)) {
+            throw std::runtime_error("FATAL: Invalid partition '" + doc["partition"].as<std::string>() + "'");
+        }
+    }
+    if (doc["partition_keep_merged"]) {
+        keep_merged_ = doc["partition_keep_merged"].as<bool>();
+    }
+    partition_capacity_ = doc["partition_capacity"] ? doc["partition_capacity"].as<uint64_t>() : initial_capacity_;
+    if (partitioner_.mode != TickPartitioner::NONE && direct_mmap_) {
+        std::cerr << "[Recorder] WARN: partition requires write_mode ring, falling back from direct" << std::endl;
+        direct_mmap_ = false;
+    }
+    if (doc["stats_interval_s"]) {
+        stats_interval_s_ = doc["stats_interval_s"].as<uint64_t>();
+    }
 }
 
 uint32_t TickRecorder::parse_time(const std::string& time_str) {
@@ -253,45 +398,175 @@ uint32_t TickRecorder::parse_time(const std::string& time_str) {
     return 0;
 }
 
-void TickRecorder::writer_loop() {
-    while (running_) {
-        TickRecord rec;
-        if (rb_.pop(rec)) {
-            save_to_file(rec);
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
+void TickRecorder::open_writer() {
+    if (global_ctx_) {
+        return;
     }
+    global_ctx_ = std::make_unique<WriterContext>();
+
+    fs::create_directories(output_path_);
+
+    char date_str[16];
+    snprintf(date_str, sizeof(date_str), "%u", trading_day_int_);
+
+    std::string base_path = output_path_ + "/market_data_" + date_str + file_suffix_;
 
-    TickRecord rec;
-    while (rb_.pop(rec)) {
-        save_to_file(rec);
+    std::cout << "[Recorder] Output File: " << base_path << std::endl;
+    std::cout << "[Recorder] Initial Capacity: " << initial_capacity_ << " records (~"
+              << (initial_capacity_ * sizeof(TickRecord) / (1024.0 * 1024.0 * 1024.0))
+              << " GB)" << std::endl;
+    std::cout << "[Recorder] Write Mode: " << (direct_mmap_ ? "direct" : "ring")
+              << " | max_batch: " << max_batch_ << " | max_batch_delay_us: " << max_batch_delay_us_ << std::endl;
+
+    global_ctx_->base_path = base_path;
+    if (partitioner_.mode != TickPartitioner::NONE) {
+        global_ctx_->part_by_index.assign(SymbolManager::instance().count(), -1);
+        partitioner_.write_manifest(base_path, global_ctx_->part_keys);
+        std::cout << "[Recorder] Partition: " << partitioner_.spec()
+                  << " | Keep Merged: " << (keep_merged_ ? "yes" : "no") << std::endl;
+        if (!keep_merged_) {
+            return;
+        }
     }
-    global_ctx_.reset();
+    global_ctx_->writer = std::make_unique<MmapWriter<TickRecord>>(base_path, initial_capacity_);
 }
 
-void TickRecorder::save_to_file(const TickRecord& rec) {
-    if (!global_ctx_) {
-        global_ctx_ = std::make_unique<WriterContext>();
-
-        fs::create_directories(output_path_);
+MmapWriter<TickRecord>* TickRecorder::partition_writer(const TickRecord& rec) {
+    WriterContext& ctx = *global_ctx_;
+    int* cached = nullptr;
+    int idx = SymbolManager::instance().get_index(rec.symbol_id);
+    if (idx >= 0 && static_cast<size_t>(idx) < ctx.part_by_index.size()) {
+        cached = &ctx.part_by_index[idx];
+    } else {
+        cached = &ctx.part_by_symbol.try_emplace(rec.symbol, -1).first->second;
+    }
+
+    if (*cached < 0) {
+        std::string key = partitioner_.key_for(rec.symbol);
+        auto it = ctx.part_by_key.find(key);
+        if (it == ctx.part_by_key.end()) {
+            // 新分区：创建文件后更新清单，读者据此发现分区
+            ctx.parts.push_back(std::make_unique<MmapWriter<TickRecord>>(
+                TickPartitioner::path(ctx.base_path, key), partition_capacity_));
+            ctx.part_keys.push_back(key);
+            it = ctx.part_by_key.emplace(key, static_cast<int>(ctx.parts.size() - 1)).first;
+            partitioner_.write_manifest(ctx.base_path, ctx.part_keys);
+        }
+        *cached = it->second;
+    }
+    return ctx.parts[*cached].get();
+}
 
-        char date_str[16];
-        snprintf(date_str, sizeof(date_str), "%u", trading_day_int_);
+void TickRecorder::publish_all() {
+    WriterContext& ctx = *global_ctx_;
+    if (ctx.writer) {
+        ctx.writer->publish();
+    }
+    if (ctx.part_pending > 0) {
+        for (auto& w : ctx.parts) {
+            w->publish();
+        }
+        ctx.part_pending = 0;
+    }
+}
 
-        std::string base_path = output_path_ + "/market_data_" + date_str + file_suffix_;
+void TickRecorder::writer_loop() {
+    using Clock = std::chrono::steady_clock;
+    const auto max_delay = std::chrono::microseconds(max_batch_delay_us_);
+    const auto idle_sleep = std::chrono::microseconds(idle_sleep_us_);
+    const auto report_period = std::chrono::seconds(stats_interval_s_);
+    Clock::time_point next_report = Clock::now() + report_period;
+    Clock::time_point next_resync = Clock::now() + std::chrono::seconds(1);
+    auto maybe_report = [&] {
+        if (tsc_clock_ && Clock::now() >= next_resync) {
+            next_resync += std::chrono::seconds(1);
+            tsc_clock_->resync();
+        }
+        if (arbiter_ && stats_interval_s_ > 0 && Clock::now() >= next_report) {
+            next_report += report_period;
+            report_feeds();
+        }
+    };
+
+    if (direct_mmap_) {
+        // 直写模式下写线程只负责定时发布 MD 线程未满批的尾部记录
+        const auto period = max_delay.count() > 0 ? max_delay : idle_sleep;
+        while (running_) {
+            std::this_thread::sleep_for(period);
+            global_ctx_->writer->publish();
+            maybe_report();
+        }
+    } else {
+        open_writer();
+        Clock::time_point batch_start;
+
+        while (running_) {
+            maybe_report();
+            size_t drained = drain_ring();
+            uint64_t pending = global_ctx_->writer ? global_ctx_->writer->unpublished() : global_ctx_->part_pending;
+
+            if (pending > 0) {
+                if (drained > 0 && pending == drained) {
+                    batch_start = Clock::now();
+                }
+                if (pending >= max_batch_ || Clock::now() - batch_start >= max_delay) {
+                    publish_all();
+                    continue;
+                }
+            }
+            if (drained == 0) {
+                std::this_thread::sleep_for(pending > 0 ? std::min<Clock::duration>(idle_sleep, max_delay) : idle_sleep);
+            }
+        }
 
-        std::cout << "[Recorder] Output File: " << base_path << std::endl;
-        std::cout << "[Recorder] Initial Capacity: " << initial_capacity_ << " records (~"
-                  << (initial_capacity_ * sizeof(TickRecord) / (1024.0 * 1024.0 * 1024.0))
-                  << " GB)" << std::endl;
+        while (drain_ring() > 0) {
+        }
+    }
 
-        global_ctx_->writer = std::make_unique<MmapWriter<TickRecord>>(base_path, initial_capacity_);
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        std::cerr << "[Recorder] WARN: " << dropped << " ticks dropped (buffer full)" << std::endl;
     }
+    global_ctx_.reset();  // 析构时发布剩余记录并裁剪文件
+}
+
+size_t TickRecorder::drain_ring() {
+    WriterContext& ctx = *global_ctx_;
+    MmapWriter<TickRecord>* merged = ctx.writer.get();
+    const bool partitioned = partitioner_.mode != TickPartitioner::NONE;
+    size_t total = 0;
+
+    // 环形缓冲区的连续段整体 memcpy 到 mmap，仅 commit 不发布，游标由调用方按批发布
+    for (auto [ptr, len] = rb_.peek(); len > 0; std::tie(ptr, len) = rb_.peek()) {
+        if (merged) {
+            size_t avail = 0;
+            TickRecord* dst = merged->reserve(&avail);
+            size_t n = dst ? std::min(len, avail) : 0;
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), ptr, n * sizeof(TickRecord));
+                merged->commit(n);
+            }
+            if (n < len) {
+                dropped_.fetch_add(len - n, std::memory_order_relaxed);
+            }
+        }
 
-    if (global_ctx_->writer) {
-        if (!global_ctx_->writer->write(rec)) {
-            std::cerr << "[Recorder] WARN: Mmap buffer full!" << std::endl;
+        // 分区：逐条路由到对应合约的文件
+        if (partitioned) {
+            for (size_t i = 0; i < len; ++i) {
+                MmapWriter<TickRecord>* w = partition_writer(ptr[i]);
+                TickRecord* slot = w->reserve();
+                if (!slot) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                *slot = ptr[i];
+                w->commit(1);
+                ++ctx.part_pending;
+            }
         }
+        rb_.advance(len);
+        total += len;
     }
+    return total;
 }
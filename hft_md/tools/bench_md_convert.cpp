@@ -0,0 +1,134 @@
+#include "protocol.h"
+#include "ring_buffer.h"
+#include "symbol_manager.h"
+#include "md_convert.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <tuple>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// 对比 CTP 回调线程上的单 Tick 转换开销：
+//   legacy: memset + strncpy + SymbolManager 查表 + stoi + sscanf + RingBuffer::push 拷贝
+//   direct: InstrumentCache + BatchRingBuffer::reserve 就地填充 + 定长解析
+// 用法: bench_md_convert [symbols.txt]
+
+constexpr size_t TICK_COUNT = 4915200;  // CHUNK 的整数倍
+constexpr size_t RB_SIZE = 65536;
+
+static std::vector<CThostFtdcDepthMarketDataField> make_feed(const std::vector<std::string>& syms) {
+    std::vector<CThostFtdcDepthMarketDataField> feed(1024);
+    for (size_t i = 0; i < feed.size(); ++i) {
+        auto& d = feed[i];
+        std::memset(&d, 0, sizeof(d));
+        std::strncpy(d.InstrumentID, syms[i % syms.size()].c_str(), sizeof(d.InstrumentID) - 1);
+        std::strcpy(d.TradingDay, "20260302");
+        std::snprintf(d.UpdateTime, sizeof(d.UpdateTime), "%02d:%02d:%02d", 9 + (int)(i / 3600) % 6, (int)(i / 60) % 60, (int)i % 60);
+        d.UpdateMillisec = (i & 1) ? 500 : 0;
+        d.LastPrice = 3000 + (i % 50);
+        d.Volume = (int)i * 3;
+        d.Turnover = d.Volume * 3000.0;
+        d.BidPrice1 = d.LastPrice - 1; d.BidVolume1 = 10;
+        d.AskPrice1 = d.LastPrice + 1; d.AskVolume1 = 12;
+        d.BidPrice2 = d.BidPrice3 = d.BidPrice4 = d.BidPrice5 = 1.7976931348623157e308;
+        d.AskPrice2 = d.AskPrice3 = d.AskPrice4 = d.AskPrice5 = 1.7976931348623157e308;
+    }
+    return feed;
+}
+
+static void legacy_convert(const CThostFtdcDepthMarketDataField* pData, uint32_t default_day, TickRecord& rec) {
+    memset(&rec, 0, sizeof(TickRecord));
+    strncpy(rec.symbol, pData->InstrumentID, sizeof(rec.symbol) - 1);
+    rec.symbol_id = SymbolManager::instance().get_id(rec.symbol);
+    rec.trading_day = pData->TradingDay[0] != '\0' ? std::stoi(pData->TradingDay) : default_day;
+    rec.last_price = pData->LastPrice;
+    rec.volume = pData->Volume;
+    rec.turnover = pData->Turnover;
+    rec.open_interest = pData->OpenInterest;
+    rec.upper_limit = pData->UpperLimitPrice;
+    rec.lower_limit = pData->LowerLimitPrice;
+    rec.open_price = pData->OpenPrice;
+    rec.highest_price = pData->HighestPrice;
+    rec.lowest_price = pData->LowestPrice;
+    rec.pre_close_price = pData->PreClosePrice;
+    rec.bid_price[0] = pData->BidPrice1; rec.bid_volume[0] = pData->BidVolume1;
+    rec.bid_price[1] = pData->BidPrice2; rec.bid_volume[1] = pData->BidVolume2;
+    rec.bid_price[2] = pData->BidPrice3; rec.bid_volume[2] = pData->BidVolume3;
+    rec.bid_price[3] = pData->BidPrice4; rec.bid_volume[3] = pData->BidVolume4;
+    rec.bid_price[4] = pData->BidPrice5; rec.bid_volume[4] = pData->BidVolume5;
+    rec.ask_price[0] = pData->AskPrice1; rec.ask_volume[0] = pData->AskVolume1;
+    rec.ask_price[1] = pData->AskPrice2; rec.ask_volume[1] = pData->AskVolume2;
+    rec.ask_price[2] = pData->AskPrice3; rec.ask_volume[2] = pData->AskVolume3;
+    rec.ask_price[3] = pData->AskPrice4; rec.ask_volume[3] = pData->AskVolume4;
+    rec.ask_price[4] = pData->AskPrice5; rec.ask_volume[4] = pData->AskVolume5;
+    int hh = 0, mm = 0, ss = 0;
+    if (sscanf(pData->UpdateTime, "%d:%d:%d", &hh, &mm, &ss) == 3) {
+        rec.update_time = (static_cast<uint64_t>(hh) * 10000 + mm * 100 + ss) * 1000 + pData->UpdateMillisec;
+    }
+}
+
+// 分段计时：每段只计生产 (回调) 耗时，段间在计时外清空缓冲区，避免消费线程争用干扰结果
+constexpr size_t CHUNK = RB_SIZE / 2;
+
+template <typename RB, typename Drain, typename Produce>
+static double run(const char* name, RB& rb, Drain drain, Produce produce) {
+    double total_ns = 0;
+    size_t dropped = 0;
+    for (size_t base = 0; base < TICK_COUNT; base += CHUNK) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (size_t i = base; i < base + CHUNK; ++i) {
+            if (!produce(i)) ++dropped;
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        total_ns += std::chrono::duration<double, std::nano>(end_time - start_time).count();
+        drain(rb);
+    }
+
+    double ns = total_ns / TICK_COUNT;
+    std::cout << "[" << std::setw(8) << name << "] " << std::fixed << std::setprecision(1)
+              << ns << " ns/tick (callback thread), dropped=" << dropped << std::endl;
+    return ns;
+}
+
+int main(int argc, char* argv[]) {
+    SymbolManager::instance().load(argc > 1 ? argv[1] : "../conf/symbols.txt");
+
+    std::vector<std::string> syms = {"AP603", "au2606", "rb2605", "IF2603", "m2605", "ag2606", "cu2604", "sc2604"};
+    auto feed = make_feed(syms);
+    const uint32_t default_day = 20260302;
+
+    // legacy
+    auto legacy_rb = std::make_unique<RingBuffer<TickRecord, RB_SIZE>>();
+    double legacy_ns = run("legacy", *legacy_rb,
+        [](RingBuffer<TickRecord, RB_SIZE>& rb) { TickRecord r; while (rb.pop(r)) {} },
+        [&](size_t i) {
+            TickRecord rec;
+            legacy_convert(&feed[i & 1023], default_day, rec);
+            return legacy_rb->push(rec);
+        });
+
+    // direct
+    auto direct_rb = std::make_unique<BatchRingBuffer<TickRecord, RB_SIZE>>();
+    auto cache = std::make_unique<InstrumentCache>();
+    for (auto& s : syms) cache->insert(s.c_str(), SymbolManager::instance().get_id(s.c_str()));
+    double direct_ns = run("direct", *direct_rb,
+        [](BatchRingBuffer<TickRecord, RB_SIZE>& rb) {
+            for (auto [p, n] = rb.peek(); n > 0; std::tie(p, n) = rb.peek()) rb.advance(n);
+        },
+        [&](size_t i) {
+            const auto& d = feed[i & 1023];
+            const InstrumentCache::Entry* inst = cache->find(d.InstrumentID);
+            auto [slot, avail] = direct_rb->reserve();
+            if (avail == 0) return false;
+            fill_tick(d, *inst, default_day, *slot);
+            direct_rb->commit(1);
+            return true;
+        });
+
+    std::cout << "speedup: " << std::setprecision(2) << legacy_ns / direct_ns << "x" << std::endl;
+    return 0;
+}
@@ -1,154 +1,436 @@
+// 历史 K 线批量生成：mmap 录制文件，按合约分区多线程合成 (与实盘 KlineModule 同一 KlineEngine)，
+// 一次扫描输出全部周期，写入 MmapReader<KlineRecord> 可读的 kline_<周期>_<交易日> 文件 (或 --store 写入 KlineStore)，可选列式输出。
 #include "protocol.h"
-#include <iostream>
+#include "mmap_util.h"
+#include "symbol_manager.h"
+#include "kline_engine.h"
+#include "kline_store.h"
+#include "tick_normalizer.h"
+#include "tick_partition.h"
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
-#include <vector>
-#include <string>
-#include <unordered_map>
 #include <iomanip>
-#include <cmath>
-#include <cstring>
-
-struct Bar {
-    char symbol[32];
-    uint64_t start_time; // HHMM00000 (ms)
-    double open;
-    double high;
-    double low;
-    double close;
-    int volume;          // 周期内成交量
-    double turnover;     // 周期内成交额
-    
-    // 辅助状态，用于差分计算
-    int last_tick_vol;
-    double last_tick_turnover;
-    bool initialized;
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string intervals = "1m";
+    std::string out_dir = ".";
+    std::string symbols = "../../conf/symbols.txt";
+    std::string sessions;
+    unsigned threads = 0;
+    bool columnar = false;
+    bool store = false;
+    bool raw = false;
+    std::vector<std::string> inputs;
 };
 
-// 简单的 K 线生成器
-class BarGenerator {
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] <file.dat|base|dir> ..." << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -i, --intervals <list>  周期列表 (默认 1m)，如 1m,5m,1h,1d,v1000" << std::endl;
+    std::cerr << "  -o, --out <dir>         输出目录 (默认 .)" << std::endl;
+    std::cerr << "  -j, --threads <N>       工作线程数 (默认 CPU 核数)" << std::endl;
+    std::cerr << "  -s, --symbols <file>    合约映射 (默认 ../../conf/symbols.txt)" << std::endl;
+    std::cerr << "      --sessions <file>   交易时段覆盖文件 (见 TradingSessions)" << std::endl;
+    std::cerr << "      --columnar          额外输出列式文件 kline_<周期>_<交易日>.cols/<字段>.bin" << std::endl;
+    std::cerr << "      --store             写入 KlineStore (kline_<周期>_<交易日>.kls，按合约分区，供策略按区间查询)" << std::endl;
+    std::cerr << "      --raw               不经过 TickNormalizer (去重/乱序过滤)" << std::endl;
+    std::cerr << "  -h, --help" << std::endl;
+    std::cerr << "目录参数展开为其中按名称排序的 .dat (合并文件存在时跳过其分区文件 <base>.p.<key>.dat)；每个输入文件视为完整的交易日数据，文件结束时收掉未闭合 Bar。" << std::endl;
+}
+
+// 只读映射一个录制文件；有 .meta 时以写游标为准
+class MappedTicks {
 public:
-    BarGenerator(int interval_min) : interval_ms_(interval_min * 60 * 1000) {}
-
-    void process_tick(const TickRecord& tick) {
-        std::string symbol = tick.symbol;
-        Bar& bar = context_[symbol];
-
-        // 提取时间 (HHMMSSmmm -> ms from 00:00:00)
-        uint64_t t = tick.update_time;
-        int hh = t / 10000000;
-        int mm = (t / 100000) % 100;
-        int ss = (t / 1000) % 100;
-        int ms = t % 1000;
-        
-        long current_ms = hh * 3600000 + mm * 60000 + ss * 1000 + ms;
-        long bar_start_ms = (current_ms / interval_ms_) * interval_ms_;
-
-        // 初始化
-        if (!bar.initialized) {
-            init_bar(bar, tick, bar_start_ms);
-            return; // 第一个 Tick 仅用于初始化状态，不计入成交量（除非是当天的第一个 Tick，这里简化处理）
+    explicit MappedTicks(const std::string& dat_path) {
+        int fd = open(dat_path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("无法打开 " + dat_path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("fstat 失败: " + dat_path);
         }
+        size_ = static_cast<size_t>(st.st_size);
+        count_ = size_ / sizeof(TickRecord);
+        if (count_ > 0) {
+            data_ = static_cast<const TickRecord*>(mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0));
+            if (data_ == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("mmap 失败: " + dat_path);
+            }
+            madvise(const_cast<TickRecord*>(data_), size_, MADV_SEQUENTIAL);
+        }
+        close(fd);
 
-        // 检查新周期
-        if (current_ms >= bar.start_time + interval_ms_) {
-            finish_bar(bar);
-            init_bar(bar, tick, bar_start_ms);
-            // 这里新 Bar 的 Volume 需要包含当前 Tick 的增量
-            // 但因为 init_bar 会重置 volume=0，我们需要修正
+        std::string meta = dat_path.substr(0, dat_path.size() - 4) + ".meta";
+        std::ifstream ifs(meta, std::ios::binary);
+        MetaHeader header;
+        if (ifs.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            count_ = std::min<uint64_t>(count_, header.write_cursor.load());
         }
-        
-        // 计算增量
-        int vol_delta = tick.volume - bar.last_tick_vol;
-        double to_delta = tick.turnover - bar.last_tick_turnover;
-
-        // 过滤非法数据（CTP 有时会推重复或者乱序）
-        if (vol_delta < 0) vol_delta = 0; 
-        if (to_delta < 0) to_delta = 0;
-
-        // 更新 K 线
-        bar.high = std::max(bar.high, tick.last_price);
-        bar.low = std::min(bar.low, tick.last_price);
-        bar.close = tick.last_price;
-        bar.volume += vol_delta;
-        bar.turnover += to_delta;
-
-        // 更新状态
-        bar.last_tick_vol = tick.volume;
-        bar.last_tick_turnover = tick.turnover;
-    }
-
-    void finish_all() {
-        for (auto& pair : context_) {
-            if (pair.second.initialized) {
-                finish_bar(pair.second);
-            }
+    }
+    ~MappedTicks() {
+        if (data_ && data_ != MAP_FAILED) munmap(const_cast<TickRecord*>(data_), size_);
+    }
+    MappedTicks(const MappedTicks&) = delete;
+    MappedTicks& operator=(const MappedTicks&) = delete;
+
+    const TickRecord* data() const { return data_; }
+    uint64_t count() const { return count_; }
+
+private:
+    const TickRecord* data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t count_ = 0;
+};
+
+// 合约 -> 工作线程：已知合约按稠密下标轮转，未知合约按代码哈希
+inline unsigned partition_of(const TickRecord& t, unsigned n) {
+    int idx = t.symbol_id ? SymbolManager::instance().get_index(t.symbol_id) : -1;
+    if (idx >= 0) return static_cast<unsigned>(idx) % n;
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < sizeof(t.symbol) && t.symbol[i]; ++i) {
+        h ^= static_cast<unsigned char>(t.symbol[i]);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<unsigned>(h % n);
+}
+
+// 每个工作线程独占一组合约、一个 KlineEngine 与一个 TickNormalizer
+struct Worker {
+    std::unique_ptr<KlineEngine> engine;
+    TickNormalizer normalizer;
+    std::vector<std::vector<KlineRecord>> bars;  // [spec]
+    uint64_t ticks = 0;
+    uint64_t dropped = 0;
+    double busy_s = 0;
+};
+
+// 输出：每 (周期, 交易日) 一个 MmapWriter 或 KlineStore 日文件，可选列式文件
+class KlineSink {
+public:
+    KlineSink(const Options& opt, const std::vector<KlineSpec>& specs) : opt_(opt), specs_(specs) {
+        if (opt_.store) store_ = std::make_unique<KlineStore>(opt_.out_dir, true);
+    }
+
+    void write(size_t k, std::vector<KlineRecord>& bars) {
+        // 同一批内按 交易日 / 交易时段时间 / 合约 排序，读者按时间顺序扫描
+        std::sort(bars.begin(), bars.end(), [](const KlineRecord& a, const KlineRecord& b) {
+            if (a.trading_day != b.trading_day) return a.trading_day < b.trading_day;
+            uint64_t sa = TickNormalizer::session_ms(a.start_time), sb = TickNormalizer::session_ms(b.start_time);
+            if (sa != sb) return sa < sb;
+            return a.symbol_id < b.symbol_id;
+        });
+        size_t i = 0;
+        while (i < bars.size()) {
+            size_t j = i;
+            while (j < bars.size() && bars[j].trading_day == bars[i].trading_day) ++j;
+            write_day(k, bars[i].trading_day, &bars[i], j - i);
+            i = j;
         }
+        bars.clear();
     }
 
+    uint64_t written() const { return written_; }
+    uint64_t dropped() const { return dropped_; }
+    size_t files() const { return writers_.size() + store_days_.size(); }
+
 private:
-    void init_bar(Bar& bar, const TickRecord& tick, long start_ms) {
-        strncpy(bar.symbol, tick.symbol, 31);
-        bar.start_time = start_ms;
-        bar.open = tick.last_price;
-        bar.high = tick.last_price;
-        bar.low = tick.last_price;
-        bar.close = tick.last_price;
-        bar.volume = 0;
-        bar.turnover = 0;
-        
-        bar.last_tick_vol = tick.volume;
-        bar.last_tick_turnover = tick.turnover;
-        bar.initialized = true;
-    }
-
-    void finish_bar(const Bar& bar) {
-        // 格式化时间 HH:MM:00
-        long s = bar.start_time / 1000;
-        int hh = s / 3600;
-        int mm = (s % 3600) / 60;
-        
-        std::cout << bar.symbol << ","
-                  << std::setfill('0') << std::setw(2) << hh << ":" 
-                  << std::setw(2) << mm << ":00,"
-                  << std::fixed << std::setprecision(2)
-                  << bar.open << ","
-                  << bar.high << ","
-                  << bar.low << ","
-                  << bar.close << ","
-                  << bar.volume << ","
-                  << bar.turnover
-                  << std::endl;
-    }
-
-    int interval_ms_;
-    std::unordered_map<std::string, Bar> context_;
+    struct Columns {
+        std::ofstream symbol_id, start_time, open, high, low, close, volume, turnover, open_interest;
+    };
+
+    std::string base(size_t k, uint32_t day) const {
+        return opt_.out_dir + "/kline_" + specs_[k].label + "_" + std::to_string(day);
+    }
+
+    // 时间线容量有确定上界 (合约数 x 单日最多 Bar 数)；阈值线按首批数量留足余量
+    uint64_t capacity_for(size_t k, size_t first_batch) const {
+        const KlineSpec& s = specs_[k];
+        uint64_t symbols = std::max<size_t>(SymbolManager::instance().count(), 64);
+        if (s.type == KLINE_TIME) {
+            uint64_t per_day = s.daily() ? 2 : 24 * 3600 / s.size + 8;
+            return std::max<uint64_t>(symbols * per_day, first_batch * 2);
+        }
+        return std::max<uint64_t>(first_batch * 4, symbols * 2000);
+    }
+
+    void write_day(size_t k, uint32_t day, const KlineRecord* recs, size_t n) {
+        auto key = std::make_pair(k, day);
+        if (store_) {
+            // 重新生成时覆盖旧文件，否则同一交易日的 Bar 会被当作重复写入拒绝
+            if (store_days_.insert(key).second) fs::remove(KlineStore::path(opt_.out_dir, specs_[k].label, day));
+            for (size_t i = 0; i < n; ++i) {
+                if (store_->append(recs[i], specs_[k].label)) {
+                    ++written_;
+                } else {
+                    ++dropped_;
+                }
+            }
+            if (opt_.columnar) write_columns(k, day, recs, n);
+            return;
+        }
+        auto it = writers_.find(key);
+        if (it == writers_.end()) {
+            std::string b = base(k, day);
+            fs::remove(b + ".dat");
+            fs::remove(b + ".meta");
+            it = writers_.emplace(key, std::make_unique<MmapWriter<KlineRecord>>(b, capacity_for(k, n))).first;
+        }
+        size_t w = it->second->write_batch(recs, n);
+        written_ += w;
+        dropped_ += n - w;
+        if (opt_.columnar) write_columns(k, day, recs, n);
+    }
+
+    void write_columns(size_t k, uint32_t day, const KlineRecord* recs, size_t n) {
+        auto key = std::make_pair(k, day);
+        auto it = columns_.find(key);
+        if (it == columns_.end()) {
+            std::string dir = base(k, day) + ".cols";
+            fs::create_directories(dir);
+            auto c = std::make_unique<Columns>();
+            auto open_col = [&](std::ofstream& f, const char* name) {
+                f.open(dir + "/" + name + ".bin", std::ios::binary | std::ios::trunc);
+            };
+            open_col(c->symbol_id, "symbol_id.u64");
+            open_col(c->start_time, "start_time.u64");
+            open_col(c->open, "open.f64");
+            open_col(c->high, "high.f64");
+            open_col(c->low, "low.f64");
+            open_col(c->close, "close.f64");
+            open_col(c->volume, "volume.i32");
+            open_col(c->turnover, "turnover.f64");
+            open_col(c->open_interest, "open_interest.f64");
+            it = columns_.emplace(key, std::move(c)).first;
+        }
+        Columns& c = *it->second;
+        auto put = [](std::ofstream& f, const auto& v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+        for (size_t i = 0; i < n; ++i) {
+            const KlineRecord& r = recs[i];
+            put(c.symbol_id, r.symbol_id);
+            put(c.start_time, r.start_time);
+            put(c.open, r.open);
+            put(c.high, r.high);
+            put(c.low, r.low);
+            put(c.close, r.close);
+            put(c.volume, r.volume);
+            put(c.turnover, r.turnover);
+            put(c.open_interest, r.open_interest);
+        }
+    }
+
+    const Options& opt_;
+    const std::vector<KlineSpec>& specs_;
+    std::map<std::pair<size_t, uint32_t>, std::unique_ptr<MmapWriter<KlineRecord>>> writers_;
+    std::map<std::pair<size_t, uint32_t>, std::unique_ptr<Columns>> columns_;
+    std::unique_ptr<KlineStore> store_;
+    std::set<std::pair<size_t, uint32_t>> store_days_;
+    uint64_t written_ = 0;
+    uint64_t dropped_ = 0;
 };
 
+bool parse_args(int argc, char* argv[], Options& opt) {
+    enum { OPT_SESSIONS = 1000, OPT_COLUMNAR, OPT_STORE, OPT_RAW };
+    static struct option long_options[] = {
+        {"intervals", required_argument, 0, 'i'},
+        {"out",       required_argument, 0, 'o'},
+        {"threads",   required_argument, 0, 'j'},
+        {"symbols",   required_argument, 0, 's'},
+        {"sessions",  required_argument, 0, OPT_SESSIONS},
+        {"columnar",  no_argument,       0, OPT_COLUMNAR},
+        {"store",     no_argument,       0, OPT_STORE},
+        {"raw",       no_argument,       0, OPT_RAW},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "i:o:j:s:h", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'i': opt.intervals = optarg; break;
+            case 'o': opt.out_dir = optarg; break;
+            case 'j': opt.threads = static_cast<unsigned>(std::stoul(optarg)); break;
+            case 's': opt.symbols = optarg; break;
+            case OPT_SESSIONS: opt.sessions = optarg; break;
+            case OPT_COLUMNAR: opt.columnar = true; break;
+            case OPT_STORE: opt.store = true; break;
+            case OPT_RAW: opt.raw = true; break;
+            default: return false;
+        }
+    }
+    for (int i = optind; i < argc; ++i) {
+        fs::path p(argv[i]);
+        if (fs::is_directory(p)) {
+            for (const auto& base : TickPartitioner::dir_inputs(p.string())) opt.inputs.push_back(base + ".dat");
+        } else {
+            std::string s = argv[i];
+            opt.inputs.push_back(p.extension() == ".dat" ? s : s + ".dat");
+        }
+    }
+    return !opt.inputs.empty();
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <dat_file> [interval_min]" << std::endl;
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        print_usage(argv[0]);
         return 1;
     }
 
-    std::string file_path = argv[1];
-    int interval = 1;
-    if (argc > 2) interval = std::stoi(argv[2]);
-
-    std::ifstream ifs(file_path, std::ios::binary);
-    if (!ifs) {
-        std::cerr << "Error: Cannot open " << file_path << std::endl;
+    std::vector<KlineSpec> specs;
+    if (!KlineSpec::parse_list(opt.intervals, specs)) {
+        std::cerr << "Error: invalid intervals '" << opt.intervals << "'" << std::endl;
         return 1;
     }
+    if (fs::exists(opt.symbols)) SymbolManager::instance().load(opt.symbols);
+    TradingSessions sessions;
+    if (!opt.sessions.empty() && !sessions.load(opt.sessions)) return 1;
+    fs::create_directories(opt.out_dir);
+
+    const unsigned n_threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Worker> workers(n_threads);
+    for (auto& w : workers) {
+        w.bars.resize(specs.size());
+        Worker* wp = &w;
+        w.engine = std::make_unique<KlineEngine>(specs, &sessions, [wp](const KlineRecord& k, size_t spec_index) {
+            wp->bars[spec_index].push_back(k);
+        });
+    }
+    KlineSink sink(opt, specs);
 
-    std::cout << "Symbol,Time,Open,High,Low,Close,Volume,Turnover" << std::endl;
+    uint64_t total_ticks = 0;
+    double scan_s = 0, build_s = 0, write_s = 0;
+    auto t_start = std::chrono::steady_clock::now();
+
+    for (const auto& input : opt.inputs) {
+        std::unique_ptr<MappedTicks> file;
+        try {
+            file = std::make_unique<MappedTicks>(input);
+        } catch (const std::exception& e) {
+            std::cerr << "[KlineGen] Skip " << input << ": " << e.what() << std::endl;
+            continue;
+        }
+        const TickRecord* data = file->data();
+        const uint64_t n = file->count();
+        if (n == 0) continue;
+        total_ticks += n;
+
+        // 1. 并行分区：按块扫描，每块为每个线程记录下标，块内与块间保持原始顺序 (单线程时跳过)
+        auto t0 = std::chrono::steady_clock::now();
+        const uint64_t chunk = (n + n_threads - 1) / n_threads;
+        std::vector<std::vector<std::vector<uint32_t>>> parts(n_threads, std::vector<std::vector<uint32_t>>(n_threads));
+        if (n_threads > 1) {
+            std::vector<std::thread> ts;
+            for (unsigned c = 0; c < n_threads; ++c) {
+                ts.emplace_back([&, c]() {
+                    uint64_t b = c * chunk, e = std::min(n, b + chunk);
+                    for (auto& v : parts[c]) v.reserve((e > b ? e - b : 0) / n_threads + 16);
+                    for (uint64_t i = b; i < e; ++i) {
+                        parts[c][partition_of(data[i], n_threads)].push_back(static_cast<uint32_t>(i));
+                    }
+                });
+            }
+            for (auto& t : ts) t.join();
+        }
+        scan_s += seconds_since(t0);
+
+        // 2. 并行合成：每个线程只处理自己的合约，文件结束时收掉未闭合 Bar
+        t0 = std::chrono::steady_clock::now();
+        {
+            std::vector<std::thread> ts;
+            for (unsigned w = 0; w < n_threads; ++w) {
+                ts.emplace_back([&, w]() {
+                    auto tw = std::chrono::steady_clock::now();
+                    Worker& wk = workers[w];
+                    TickRecord tick;
+                    auto process = [&](const TickRecord& src) {
+                        if (opt.raw) {
+                            wk.engine->on_tick(src);
+                        } else {
+                            tick = src;
+                            if (wk.normalizer.process(tick) != TickNormalizer::PASS) {
+                                ++wk.dropped;
+                                return;
+                            }
+                            wk.engine->on_tick(tick);
+                        }
+                        ++wk.ticks;
+                    };
+                    if (n_threads == 1) {
+                        for (uint64_t i = 0; i < n; ++i) process(data[i]);
+                    } else {
+                        for (unsigned c = 0; c < n_threads; ++c) {
+                            for (uint32_t idx : parts[c][w]) process(data[idx]);
+                        }
+                    }
+                    wk.engine->flush();
+                    wk.busy_s += seconds_since(tw);
+                });
+            }
+            for (auto& t : ts) t.join();
+        }
+        build_s += seconds_since(t0);
+
+        // 3. 汇总落盘
+        t0 = std::chrono::steady_clock::now();
+        for (size_t k = 0; k < specs.size(); ++k) {
+            std::vector<KlineRecord> merged;
+            for (auto& w : workers) {
+                merged.insert(merged.end(), w.bars[k].begin(), w.bars[k].end());
+                w.bars[k].clear();
+            }
+            sink.write(k, merged);
+        }
+        write_s += seconds_since(t0);
+        std::cout << "[KlineGen] " << input << ": " << n << " ticks" << std::endl;
+    }
 
-    BarGenerator bg(interval);
-    TickRecord rec;
-    
-    while (ifs.read(reinterpret_cast<char*>(&rec), sizeof(TickRecord))) {
-        bg.process_tick(rec);
+    double wall_s = seconds_since(t_start);
+    uint64_t dropped_ticks = 0;
+    double busy_s = 0;
+    for (const auto& w : workers) {
+        dropped_ticks += w.dropped;
+        busy_s += w.busy_s;
     }
-    bg.finish_all();
 
-    return 0;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "========== kline_gen ==========" << std::endl;
+    std::cout << "inputs         : " << opt.inputs.size() << std::endl;
+    std::cout << "intervals      : " << opt.intervals << std::endl;
+    std::cout << "threads        : " << n_threads << std::endl;
+    std::cout << "ticks          : " << total_ticks << " (filtered: " << dropped_ticks << ")" << std::endl;
+    std::cout << "bars           : " << sink.written() << " in " << sink.files() << " files"
+              << (sink.dropped() ? " (dropped: " + std::to_string(sink.dropped()) + ")" : "") << std::endl;
+    std::cout << "time           : " << wall_s << " s (partition " << scan_s << ", build " << build_s
+              << ", write " << write_s << ")" << std::endl;
+    std::cout << std::setprecision(0);
+    std::cout << "throughput     : " << (wall_s > 0 ? total_ticks / wall_s : 0) << " ticks/s, "
+              << (wall_s > 0 ? total_ticks / wall_s / n_threads : 0) << " ticks/s per core" << std::endl;
+    std::cout << "build per core : " << (busy_s > 0 ? total_ticks / busy_s : 0) << " ticks/s (busy time)" << std::endl;
+    return sink.dropped() ? 1 : 0;
 }
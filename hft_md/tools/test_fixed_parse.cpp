@@ -0,0 +1,65 @@
+// CTP TradingDay / UpdateTime 定长解析 (fixed_parse.h) 的回归检查：
+// 合法输入按值解析，空串、短串、非数字、分隔符错位与越界均返回 false 且不改写输出。
+#include "fixed_parse.h"
+
+#include <cstring>
+#include <iostream>
+
+static int failures = 0;
+
+// CTP 字段为 char[9]：按定长缓冲区传入，短串之后补零
+static bool hhmmss(const char* text, uint32_t& out) {
+    char field[9] = {};
+    std::strncpy(field, text, 8);
+    return parse_hhmmss(field, out);
+}
+
+static bool yyyymmdd(const char* text, uint32_t& out) {
+    char field[9] = {};
+    std::strncpy(field, text, 8);
+    return parse_yyyymmdd(field, out);
+}
+
+static void expect_time(const char* text, bool ok, uint32_t want = 0) {
+    uint32_t got = 12345;
+    bool r = hhmmss(text, got);
+    if (r != ok || (ok && got != want) || (!ok && got != 12345)) {
+        ++failures;
+        std::cerr << "FAIL parse_hhmmss(\"" << text << "\") -> " << r << " " << got << std::endl;
+    }
+}
+
+static void expect_day(const char* text, bool ok, uint32_t want = 0) {
+    uint32_t got = 12345;
+    bool r = yyyymmdd(text, got);
+    if (r != ok || (ok && got != want) || (!ok && got != 12345)) {
+        ++failures;
+        std::cerr << "FAIL parse_yyyymmdd(\"" << text << "\") -> " << r << " " << got << std::endl;
+    }
+}
+
+int main() {
+    expect_time("09:30:05", true, 93005);
+    expect_time("00:00:00", true, 0);
+    expect_time("23:59:59", true, 235959);
+    expect_time("", false);
+    expect_time("9:30:05", false);
+    expect_time("09:30", false);
+    expect_time("09-30-05", false);
+    expect_time("09:3a:05", false);
+    expect_time("09:30:0/", false);
+    expect_time("24:00:00", false);
+    expect_time("09:60:00", false);
+    expect_time("09:30:60", false);
+
+    expect_day("20260302", true, 20260302);
+    expect_day("", false);
+    expect_day("2026030", false);
+    expect_day("2026O302", false);
+    expect_day("20261302", false);
+    expect_day("20260300", false);
+    expect_day("20260332", false);
+
+    std::cout << (failures ? "fixed_parse: FAILED" : "fixed_parse: OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+// kline_gen 目录输入展开 (TickPartitioner::dir_inputs) 的回归检查：
+// 合并文件与分区文件并存时只取合并文件，仅有分区时取各分区，其他录制文件不受影响。
+#include "tick_partition.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void touch(const fs::path& p) { std::ofstream(p.string()).put('\0'); }
+
+static void expect(const std::string& what, const std::vector<std::string>& got, const std::vector<std::string>& want) {
+    if (got == want) return;
+    ++failures;
+    std::cerr << "FAIL " << what << ": got {";
+    for (const auto& g : got) std::cerr << ' ' << fs::path(g).filename().string();
+    std::cerr << " } want {";
+    for (const auto& w : want) std::cerr << ' ' << fs::path(w).filename().string();
+    std::cerr << " }" << std::endl;
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("tick_inputs_" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    const std::string base = (dir / "market_data_20260302").string();
+    const std::string other = (dir / "market_data_20260303").string();
+
+    // 录制器 keep_merged (默认)：合并文件 + 按品种分区 + 清单
+    TickPartitioner part;
+    TickPartitioner::parse("product", part);
+    part.write_manifest(base, {"au", "rb"});
+    for (const std::string& b : {base, TickPartitioner::path(base, "au"), TickPartitioner::path(base, "rb"), other}) {
+        touch(b + ".dat");
+        touch(b + ".meta");
+    }
+    expect("merged + partitions", TickPartitioner::dir_inputs(dir.string()), {base, other});
+
+    // keep_merged: false：只有分区
+    fs::remove(base + ".dat");
+    fs::remove(base + ".meta");
+    expect("partitions only", TickPartitioner::dir_inputs(dir.string()),
+           {TickPartitioner::path(base, "au"), TickPartitioner::path(base, "rb"), other});
+
+    fs::remove_all(dir);
+    std::cout << (failures ? "tick_inputs: FAILED" : "tick_inputs: OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -11,6 +11,8 @@ class EventBusImpl;
 struct PluginHandle;
 class EngineTimerAdapter;
 class MarketSnapshot; // 前置声明
+class TscClock;
+class LatencyStats;
 
 // Engine 内部定时任务项（由 run 循环统一驱动）
 struct TimerTask {
@@ -42,6 +44,9 @@ public:
     // 停止所有插件并清理资源
     void stop();
 
+    // 事件总线：基准等工具在 loadConfig 之后订阅，回调排在所有插件之后
+    EventBus* bus() const;
+
 private:
     std::unique_ptr<EventBusImpl> bus_;
     std::vector<std::shared_ptr<PluginHandle>> plugins_;
@@ -57,5 +62,19 @@ private:
     void add_timer_impl(int interval_sec, std::function<void()> cb, int phase_sec = 0);
     void run_due_timers();
 
+    // 时间源 (clock: tsc | wall)；回放模块安装 SimClock 时定时器改由模拟时钟的整秒回调驱动
+    std::unique_ptr<IClock> clock_;
+    TscClock* tsc_clock_ = nullptr;
+    uint32_t end_hhmmss_ = 0;
+    uint64_t last_sim_sec_ = 0;
+    void on_sim_second(uint64_t sec);
+
     std::unique_ptr<MarketSnapshot> snapshot_impl_;
+
+    // 报单链路延迟统计 sink (配置 latency 时创建)
+    std::unique_ptr<LatencyStats> latency_stats_;
+
+    // 截面检查点 (snapshot.checkpoint_path)，为空表示不落盘
+    std::string checkpoint_path_;
+    void save_checkpoint();
 };
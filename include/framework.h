@@ -7,6 +7,9 @@
 #include <iostream>
 #include <array>
 #include "../core/include/protocol.h" // 引入 TickRecord 定义
+#include "../core/include/clock.h"    // 引擎统一时间源
+
+struct BookUpdate; // 定义见 core/include/order_book.h
 
 // ==========================================
 // 1. 基础数据结构
@@ -33,9 +36,33 @@ enum EventType {
     EVENT_CONN_STATUS,     // 连接状态更新
     EVENT_LOG,             // 日志
     EVENT_CACHE_RESET,     // 缓存重置信号 (由登录后的柜台确认触发)
+    EVENT_BOOK_UPDATE,     // 盘口重建更新 (OrderBookModule -> Strategy)，负载 BookUpdate
+    EVENT_REPLAY_STATUS,   // 回放阶段与读者滞后 (ReplayModule -> Others)，负载 ReplayStatus
+    EVENT_TICK_BATCH,      // 一批行情 (ReplayModule publish_batch -> StrategyTree tick_batch)，负载 TickBatch
+    EVENT_ORDER_CHECKED,   // 风控放行的报单请求 (Risk output: checked -> OrderManager input: checked)
+    EVENT_MD_IDLE,         // 行情线程空闲 (ReplayModule 无新数据时约每 100ms 一次)，无负载；供需在行情线程上执行的延迟任务使用
     MAX_EVENTS
 };
 
+// 回放阶段：WARMUP 期间追赶历史记录以重建状态，订阅方应抑制报单与对外推送
+enum ReplayPhase : int {
+    REPLAY_WARMUP = 0,
+    REPLAY_LIVE = 1
+};
+
+struct ReplayStatus {
+    int phase;              // ReplayPhase
+    uint64_t ticks;         // 已发布 Tick 数
+    uint64_t lag_records;   // 写者游标 - 本地游标
+    int64_t lag_ms;         // 本地时钟 - 最近发布 Tick 的 update_time
+};
+
+// 一次读取的一批行情：各条已按 EVENT_MARKET_DATA 逐条发布过，指针在本次回调内有效
+struct TickBatch {
+    const TickRecord* const* ticks;
+    size_t count;
+};
+
 // ==========================================
 // 2. 事件总线 (Host 提供)
 // ==========================================
@@ -60,6 +87,8 @@ public:
     virtual ~ITimerService() = default;
     // 每 interval_sec 秒执行一次 callback；phase_sec 为相位(0~interval_sec-1)，首次触发在 total_seconds % interval_sec == phase_sec 的时刻
     virtual void add_timer(int interval_sec, std::function<void()> callback, int phase_sec = 0) = 0;
+    // 引擎时间源：实盘为 TSC 时钟，回放为行情驱动的模拟时钟；定时器按同一时间源触发
+    virtual IClock& clock() { return IClock::instance(); }
 };
 
 // ==========================================
@@ -86,6 +115,9 @@ struct StrategyContext {
     std::function<void(const OrderReq&)> send_order;
     std::function<void(const SignalRecord&)> send_signal; // 新增：支持发送信号
     std::function<void(const char* msg)> log;
+    // 声明关心的合约 (init 中调用，可多次累加)：此后只收到这些合约的 Tick / K线 / 盘口事件；不调用则接收全部合约，
+    // 传入空列表表示不接收行情 (纯信号节点)。宿主可能不提供 (为空)，调用前需判断
+    std::function<void(const std::vector<std::string>& symbols)> subscribe_symbols;
 };
 
 class IStrategyNode {
@@ -96,6 +128,12 @@ public:
     virtual void onKline(const KlineRecord* kline) = 0; // 处理 K线数据
     virtual void onSignal(const SignalRecord* signal) = 0; // 处理因子信号
     virtual void onOrderUpdate(const OrderRtn* rtn) = 0;
+    // 盘口重建事件 (需加载 orderbook 模块)，默认忽略
+    virtual void onBookUpdate(const BookUpdate* update) {}
+    // 批量行情 (策略树 tick_batch 模式)：默认逐条转 onTick；可向量化的节点重写以摊薄逐条开销，须与逐条处理结果一致
+    virtual void onTickBatch(const TickRecord* const* ticks, size_t count) {
+        for (size_t i = 0; i < count; ++i) onTick(ticks[i]);
+    }
 };
 
 // ==========================================
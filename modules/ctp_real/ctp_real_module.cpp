@@ -1,6 +1,7 @@
 #include "../../include/framework.h"
 #include "../../core/include/symbol_manager.h"
 #include "../../core/include/order_manager.h"
+#include "../../core/include/latency_trace.h"
 #include "ThostFtdcTraderApi.h"
 #include <thread>
 #include <chrono>
@@ -244,7 +245,9 @@ void CtpRealModule::send_order(const OrderReq* req) {
     order.ForceCloseReason = THOST_FTDC_FCC_NotForceClose;
     order.IsAutoSuspend = 0;
 
+    LatencyTrace::stamp(LAT_API);
     int ret = td_api_->ReqOrderInsert(&order, req_id_++);
+    LatencyTrace::egress(*req);
     if (ret != 0) {
         std::cerr << "[CTP-Trade] Order Insert Failed: " << ret << std::endl;
     } else if (debug_) {
@@ -612,9 +615,7 @@ bool CtpRealModule::is_in_reconnect_time() const {
     }
     
     // 获取当前时间
-    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    struct tm* lt = std::localtime(&now);
-    int current_time = lt->tm_hour * 10000 + lt->tm_min * 100 + lt->tm_sec;
+    int current_time = static_cast<int>(IClock::instance().hhmmss());
     
     // 检查是否在任意一个时间段内
     for (const auto& range : reconnect_time_ranges_) {
@@ -0,0 +1,61 @@
+#include "framework.h"
+#include "protocol.h"
+#include "factor_store.h"
+#include <filesystem>
+#include <iostream>
+#include <memory>
+
+/**
+ * FactorStoreModule: 因子值存储插件
+ *
+ * 订阅 EVENT_SIGNAL (策略树 publish_signals 打开时发布，回放追赶期不发布)，把每个因子信号写入 FactorStore：
+ * 共享内存中的 合约 x 因子 最新值表 (seqlock，供其他进程零拷贝读取) 与可选的追加日志 (供离线重放与版本比对)。
+ * 信号在行情线程上同步写入，每条约为一次 seqlock 写 + 一条 24 字节日志记录。
+ * 日志记录的交易日取自引擎时钟 (回放为 SimClock 的行情时间)，按 18:00 划分夜盘归属。
+ */
+class FactorStoreModule : public IModule {
+public:
+    void init(EventBus* bus, const ConfigMap& config, ITimerService* timer_svc = nullptr) override {
+        std::string shm_name = config.count("shm_name") ? config.at("shm_name") : "/hft_factors";
+        std::string log_path = config.count("log_path") ? config.at("log_path") : "../data/factors/factor_log";
+        uint64_t log_capacity = config.count("log_capacity") ? std::stoull(config.at("log_capacity")) : 50000000ULL;
+        uint32_t max_symbols = config.count("max_symbols") ? std::stoul(config.at("max_symbols")) : 4096;
+        uint32_t max_factors = config.count("max_factors") ? std::stoul(config.at("max_factors")) : 64;
+
+        try {
+            store_ = std::make_unique<FactorStore>(shm_name, true, max_symbols, max_factors);
+        } catch (const std::exception& e) {
+            std::cerr << "[FactorStore] 初始化失败: " << e.what() << std::endl;
+            return;
+        }
+
+        // log_path 为空时只维护共享内存最新值表
+        if (!log_path.empty()) {
+            std::filesystem::path parent = std::filesystem::path(log_path).parent_path();
+            std::error_code ec;
+            if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+            if (!store_->open_log(log_path, log_capacity)) {
+                std::cerr << "[FactorStore] 日志不可用，仅写共享内存" << std::endl;
+            }
+        }
+        std::cout << "[FactorStore] SHM " << shm_name << " (" << max_symbols << " x " << max_factors << ")"
+                  << (log_path.empty() ? "" : ", log " + log_path) << std::endl;
+
+        IClock* clock = timer_svc ? &timer_svc->clock() : &IClock::instance();
+        bus->subscribe(EVENT_SIGNAL, [this, clock](void* d) {
+            store_->set_trading_day(clock->trading_day());
+            store_->update(*static_cast<SignalRecord*>(d));
+        });
+    }
+
+    void stop() override {
+        if (!store_) return;
+        std::cout << "[FactorStore] 合约 " << store_->symbols() << " 因子 " << store_->factors()
+                  << " 日志 " << store_->logged() << " 条，丢弃 " << store_->dropped() << " 条" << std::endl;
+    }
+
+private:
+    std::unique_ptr<FactorStore> store_;
+};
+
+EXPORT_MODULE(FactorStoreModule)
@@ -93,7 +93,13 @@ public:
         );
 
         // 订阅事件 (生产者)
+        // 回放追赶期的历史行情不推送给前端
+        bus_->subscribe(EVENT_REPLAY_STATUS, [this](void* d) {
+            replay_warmup_.store(static_cast<ReplayStatus*>(d)->phase == REPLAY_WARMUP, std::memory_order_relaxed);
+        });
+
         bus_->subscribe(EVENT_MARKET_DATA, [this](void* d) {
+            if (replay_warmup_.load(std::memory_order_relaxed)) return;
             MonitorEvent evt;
             evt.type = EVENT_MARKET_DATA;
             std::memcpy(&evt.data.md, d, sizeof(TickRecord));
@@ -451,6 +457,7 @@ private:
     RingBuffer<MonitorEvent, 4096> queue_;
     std::thread worker_;
     std::atomic<bool> running_{false};
+    std::atomic<bool> replay_warmup_{false};  // 回放追赶期不推送行情
 };
 
 EXPORT_MODULE(MonitorModule)
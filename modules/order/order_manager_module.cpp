@@ -1,7 +1,9 @@
 #include "../../include/framework.h"
 #include "../../core/include/order_manager.h"
+#include "../../core/include/latency_trace.h"
 #include <iostream>
 #include <unordered_map>
+#include <mutex>
 #include <shared_mutex>
 #include <cstring>
 
@@ -16,10 +18,14 @@ public:
 
         if (config.count("debug")) debug_ = (config.at("debug") == "true");
 
-        std::cout << "[OrderMgr] Hub Initialized." << std::endl;
+        // 报单来源：req 直接拦截策略请求；checked 只接收风控放行的请求 (Risk 需配置 output: checked)，
+        // 两者只能选一，否则同一笔报单会绕过风控再发一次
+        bool after_risk = config.count("input") && config.at("input") == "checked";
+
+        std::cout << "[OrderMgr] Hub Initialized. Input: " << (after_risk ? "checked" : "req") << std::endl;
 
         // 1. 拦截策略请求
-        bus_->subscribe(EVENT_ORDER_REQ, [this](void* d) {
+        bus_->subscribe(after_risk ? EVENT_ORDER_CHECKED : EVENT_ORDER_REQ, [this](void* d) {
             this->handleStrategyReq(static_cast<OrderReq*>(d));
         });
 
@@ -59,15 +65,17 @@ private:
         // A. 生成唯一标识
         req->client_id = OrderIDGenerator::instance().next_id();
         
-        // B. 记录上下文
-        std::unique_lock lock(mtx_);
-        auto& ctx = orders_[req->client_id];
-        ctx.request = *req;
-        
-        // C. 生成柜台映射 ID (OrderRef)
-        OrderIDGenerator::instance().next_order_ref(ctx.order_ref);
-        strncpy(req->order_ref, ctx.order_ref, 12); // 必须填回原结构体
-        ref_to_id_[ctx.order_ref] = req->client_id;
+        // B. 记录上下文 (发布前释放锁：交易模块可能在同一线程内同步回报，重入 handleRawOrder)
+        {
+            std::unique_lock lock(mtx_);
+            auto& ctx = orders_[req->client_id];
+            ctx.request = *req;
+
+            // C. 生成柜台映射 ID (OrderRef)
+            OrderIDGenerator::instance().next_order_ref(ctx.order_ref);
+            strncpy(req->order_ref, ctx.order_ref, 12); // 必须填回原结构体
+            ref_to_id_[ctx.order_ref] = req->client_id;
+        }
 
         if (debug_) {
             std::cout << "[OrderMgr] Decorated: CID=" << req->client_id 
@@ -75,6 +83,7 @@ private:
         }
 
         // D. 发布装饰后的请求
+        LatencyTrace::stamp(LAT_ORDER_MGR);
         bus_->publish(EVENT_ORDER_SEND, req);
     }
 
@@ -138,7 +147,8 @@ private:
             strncpy(ctx.order_sys_id, raw->order_sys_id, 20);
         }
 
-        // 发布最终回报
+        // 发布最终回报 (先释放锁，订阅方可能在回调内再次报单)
+        lock.unlock();
         bus_->publish(EVENT_RTN_ORDER, raw);
     }
 
@@ -154,6 +164,8 @@ private:
             if (it != ref_to_id_.end()) cid = it->second;
         }
 
+        lock.unlock();
+
         if (cid != 0) {
             raw->client_id = cid;
             bus_->publish(EVENT_RTN_TRADE, raw);
@@ -0,0 +1,95 @@
+#include "framework.h"
+#include "protocol.h"
+#include "order_book.h"
+#include "symbol_manager.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * OrderBookModule: 盘口重建插件
+ * 职责：订阅 EVENT_MARKET_DATA，为每个合约维护 OrderBook 价格阶梯，
+ *       推导档位事件 (新增/撤单/成交/击穿) 与排队估计，发布 EVENT_BOOK_UPDATE。
+ */
+class OrderBookModule : public IModule {
+public:
+    void init(EventBus* bus, const ConfigMap& config, ITimerService* timer_svc = nullptr) override {
+        bus_ = bus;
+
+        // 统一 tick_size (可选)，未配置时由每个合约首个 Tick 的档位价差推断
+        if (config.find("tick_size") != config.end()) {
+            tick_size_ = std::stod(config.at("tick_size"));
+        }
+        if (config.find("debug") != config.end()) {
+            debug_ = (config.at("debug") == "true" || config.at("debug") == "1");
+        }
+
+        // 合约按 SymbolManager 的稠密下标平铺存放
+        books_.resize(SymbolManager::instance().count());
+
+        bus_->subscribe(EVENT_MARKET_DATA, [this](void* d) {
+            onTick(static_cast<TickRecord*>(d));
+        });
+
+        if (debug_ && timer_svc) {
+            timer_svc->add_timer(60, [this]() { print_stats(); });
+        }
+
+        std::cout << "[OrderBook] Initialized. Symbols: " << books_.size()
+                  << " TickSize: " << (tick_size_ > 0 ? std::to_string(tick_size_) : "auto") << std::endl;
+    }
+
+    void stop() override {
+        if (debug_) print_stats();
+    }
+
+private:
+    OrderBook& book_for(const TickRecord* tick) {
+        int idx = SymbolManager::instance().get_index(tick->symbol_id);
+        std::unique_ptr<OrderBook>* slot;
+        if (idx >= 0 && static_cast<size_t>(idx) < books_.size()) {
+            slot = &books_[idx];
+        } else {
+            slot = &extra_books_[tick->symbol_id];
+        }
+        if (!*slot) slot->reset(new OrderBook(tick_size_));
+        return **slot;
+    }
+
+    void onTick(const TickRecord* tick) {
+        OrderBook& book = book_for(tick);
+        int n = book.apply(*tick, events_, ORDER_BOOK_MAX_EVENTS);
+        if (!book.ready()) return;
+
+        for (int i = 0; i < n; ++i) ++event_counts_[events_[i].type];
+
+        BookUpdate upd;
+        upd.tick = tick;
+        upd.book = &book;
+        upd.events = events_;
+        upd.event_count = n;
+        upd.volume_delta = book.volume_delta();
+        bus_->publish(EVENT_BOOK_UPDATE, &upd);
+    }
+
+    void print_stats() {
+        std::cout << "[OrderBook] events add=" << event_counts_[BOOK_ADD]
+                  << " cancel=" << event_counts_[BOOK_CANCEL]
+                  << " trade=" << event_counts_[BOOK_TRADE]
+                  << " trade_through=" << event_counts_[BOOK_TRADE_THROUGH] << std::endl;
+    }
+
+    EventBus* bus_ = nullptr;
+    double tick_size_ = 0.0;
+    bool debug_ = false;
+
+    std::vector<std::unique_ptr<OrderBook>> books_;
+    std::unordered_map<uint64_t, std::unique_ptr<OrderBook>> extra_books_; // 未在 symbols.txt 中的合约
+
+    BookLevelEvent events_[ORDER_BOOK_MAX_EVENTS];
+    uint64_t event_counts_[4] = {0, 0, 0, 0};
+};
+
+EXPORT_MODULE(OrderBookModule)
@@ -2,11 +2,22 @@
 #include "protocol.h"
 #include "mmap_util.h"
 #include "market_snapshot.h"
+#include "tick_normalizer.h"
+#include "tick_partition.h"
+#include "replay_pacer.h"
+#include "clock.h"
+#include "latency_trace.h"
 #include <iostream>
 #include <thread>
 #include <atomic>
 #include <cstring>
 #include <chrono>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
 #include <immintrin.h> // 用于 _mm_pause
 
 class ReplayModule : public IModule {
@@ -31,6 +42,86 @@ public:
             max_capacity_ = 0;  // 默认使用 meta 文件中的 capacity
         }
 
+        // 合约子集 (逗号分隔)：录制文件有分区清单时只打开相关分区，否则在合并文件上过滤
+        if (config.find("symbols") != config.end()) {
+            std::stringstream ss(config.at("symbols"));
+            std::string sym;
+            while (std::getline(ss, sym, ',')) {
+                sym.erase(0, sym.find_first_not_of(" \t"));
+                sym.erase(sym.find_last_not_of(" \t") + 1);
+                if (!sym.empty()) symbols_.push_back(sym);
+            }
+        }
+
+        // 启动模式 (接入录制中的文件)：
+        //   replay  : 从头全速回放 (默认，回测)
+        //   tail    : 跳到写者游标处，只发布之后的新行情
+        //   catchup : 从头追赶以重建快照/K线/策略状态，追赶期发布 REPLAY_WARMUP (订阅方抑制报单)，追平后切 REPLAY_LIVE
+        if (config.find("start_mode") != config.end()) {
+            const std::string& mode = config.at("start_mode");
+            if (mode == "tail") {
+                start_mode_ = START_TAIL;
+            } else if (mode == "catchup") {
+                start_mode_ = START_CATCHUP;
+            } else if (mode != "replay") {
+                std::cerr << "[Replay] 未知 start_mode: " << mode << "，按 replay 处理" << std::endl;
+            }
+        }
+        // 滞后统计周期 (秒)：实时模式默认 10，replay 模式默认关闭
+        lag_report_interval_ = start_mode_ == START_REPLAY ? 0 : 10;
+        if (config.find("lag_report_interval") != config.end()) {
+            lag_report_interval_ = std::stoi(config.at("lag_report_interval"));
+        }
+        // 节奏控制 (仅 replay 模式)：speed 按原始时间戳缩放 (1 = 实时, 10 = 十倍速, max = 不限速)；
+        // 未配置 speed 时 interval_ms > 0 表示固定的逐条发布间隔
+        double speed = 0.0;
+        uint64_t interval_us = 0;
+        uint64_t max_gap_ms = 5000;
+        if (config.find("speed") != config.end() && config.at("speed") != "max") {
+            speed = std::stod(config.at("speed"));
+        }
+        if (config.find("interval_ms") != config.end()) {
+            interval_us = static_cast<uint64_t>(std::stod(config.at("interval_ms")) * 1000);
+        }
+        if (config.find("max_gap_ms") != config.end()) {
+            max_gap_ms = std::stoull(config.at("max_gap_ms"));
+        }
+        if (start_mode_ == START_REPLAY && (speed > 0.0 || interval_us > 0)) {
+            pacer_.reset(new ReplayPacer(speed, speed > 0.0 ? 0 : interval_us, max_gap_ms));
+            std::cout << "[Replay] 节奏: " << (speed > 0.0 ? "speed=" + std::to_string(speed) + "x"
+                                                          : "interval=" + std::to_string(interval_us) + "us")
+                      << ", 空档上限 " << max_gap_ms << " ms" << std::endl;
+        }
+
+        // 模拟时钟：replay 模式默认开启，策略与定时器读取的是回放行情时间
+        bool sim_clock = (start_mode_ == START_REPLAY);
+        if (config.find("sim_clock") != config.end()) {
+            sim_clock = (config.at("sim_clock") == "true" || config.at("sim_clock") == "1");
+        }
+        if (sim_clock) {
+            prev_clock_ = &IClock::instance();
+            sim_clock_.reset(new SimClock());
+            IClock::set_instance(sim_clock_.get());
+        }
+
+        // 行情质量过滤 (去重/乱序/清洗/增量)，默认开启；关闭后直接零拷贝发布 mmap 中的原始记录
+        if (config.find("filter") != config.end()) {
+            filter_ = (config.at("filter") == "true" || config.at("filter") == "1");
+        }
+        // 批量发布：每批逐条发布 EVENT_MARKET_DATA 之后再发布一次 EVENT_TICK_BATCH (策略树 tick_batch 模式消费)，
+        // 批内 Tick 在批末才到达批量订阅者，适合全速回测；实时跟随时每批通常只有一两条
+        if (config.find("publish_batch") != config.end()) {
+            publish_batch_ = (config.at("publish_batch") == "true" || config.at("publish_batch") == "1");
+        }
+        if (filter_) {
+            normalizer_.reset(new TickNormalizer());
+            if (timer_svc) {
+                timer_svc->add_timer(60, [this]() {
+                    std::cout << "[Replay] Filter: " << normalizer_->stats_string() << std::endl;
+                });
+            }
+        }
+
         std::cout << "[Replay] 模块初始化完成。Mmap 基础路径: " << file_path_;
         if (max_capacity_ > 0) {
             std::cout << ", Max Capacity: " << max_capacity_ << " records (~" 
@@ -47,23 +138,40 @@ public:
     void stop() override {
         running_ = false;
         if (thread_.joinable()) thread_.join();
+        if (normalizer_) {
+            std::cout << "[Replay] Filter: " << normalizer_->stats_string() << std::endl;
+        }
         MarketSnapshot::instance().clear();
+        if (sim_clock_ && &IClock::instance() == sim_clock_.get()) {
+            IClock::set_instance(prev_clock_);
+        }
     }
 
 private:
     void run() {
         while (running_) {
             try {
-                // 尝试连接到 Mmap 通道
-                MmapReader<TickRecord> reader(file_path_, max_capacity_);
-                std::cout << "[Replay] 已连接到 Mmap 管道，开始回放..." << std::endl;
+                // 尝试连接到 Mmap 通道 (合并文件或相关分区)
+                PartitionedTickReader reader(resolve_sources(), max_capacity_);
+                std::cout << "[Replay] 已连接到 Mmap 管道 (" << reader.source_count() << " 个文件)，开始回放..." << std::endl;
+
+                if (start_mode_ == START_TAIL) {
+                    reader.seek_to_end();
+                    publish_status(REPLAY_LIVE, reader);
+                } else if (start_mode_ == START_CATCHUP) {
+                    std::cout << "[Replay] 追赶模式：待追赶 " << reader.lag() << " 条，追赶期抑制报单" << std::endl;
+                    publish_status(REPLAY_WARMUP, reader);
+                }
+                auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(lag_report_interval_);
+                auto next_idle = std::chrono::steady_clock::now();
+                uint32_t batches = 0;
 
                 auto start_t = std::chrono::high_resolution_clock::now();
                 bool perf_logged = false;
                 
                 // 批量读取缓冲区（可选优化）
-                constexpr size_t BATCH_SIZE = 16;
                 const TickRecord* batch_ptrs[BATCH_SIZE];
+                const TickRecord* published[BATCH_SIZE];
 
                 while (running_) {
                     // 批量读取模式：一次读取多条记录
@@ -75,11 +183,37 @@ private:
                         }
                         
                         // 处理批量数据
+                        size_t n = 0;
                         for (size_t i = 0; i < batch_count; ++i) {
-                            publish_tick(*batch_ptrs[i]);
+                            const TickRecord* rec = publish_tick(*batch_ptrs[i], n);
+                            if (rec) published[n++] = rec;
+                        }
+                        if (publish_batch_ && n > 0) {
+                            publish_tick_batch(published, n);
                         }
                         perf_logged = false;
+
+                        // 每 256 批检查一次是否到滞后统计时刻，避免每批读时钟
+                        if (lag_report_interval_ > 0 && (++batches & 255) == 0 &&
+                            std::chrono::steady_clock::now() >= next_report) {
+                            next_report += std::chrono::seconds(lag_report_interval_);
+                            publish_status(phase_, reader);
+                        }
                     } else {
+                        if (phase_ == REPLAY_WARMUP) {
+                            publish_status(REPLAY_LIVE, reader);  // 追平写者，切换为实时跟随
+                        }
+                        auto now = std::chrono::steady_clock::now();
+                        if (lag_report_interval_ > 0 && now >= next_report) {
+                            next_report += std::chrono::seconds(lag_report_interval_);
+                            publish_status(phase_, reader);
+                        }
+                        // 空闲通知：让挂起的定时任务 (如 K 线定时收线) 在行情线程上执行
+                        if (now >= next_idle) {
+                            next_idle = now + std::chrono::milliseconds(100);
+                            bus_->publish(EVENT_MD_IDLE, nullptr);
+                        }
+
                         if (debug_ &&tick_count_ > 0 && !perf_logged) {
                             auto end_t = std::chrono::high_resolution_clock::now();
                             auto cost_us = std::chrono::duration_cast<std::chrono::microseconds>(end_t - start_t).count();
@@ -104,7 +238,80 @@ private:
         }
     }
 
-    void publish_tick(const TickRecord& rec) {
+    // 读者滞后：写者游标 - 本地游标 (条)，以及本地时钟 - 最近发布 Tick 的交易所时间 (毫秒)
+    void publish_status(ReplayPhase phase, const PartitionedTickReader& reader) {
+        ReplayStatus st;
+        st.phase = phase;
+        st.ticks = tick_count_;
+        st.lag_records = reader.lag();
+        st.lag_ms = 0;
+        if (last_update_time_ != 0) {
+            int64_t local_ms = static_cast<int64_t>(IClock::instance().time_of_day_ms());
+            int64_t tick_ms = static_cast<int64_t>(TickNormalizer::session_ms(last_update_time_) + 18 * 3600000) % 86400000;
+            st.lag_ms = local_ms - tick_ms;
+            if (st.lag_ms < -43200000) st.lag_ms += 86400000;  // 跨午夜
+        }
+
+        if (phase != phase_) {
+            std::cout << "[Replay] 阶段切换: " << (phase == REPLAY_LIVE ? "LIVE" : "WARMUP")
+                      << " | Ticks: " << st.ticks << std::endl;
+        }
+        std::cout << "[Replay] Lag: records=" << st.lag_records << " wall_ms=" << st.lag_ms
+                  << " phase=" << (phase == REPLAY_LIVE ? "live" : "warmup") << std::endl;
+        phase_ = phase;
+        bus_->publish(EVENT_REPLAY_STATUS, &st);
+    }
+
+    // 需要打开的文件：无子集时优先合并文件，缺失则归并全部分区；有子集且存在分区清单时只取相关分区
+    std::vector<std::string> resolve_sources() const {
+        TickPartitioner part;
+        std::vector<std::string> keys;
+        if (!TickPartitioner::read_manifest(file_path_, part, keys)) {
+            return {file_path_};
+        }
+        std::vector<std::string> paths;
+        if (symbols_.empty()) {
+            if (access((file_path_ + ".meta").c_str(), F_OK) == 0) {
+                return {file_path_};
+            }
+            for (const auto& k : keys) paths.push_back(TickPartitioner::path(file_path_, k));
+            return paths;
+        }
+        for (const auto& sym : symbols_) {
+            std::string p = TickPartitioner::path(file_path_, part.key_for(sym.c_str()));
+            if (std::find(paths.begin(), paths.end(), p) == paths.end()) paths.push_back(p);
+        }
+        return paths;
+    }
+
+    bool wanted(const TickRecord& rec) const {
+        for (const auto& sym : symbols_) {
+            if (std::strncmp(rec.symbol, sym.c_str(), sizeof(rec.symbol)) == 0) return true;
+        }
+        return false;
+    }
+
+    // 发布一条行情，返回实际发布的记录 (被过滤时为 nullptr)；slot 为其在本批中的序号，归一化副本按序号存放，批内保持有效
+    const TickRecord* publish_tick(const TickRecord& raw, size_t slot) {
+        // 同一分区内的其他合约 (同品种或同哈希桶) 在此过滤
+        if (!symbols_.empty() && !wanted(raw)) return nullptr;
+
+        const TickRecord* src = &raw;
+        if (normalizer_) {
+            TickRecord& copy = filtered_[slot];
+            copy = raw;
+            if (normalizer_->process(copy) != TickNormalizer::PASS) return nullptr;
+            src = &copy;
+        }
+        const TickRecord& rec = *src;
+
+        if (pacer_) {
+            pacer_->wait(rec);
+        }
+        if (sim_clock_) {
+            sim_clock_->advance(rec.trading_day, rec.update_time);
+        }
+
         // 采样打印：前5条必打，之后每50条打一次
         // Debug mode: Use string comparison for robustness (no dependency on SymbolManager loading)
         if (debug_ && (tick_count_ < 5 || (tick_count_ % 10 == 0 && strcmp(rec.symbol, "au2606") == 0))) {
@@ -114,11 +321,28 @@ private:
                       << " | Last: " << rec.last_price << " | Vol: " << rec.volume << std::endl;
         }
         tick_count_++;
+        last_update_time_ = rec.update_time;
 
+        // 链路打点：实时跟随时带上录制器接收时刻，历史回放只计引擎内各段
+        bool live = start_mode_ != START_REPLAY && phase_ == REPLAY_LIVE;
+        LatencyTrace::begin_tick(rec, live ? rec.recv_ns : 0);
         MarketSnapshot::instance().update(rec);
         bus_->publish(EVENT_MARKET_DATA, const_cast<TickRecord*>(&rec));
+        LatencyTrace::end_tick();
+        return src;
+    }
+
+    // 批量发布与逐条发布同样开启链路：以批内最早的 Tick 为行情段，批量攒批的等待计入 md_recv -> md_in
+    void publish_tick_batch(const TickRecord* const* ticks, size_t n) {
+        bool live = start_mode_ != START_REPLAY && phase_ == REPLAY_LIVE;
+        LatencyTrace::begin_tick(*ticks[0], live ? ticks[0]->recv_ns : 0);
+        TickBatch batch{ticks, n};
+        bus_->publish(EVENT_TICK_BATCH, &batch);
+        LatencyTrace::end_tick();
     }
 
+    static constexpr size_t BATCH_SIZE = 16;
+
     EventBus* bus_ = nullptr;
     std::string file_path_;
     std::thread thread_;
@@ -126,6 +350,26 @@ private:
     bool debug_ = false;
     uint64_t tick_count_ = 0; // 计数器
     uint64_t max_capacity_ = 0; // 最大容量（0 表示使用 meta 文件中的 capacity）
+
+    std::vector<std::string> symbols_;  // 空表示全部合约
+
+    enum StartMode {
+        START_REPLAY = 0,
+        START_TAIL,
+        START_CATCHUP
+    };
+    StartMode start_mode_ = START_REPLAY;
+    std::unique_ptr<ReplayPacer> pacer_;
+    std::unique_ptr<SimClock> sim_clock_;
+    IClock* prev_clock_ = nullptr;  // 安装模拟时钟前的引擎时钟，stop 时恢复
+    ReplayPhase phase_ = REPLAY_LIVE;
+    int lag_report_interval_ = 0;
+    uint64_t last_update_time_ = 0;
+
+    bool filter_ = true;
+    bool publish_batch_ = false;
+    std::unique_ptr<TickNormalizer> normalizer_;
+    TickRecord filtered_[BATCH_SIZE]; // 归一化后的副本 (mmap 只读)，每批按序号复用
 };
 
 EXPORT_MODULE(ReplayModule)
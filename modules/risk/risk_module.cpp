@@ -1,5 +1,5 @@
 #include "../../include/framework.h"
-#include <chrono>
+#include "../../core/include/latency_trace.h"
 #include <iostream>
 #include <vector>
 #include <mutex>
@@ -14,7 +14,14 @@ public:
             max_orders_per_sec_ = std::stoi(config.at("max_orders_per_second"));
         }
 
-        std::cout << "[Risk] Initialized. Max Orders/Sec: " << max_orders_per_sec_ << std::endl;
+        // 放行后的去向：send 直接发布 EVENT_ORDER_SEND (无 OrderManager 时)；
+        // checked 发布 EVENT_ORDER_CHECKED，由 OrderManager (input: checked) 装饰后发出，链路为 风控 -> OrderManager -> 柜台
+        if (config.count("output")) {
+            forward_event_ = config.at("output") == "checked" ? EVENT_ORDER_CHECKED : EVENT_ORDER_SEND;
+        }
+
+        std::cout << "[Risk] Initialized. Max Orders/Sec: " << max_orders_per_sec_
+                  << " Output: " << (forward_event_ == EVENT_ORDER_CHECKED ? "checked" : "send") << std::endl;
 
         // 订阅原始报单请求
         bus_->subscribe(EVENT_ORDER_REQ, [this](void* d) {
@@ -26,11 +33,12 @@ private:
     void checkRisk(OrderReq* req) {
         std::lock_guard<std::mutex> lock(mtx_);
         
-        auto now = std::chrono::steady_clock::now();
+        // 引擎时钟：回放时按行情时间计频率，回测与实盘的限频口径一致
+        uint64_t now = IClock::instance().now_ns();
         
-        // 1. 清理超过 1 秒的历史记录
-        while (!order_timestamps_.empty() && 
-               std::chrono::duration_cast<std::chrono::seconds>(now - order_timestamps_.front()).count() >= 1) {
+        // 1. 清理超过 1 秒的历史记录 (时钟被替换或回拨时 now 可能早于记录，保留不清)
+        while (!order_timestamps_.empty() && now >= order_timestamps_.front() &&
+               now - order_timestamps_.front() >= 1000000000ULL) {
             order_timestamps_.erase(order_timestamps_.begin());
         }
 
@@ -44,13 +52,15 @@ private:
         // 3. 通过风控，记录时间戳并转发
         order_timestamps_.push_back(now);
         
-        // 转发到实际发送事件
-        bus_->publish(EVENT_ORDER_SEND, req);
+        // 转发到下一阶段
+        LatencyTrace::stamp(LAT_RISK);
+        bus_->publish(forward_event_, req);
     }
 
     EventBus* bus_;
     int max_orders_per_sec_ = 5;
-    std::vector<std::chrono::steady_clock::time_point> order_timestamps_;
+    EventType forward_event_ = EVENT_ORDER_SEND;
+    std::vector<uint64_t> order_timestamps_;  // 通过风控的报单时刻 (纳秒)
     std::mutex mtx_;
 };
 
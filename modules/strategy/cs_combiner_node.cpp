@@ -1,4 +1,6 @@
 #include "../../include/framework.h"
+#include "cross_section.h"
+#include "kline_store.h"
 #include <algorithm>
 #include <cmath>
 #include <cstring>
@@ -14,11 +16,6 @@
 namespace {
 constexpr double kEps = 1e-9;
 
-struct SymbolState {
-    std::vector<double> values;
-    std::vector<unsigned char> seen;
-};
-
 bool parse_symbols_file(const std::string& path, std::vector<std::string>* symbols) {
     std::ifstream in(path);
     if (!in.is_open()) return false;
@@ -41,9 +38,9 @@ bool parse_symbols_file(const std::string& path, std::vector<std::string>* symbo
 /**
  * CrossSectionCombinerNode: 多因子截面组合节点
  * - 接收因子信号 (SignalRecord)
- * - 按品种聚合为因子矩阵
- * - 在 1 分钟 K线触发时做截面 z-score + 线性组合
- * - 根据排序输出目标仓位 (净暴露 0)
+ * - 按品种写入 CrossSection 因子矩阵 (合约 x 因子 SoA，槽位在 init 时按品种池分配)
+ * - 每根 1 分钟 K线经 BarBarrier 只触发一次：截面 z-score + 线性组合 (向量化)
+ * - nth_element 选出头尾 k 个，输出目标仓位 (净暴露 0)
  */
 class CrossSectionCombinerNode : public IStrategyNode {
 public:
@@ -59,6 +56,9 @@ public:
 
         load_weights_from_yaml(config);
         load_universe();
+
+        matrix_.init(factor_names_.size(), std::max<size_t>(universe_.size(), 64));
+        for (const auto& sym : universe_) add_slot(sym);
     }
 
     void onTick(const TickRecord* tick) override {
@@ -67,21 +67,28 @@ public:
 
     void onKline(const KlineRecord* kline) override {
         if (kline->interval != K_1M) return;
-        rebalance();
+        // 同一根 Bar 各合约的 K 线陆续到达，截面到齐 (或下一根开始) 时只重平一次
+        auto it = slot_of_.find(kline->symbol);
+        int slot = it != slot_of_.end() ? static_cast<int>(it->second) : -1;
+        if (barrier_.arrive(KlineStore::key(kline->trading_day, kline->start_time), slot)) {
+            rebalance();
+        }
     }
 
     void onSignal(const SignalRecord* signal) override {
         auto it = factor_index_.find(signal->factor_name);
         if (it == factor_index_.end()) return;
 
-        const int idx = it->second;
-        SymbolState& st = symbol_state_[signal->symbol];
-        if (st.values.empty()) {
-            st.values.assign(factor_names_.size(), 0.0);
-            st.seen.assign(factor_names_.size(), 0);
+        uint32_t slot;
+        auto st = slot_of_.find(signal->symbol);
+        if (st != slot_of_.end()) {
+            slot = st->second;
+        } else {
+            // 配置了品种池时只接收池内品种
+            if (!universe_.empty()) return;
+            slot = add_slot(signal->symbol);
         }
-        st.values[idx] = signal->value;
-        st.seen[idx] = 1;
+        matrix_.set(slot, static_cast<size_t>(it->second), signal->value);
     }
 
     void onOrderUpdate(const OrderRtn* rtn) override {
@@ -96,7 +103,8 @@ public:
 
         order_traded_[order_ref] = rtn->volume_traded;
         int sign = (rtn->direction == 'B') ? 1 : -1;
-        position_[rtn->symbol] += sign * delta;
+        auto st = slot_of_.find(rtn->symbol);
+        if (st != slot_of_.end()) position_[st->second] += sign * delta;
     }
 
 private:
@@ -110,6 +118,10 @@ private:
             for (auto it = node["weights"].begin(); it != node["weights"].end(); ++it) {
                 std::string fname = it->first.as<std::string>();
                 double w = it->second.as<double>();
+                if (factor_names_.size() >= CrossSection::MAX_FACTORS) {
+                    ctx_->log(("因子数超过上限，忽略: " + fname).c_str());
+                    continue;
+                }
                 factor_names_.push_back(fname);
                 factor_weights_.push_back(w);
                 factor_index_[fname] = idx++;
@@ -128,92 +140,55 @@ private:
         }
     }
 
-    bool symbol_ready(const SymbolState& st) const {
-        if (st.seen.size() != factor_names_.size()) return false;
-        for (size_t i = 0; i < st.seen.size(); ++i) {
-            if (st.seen[i] == 0) return false;
-        }
-        return true;
+    uint32_t add_slot(const std::string& symbol) {
+        auto it = slot_of_.find(symbol);
+        if (it != slot_of_.end()) return it->second;
+        uint32_t slot = static_cast<uint32_t>(matrix_.add_slot());
+        slot_of_.emplace(symbol, slot);
+        slot_symbol_.push_back(symbol);
+        position_.push_back(0);
+        target_.push_back(0);
+        scores_.resize(slot_symbol_.size(), 0.0);
+        ready_.reserve(slot_symbol_.size());
+        ranked_.reserve(slot_symbol_.size());
+        barrier_.resize(slot_symbol_.size());
+        return slot;
     }
 
     void rebalance() {
         if (factor_names_.empty()) return;
 
-        // Collect symbols that are ready.
-        std::vector<std::string> symbols;
-        symbols.reserve(symbol_state_.size());
-        if (!universe_.empty()) {
-            for (const auto& sym : universe_) {
-                auto it = symbol_state_.find(sym);
-                if (it != symbol_state_.end() && symbol_ready(it->second)) symbols.push_back(sym);
-            }
-        } else {
-            for (const auto& kv : symbol_state_) {
-                if (symbol_ready(kv.second)) symbols.push_back(kv.first);
-            }
-        }
-        if (symbols.size() < 2) return;
+        const size_t n = matrix_.score(factor_weights_.data(), scores_.data(), kEps);
+        if (n < 2) return;
 
-        const size_t n = symbols.size();
-        const size_t k = factor_names_.size();
-
-        // Precompute mean/std for each factor across symbols.
-        std::vector<double> mean(k, 0.0);
-        std::vector<double> var(k, 0.0);
-        for (size_t i = 0; i < k; ++i) {
-            for (const auto& sym : symbols) {
-                mean[i] += symbol_state_[sym].values[i];
-            }
-            mean[i] /= static_cast<double>(n);
-            for (const auto& sym : symbols) {
-                double diff = symbol_state_[sym].values[i] - mean[i];
-                var[i] += diff * diff;
-            }
-            var[i] /= static_cast<double>(n);
+        // 就绪合约按槽位 (品种池) 顺序
+        ready_.clear();
+        for (uint32_t s = 0; s < matrix_.slots(); ++s) {
+            if (matrix_.ready(s)) ready_.push_back(s);
         }
 
-        std::vector<std::pair<std::string, double>> scores;
-        scores.reserve(n);
-        for (const auto& sym : symbols) {
-            const auto& vals = symbol_state_[sym].values;
-            double score = 0.0;
-            for (size_t i = 0; i < k; ++i) {
-                double stdv = std::sqrt(var[i]);
-                double z = (stdv > kEps) ? (vals[i] - mean[i]) / stdv : 0.0;
-                score += z * factor_weights_[i];
-            }
-            scores.emplace_back(sym, score);
-        }
-
-        std::sort(scores.begin(), scores.end(),
-                  [](const auto& a, const auto& b) { return a.second > b.second; });
-
         int top_n = top_n_;
         int bottom_n = bottom_n_;
         if (top_n <= 0) top_n = static_cast<int>(std::round(top_pct_ * static_cast<double>(n)));
         if (bottom_n <= 0) bottom_n = static_cast<int>(std::round(bottom_pct_ * static_cast<double>(n)));
         if (top_n <= 0 || bottom_n <= 0) return;
-        int kside = std::min(top_n, bottom_n);
-        if (kside <= 0) return;
-
-        std::unordered_map<std::string, int> targets;
-        targets.reserve(n);
-        for (int i = 0; i < kside; ++i) {
-            targets[scores[i].first] = base_volume_; // long
-            const auto& sym = scores[n - 1 - i].first;
-            targets[sym] = -base_volume_; // short
+        // 多空两侧不重叠
+        size_t kside = std::min<size_t>(static_cast<size_t>(std::min(top_n, bottom_n)), n / 2);
+        if (kside == 0) return;
+
+        // 头尾 k 个只需部分选择，不必全排序
+        ranked_.assign(ready_.begin(), ready_.end());
+        CrossSection::select_extremes(ranked_, scores_.data(), kside);
+        for (uint32_t s : ready_) target_[s] = 0;
+        for (size_t i = 0; i < kside; ++i) {
+            target_[ranked_[i]] = base_volume_;             // long
+            target_[ranked_[n - 1 - i]] = -base_volume_;    // short
         }
 
-        for (const auto& sym : symbols) {
-            int target = 0;
-            auto it = targets.find(sym);
-            if (it != targets.end()) target = it->second;
-            int current = 0;
-            auto itp = position_.find(sym);
-            if (itp != position_.end()) current = itp->second;
-            int delta = target - current;
+        for (uint32_t s : ready_) {
+            int delta = target_[s] - position_[s];
             if (delta == 0) continue;
-            send_order(sym.c_str(), delta);
+            send_order(slot_symbol_[s].c_str(), delta);
         }
 
         if (debug_) {
@@ -246,10 +221,19 @@ private:
     std::vector<double> factor_weights_;
     std::unordered_map<std::string, int> factor_index_;
 
-    std::unordered_map<std::string, SymbolState> symbol_state_;
     std::vector<std::string> universe_;
 
-    std::unordered_map<std::string, int> position_;
+    // 槽位 = CrossSection 中的合约列；以下按槽位平铺
+    CrossSection matrix_;
+    BarBarrier barrier_;
+    std::unordered_map<std::string, uint32_t> slot_of_;
+    std::vector<std::string> slot_symbol_;
+    std::vector<double> scores_;
+    std::vector<int> target_;
+    std::vector<int> position_;
+    std::vector<uint32_t> ready_;
+    std::vector<uint32_t> ranked_;
+
     std::unordered_map<std::string, int> order_traded_;
 };
 
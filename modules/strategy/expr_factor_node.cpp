@@ -0,0 +1,120 @@
+#include "../../include/framework.h"
+#include "expr_factor.h"
+#include "symbol_manager.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+/**
+ * ExprFactorNode: 表达式因子节点
+ * 职责：把 params 中的表达式编译为 ExprProgram 字节码 (见 core/include/expr_factor.h)，逐 Tick 求值并输出信号，
+ *       新增因子只需改配置，无需编写 / 编译新的 .so。
+ *
+ * 配置：
+ *   factors:                  # 因子名 -> 表达式，按配置顺序输出；各因子的公共子表达式只算一次
+ *     EmaSpread: "ema(mid,20) - ema(mid,100)"
+ *     L1Imb: "(bid_vol[0]-ask_vol[0])/(bid_vol[0]+ask_vol[0])"
+ *   symbols: [rb2605, au2606] # 可选，只计算这些合约 (经 subscribe_symbols 路由)
+ * 单因子也可写成 name + expr 两个标量参数。结果为 NaN / Inf (如窗口未满、分母为 0) 时不发信号。
+ */
+class ExprFactorNode : public IStrategyNode {
+public:
+    void init(StrategyContext* ctx, const ConfigMap& config) override {
+        ctx_ = ctx;
+        if (config.find("debug") != config.end()) {
+            debug_ = (config.at("debug") == "true");
+        }
+
+        std::vector<std::pair<std::string, std::string>> factors;
+        std::vector<std::string> symbols;
+        if (config.find("_yaml") != config.end()) {
+            try {
+                YAML::Node node = YAML::Load(config.at("_yaml"));
+                if (node["factors"] && node["factors"].IsMap()) {
+                    for (auto it = node["factors"].begin(); it != node["factors"].end(); ++it) {
+                        factors.emplace_back(it->first.as<std::string>(), it->second.as<std::string>());
+                    }
+                }
+                if (node["symbols"] && node["symbols"].IsSequence()) {
+                    for (const auto& s : node["symbols"]) symbols.push_back(s.as<std::string>());
+                }
+            } catch (const YAML::Exception& e) {
+                std::cerr << "[ExprFactor] 参数解析失败: " << e.what() << std::endl;
+            }
+        }
+        if (config.find("expr") != config.end()) {
+            factors.emplace_back(config.count("name") ? config.at("name") : ctx_->strategy_id, config.at("expr"));
+        }
+        if (factors.empty()) {
+            std::cerr << "[ExprFactor] " << ctx_->strategy_id << " 未配置 factors / expr" << std::endl;
+            return;
+        }
+
+        try {
+            program_ = std::make_unique<ExprProgram>(factors);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "[ExprFactor] 编译失败: " << e.what() << std::endl;
+            return;
+        }
+        values_.resize(program_->factor_count());
+
+        if (!symbols.empty() && ctx_->subscribe_symbols) ctx_->subscribe_symbols(symbols);
+
+        if (debug_) {
+            std::cout << "[ExprFactor] " << ctx_->strategy_id << ": " << program_->factor_count() << " 个因子, "
+                      << program_->instr_count() << " 条指令, " << program_->register_count() << " 个寄存器\n"
+                      << program_->dump();
+        }
+    }
+
+    void onTick(const TickRecord* tick) override {
+        if (!program_) return;
+        ExprState& s = state(*tick);
+        program_->eval(*tick, s, values_.data());
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            if (!std::isfinite(values_[i])) continue;
+            SignalRecord sig;
+            std::memset(&sig, 0, sizeof(sig));
+            std::memcpy(sig.symbol, tick->symbol, sizeof(sig.symbol));
+            std::strncpy(sig.factor_name, program_->factor_name(i).c_str(), sizeof(sig.factor_name)-1);
+            sig.value = values_[i];
+            sig.timestamp = tick->update_time;
+            ctx_->send_signal(sig);
+        }
+    }
+
+    void onKline(const KlineRecord* kline) override {}
+    void onSignal(const SignalRecord* signal) override {}
+    void onOrderUpdate(const OrderRtn* rtn) override {}
+
+private:
+    // 合约状态：合约表内按稠密下标平铺，表外合约按名称查找
+    ExprState& state(const TickRecord& tick) {
+        int row = SymbolManager::instance().get_index(tick.symbol_id);
+        if (row >= 0) {
+            if (static_cast<size_t>(row) >= states_.size()) states_.resize(row + 1);
+            auto& s = states_[row];
+            if (!s) s = std::make_unique<ExprState>(program_->make_state());
+            return *s;
+        }
+        auto it = others_.find(tick.symbol);
+        if (it == others_.end()) it = others_.emplace(tick.symbol, program_->make_state()).first;
+        return it->second;
+    }
+
+    StrategyContext* ctx_;
+    bool debug_ = false;
+    std::unique_ptr<ExprProgram> program_;
+    std::vector<double> values_;
+    std::vector<std::unique_ptr<ExprState>> states_;
+    std::unordered_map<std::string, ExprState> others_;
+};
+
+EXPORT_STRATEGY(ExprFactorNode)
@@ -1,10 +1,17 @@
 #include "../../include/framework.h"
+#include "../../core/include/book_features.h"
 #include <iostream>
 #include <cstring>
+#include <sstream>
+#include <memory>
+#include <vector>
 
 /**
  * ImbalanceNode: 挂单失衡因子 (Orderbook Imbalance)
  * 职责：计算买一卖一的挂单量差异，反映瞬时买卖压力
+ * 配置 levels > 1 时使用 BookFeatureCalc 计算多档加权失衡度 (weights 为逗号分隔的各档权重)，
+ * emit_features=true 时额外输出 Microprice / WeightedSpread 信号。
+ * 批量行情 (onTickBatch) 下多档特征按批一次向量化计算，信号顺序与逐条处理一致。
  */
 class ImbalanceNode : public IStrategyNode {
 public:
@@ -13,10 +20,31 @@ public:
         if (config.find("debug") != config.end()) {
             debug_ = (config.at("debug") == "true");
         }
+        if (config.find("levels") != config.end()) {
+            levels_ = std::stoi(config.at("levels"));
+        }
+        if (config.find("emit_features") != config.end()) {
+            emit_features_ = (config.at("emit_features") == "true");
+        }
+        if (levels_ > 1 || emit_features_) {
+            std::vector<double> weights;
+            if (config.find("weights") != config.end()) {
+                std::stringstream ss(config.at("weights"));
+                std::string item;
+                while (std::getline(ss, item, ',')) weights.push_back(std::stod(item));
+            }
+            if (!weights.empty()) weights.resize(BookFeatureCalc::MAX_LEVELS, 0.0);
+            calc_.reset(new BookFeatureCalc(levels_, weights.empty() ? nullptr : weights.data()));
+        }
         if (debug_) ctx_->log("挂单失衡因子节点初始化完成。");
     }
 
     void onTick(const TickRecord* tick) override {
+        if (calc_) {
+            onTickMultiLevel(tick);
+            return;
+        }
+
         double bid_vol = tick->bid_volume[0];
         double ask_vol = tick->ask_volume[0];
         
@@ -34,13 +62,53 @@ public:
         ctx_->send_signal(sig);
     }
 
+    void onTickBatch(const TickRecord* const* ticks, size_t count) override {
+        if (!calc_) {
+            IStrategyNode::onTickBatch(ticks, count);
+            return;
+        }
+        if (features_.size() < count) features_.resize(count);
+        calc_->compute_batch(ticks, count, features_.data());
+        for (size_t i = 0; i < count; ++i) emit_features(ticks[i], features_[i]);
+    }
+
     void onKline(const KlineRecord* kline) override {}
     void onSignal(const SignalRecord* signal) override {}
     void onOrderUpdate(const OrderRtn* rtn) override {}
 
 private:
+    void onTickMultiLevel(const TickRecord* tick) {
+        BookFeatures f;
+        calc_->compute(*tick, f);
+        emit_features(tick, f);
+    }
+
+    void emit_features(const TickRecord* tick, const BookFeatures& f) {
+        if (f.bid_depth + f.ask_depth == 0) return;
+
+        emit(tick, "Imbalance", f.imbalance);
+        if (emit_features_ && f.mid > 0) {
+            emit(tick, "Microprice", f.microprice);
+            emit(tick, "WeightedSpread", f.weighted_spread);
+        }
+    }
+
+    void emit(const TickRecord* tick, const char* name, double value) {
+        SignalRecord sig;
+        std::memset(&sig, 0, sizeof(sig));
+        std::strncpy(sig.symbol, tick->symbol, sizeof(sig.symbol)-1);
+        std::strncpy(sig.factor_name, name, sizeof(sig.factor_name)-1);
+        sig.value = value;
+        sig.timestamp = tick->update_time;
+        ctx_->send_signal(sig);
+    }
+
     StrategyContext* ctx_;
     bool debug_ = false;
+    int levels_ = 1;
+    bool emit_features_ = false;
+    std::unique_ptr<BookFeatureCalc> calc_;
+    std::vector<BookFeatures> features_;  // onTickBatch 的批量计算结果
 };
 
 EXPORT_STRATEGY(ImbalanceNode)
@@ -0,0 +1,49 @@
+#include "../../include/framework.h"
+#include <cstring>
+#include <string>
+
+/**
+ * OrderPingerNode: 固定节奏报单节点 (链路基准用)
+ * 职责：每 every_n 个 Tick 以最新价报一手，买卖交替，使 tick-to-order 链路在任意行情数据上都有稳定的报单流量。
+ * 可选 symbol 只对单个合约计数；不维护持仓，不用于实盘。
+ */
+class OrderPingerNode : public IStrategyNode {
+public:
+    void init(StrategyContext* ctx, const ConfigMap& config) override {
+        ctx_ = ctx;
+        if (config.find("every_n") != config.end()) every_n_ = std::stoul(config.at("every_n"));
+        if (config.find("symbol") != config.end()) symbol_ = config.at("symbol");
+        if (config.find("volume") != config.end()) volume_ = std::stoi(config.at("volume"));
+        if (every_n_ == 0) every_n_ = 1;
+        if (!symbol_.empty() && ctx_->subscribe_symbols) ctx_->subscribe_symbols({symbol_});
+    }
+
+    void onTick(const TickRecord* tick) override {
+        if (!symbol_.empty() && symbol_ != tick->symbol) return;
+        if (++ticks_ % every_n_ != 0) return;
+
+        OrderReq req;
+        std::memset(&req, 0, sizeof(req));
+        std::strncpy(req.symbol, tick->symbol, sizeof(req.symbol) - 1);
+        req.symbol_id = tick->symbol_id;
+        req.direction = (++orders_ & 1) ? 'B' : 'S';
+        req.offset_flag = 'O';
+        req.price = tick->last_price;
+        req.volume = volume_;
+        ctx_->send_order(req);
+    }
+
+    void onKline(const KlineRecord* kline) override {}
+    void onSignal(const SignalRecord* signal) override {}
+    void onOrderUpdate(const OrderRtn* rtn) override {}
+
+private:
+    StrategyContext* ctx_ = nullptr;
+    uint64_t every_n_ = 100;
+    std::string symbol_;
+    int volume_ = 1;
+    uint64_t ticks_ = 0;
+    uint64_t orders_ = 0;
+};
+
+EXPORT_STRATEGY(OrderPingerNode)
@@ -1,4 +1,5 @@
 #include "../../include/framework.h"
+#include "../../core/include/latency_trace.h"
 #include "../../core/include/symbol_manager.h"
 #include <cstring>
 #include <iostream>
@@ -26,9 +27,15 @@ public:
 
         // 订阅行情
         bus_->subscribe(EVENT_MARKET_DATA, [this](void* d) {
+            LatencyTrace::stamp(LAT_STRATEGY);
             this->onTick(static_cast<TickRecord*>(d));
         });
 
+        // 回放追赶期不发单
+        bus_->subscribe(EVENT_REPLAY_STATUS, [this](void* d) {
+            warmup_ = static_cast<ReplayStatus*>(d)->phase == REPLAY_WARMUP;
+        });
+
         // 订阅持仓更新
         bus_->subscribe(EVENT_POS_UPDATE, [this](void* d) {
             this->onPosUpdate(static_cast<PositionDetail*>(d));
@@ -79,6 +86,7 @@ public:
     }
 
     void sendOrder(const char* symbol, char dir, char offset, double price) {
+        if (warmup_) return;
         OrderReq req;
         req.symbol_id = target_id_;
         strncpy(req.symbol, symbol, 31);
@@ -96,6 +104,8 @@ private:
     double buy_thresh_;
     double sell_thresh_;
     
+    bool warmup_ = false;
+
     // 本地持仓缓存
     PositionDetail current_pos_ = {0}; 
 };
@@ -1,8 +1,5 @@
 #include "../../include/framework.h"
-#include <iostream>
-#include <vector>
-#include <numeric>
-#include <deque>
+#include "rolling.h"
 #include <cstring>
 #include <unordered_map>
 #include <string>
@@ -30,24 +27,20 @@ public:
     }
 
     void onTick(const TickRecord* tick) override {
-        std::string symbol = tick->symbol;
-        
-        // 获取或创建该品种的 RingBuffer (首次创建会分配，之后复用)
+        // 每个品种一个 RollingSum (首次创建会分配窗口，之后复用)
         // 注意：这里仍然有一次 map 查找，但在 HFT 中通常会对 Symbol 预先建立索引
-        // 为了演示方便，我们先保留 map，但优化内部结构
-        if (price_history_.find(symbol) == price_history_.end()) {
-            price_history_.emplace(symbol, RingBuffer(window_size_));
+        auto it = price_history_.find(tick->symbol);
+        if (it == price_history_.end()) {
+            it = price_history_.emplace(tick->symbol, RollingSum(window_size_)).first;
         }
-        
-        RingBuffer& buf = price_history_.at(symbol);
-        
-        // O(1) 增量更新
-        buf.add(tick->last_price);
+        RollingSum& sum = it->second;
 
-        if (!buf.is_full()) return;
+        // O(1) 增量更新 (补偿求和，长时间运行不漂移)
+        sum.push(tick->last_price);
+        if (!sum.full()) return;
+
+        double sma = sum.mean();
 
-        double sma = buf.sum() / window_size_;
-        
         double raw_diff = (tick->last_price - sma) / sma; 
         double normalized_sig = raw_diff * multiplier_;
 
@@ -68,44 +61,10 @@ public:
     void onOrderUpdate(const OrderRtn* rtn) override {}
 
 private:
-    // 高性能环形缓冲区
-    struct RingBuffer {
-        std::vector<double> data;
-        size_t size = 0;
-        size_t capacity = 0;
-        size_t cursor = 0; // 指向下一个写入位置
-        double current_sum = 0.0;
-
-        RingBuffer(size_t cap) : capacity(cap) {
-            data.resize(cap, 0.0);
-        }
-
-        void add(double val) {
-            // 减去将被覆盖的旧值
-            double old_val = data[cursor];
-            
-            // 写入新值
-            data[cursor] = val;
-            
-            // 更新和 (O(1))
-            // 注意：浮点数累加可能有精度误差，但在 HFT 短周期内可接受
-            // 严谨做法是每隔 N 次重算一次，这里追求极致速度忽略之
-            current_sum = current_sum - old_val + val;
-
-            // 移动游标
-            cursor++;
-            if (cursor >= capacity) cursor = 0;
-            if (size < capacity) size++;
-        }
-
-        bool is_full() const { return size >= capacity; }
-        double sum() const { return current_sum; }
-    };
-
     StrategyContext* ctx_;
     size_t window_size_ = 20;
     double multiplier_ = 1000.0;
-    std::unordered_map<std::string, RingBuffer> price_history_;
+    std::unordered_map<std::string, RollingSum> price_history_;
     bool debug_ = false;
 };
 
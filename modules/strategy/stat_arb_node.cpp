@@ -1,8 +1,5 @@
 #include "../../include/framework.h"
-#include <deque>
-#include <numeric>
-#include <cmath>
-#include <algorithm>
+#include "rolling.h"
 #include <cstring>
 #include <string>
 
@@ -20,6 +17,8 @@ public:
         if (config.find("window_size") != config.end()) window_size_ = std::stoul(config.at("window_size"));
         if (config.find("sigma") != config.end()) sigma_threshold_ = std::stod(config.at("sigma"));
         if (config.find("debug") != config.end()) debug_ = (config.at("debug") == "true");
+        stats_.reset(window_size_);
+        if (ctx_->subscribe_symbols) ctx_->subscribe_symbols({symbol_});  // 策略树只投递该合约的行情
 
         if (debug_) {
             std::string msg = "StatArbNode 初始化: 合约=" + symbol_ + 
@@ -30,27 +29,17 @@ public:
     }
 
     void onTick(const TickRecord* tick) override {
-        // 过滤合约
+        // 过滤合约 (已订阅时树只投递本合约，此处为未订阅宿主兜底)
         if (symbol_ != tick->symbol) return;
 
-        // 更新价格序列
-        prices_.push_back(tick->last_price);
-        if (prices_.size() > window_size_) {
-            prices_.pop_front();
-        }
+        // 更新滚动均值/方差 (O(1)，不再每笔遍历窗口)
+        stats_.push(tick->last_price);
 
         // 窗口未满不执行
-        if (prices_.size() < window_size_) return;
-
-        // 计算均值和标准差
-        double sum = std::accumulate(prices_.begin(), prices_.end(), 0.0);
-        double mean = sum / prices_.size();
+        if (!stats_.full()) return;
 
-        double sq_sum = 0;
-        for (double p : prices_) {
-            sq_sum += (p - mean) * (p - mean);
-        }
-        double stdev = std::sqrt(sq_sum / prices_.size());
+        double mean = stats_.mean();
+        double stdev = stats_.stdev();
 
         if (stdev < 0.00001) return; // 防止除零
 
@@ -127,7 +116,7 @@ private:
     double sigma_threshold_ = 4.0;
     bool debug_ = false;
 
-    std::deque<double> prices_;
+    RollingStats stats_{60};
     int pos_ = 0; 
 };
 
@@ -1,5 +1,12 @@
 #include "../../include/framework.h"
+#include "../../core/include/latency_trace.h"
+#include "../../core/include/fork_join_pool.h"
+#include "../../core/include/order_book.h"
+#include "../../core/include/symbol_manager.h"
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <dlfcn.h>
@@ -10,8 +17,28 @@
 struct StrategyNodeHandle {
     void* lib_handle;
     std::unique_ptr<IStrategyNode> node;
+    std::unique_ptr<StrategyContext> ctx;
     std::string id;
 
+    // 依赖声明：未配置 inputs 时接收全部因子 (广播)，未配置 outputs 时可能输出任意因子
+    bool consume_all = true;
+    bool emit_any = true;
+    std::vector<int> inputs;                           // 输入因子 ID
+    std::vector<std::pair<std::string, int>> outputs;  // 输出因子名 -> ID (含运行期遇到的未声明因子)
+    size_t last_output = 0;                            // 上次命中的输出下标，单因子节点首次比较即命中
+    int level = 0;
+
+    // 合约订阅：未调用 subscribe_symbols 时接收全部合约；订阅空列表则不接收行情 (纯信号节点)
+    bool all_symbols = true;
+    bool unroutable = false;                           // 订阅了合约表之外的合约，只能全量接收
+    std::vector<int> symbol_rows;                      // 订阅合约的 SymbolManager 稠密下标 (升序)
+
+    std::vector<const TickRecord*> tick_batch;         // tick_batch 模式：本批中路由到该节点的行情 (全合约节点直接用整批)
+
+    // 并行层内的报单 / 信号暂存，层结束后由调度线程按节点顺序发出
+    std::vector<OrderReq> pending_orders;
+    std::vector<SignalRecord> pending_signals;
+
     ~StrategyNodeHandle() {
         node.reset();
         if (lib_handle) dlclose(lib_handle);
@@ -19,18 +46,31 @@ struct StrategyNodeHandle {
 };
 
 /**
- * StrategyTreeModule: 纯粹的二级插件容器
- * 功能：解析配置，加载叶子节点，透传所有总线事件（Tick/Kline/Signal/Rtn）
+ * StrategyTreeModule: 二级插件容器 + 因子 DAG 调度
+ * 功能：解析配置，加载叶子节点；按节点声明的 inputs / outputs 因子建立依赖图，
+ *       每条行情按拓扑层次依次驱动节点 (上游因子先于消费者更新)，信号按整数因子 ID 只投递给声明的消费者。
+ *       workers > 0 时同一层内互不依赖的节点在线程池上并行执行。
+ *       节点经 subscribe_symbols 声明合约后，行情按 合约 -> 节点列表 路由表只投递给订阅者。
+ *       tick_batch 打开时改为消费 EVENT_TICK_BATCH，每批每个节点只调用一次 onTickBatch。
  */
 class StrategyTreeModule : public IModule {
 public:
     void init(EventBus* bus, const ConfigMap& config, ITimerService* timer_svc = nullptr) override {
         bus_ = bus;
-        
+
         // 是否将信号同步发布到全局总线 (默认开启，供录制器使用)
         if (config.find("publish_signals") != config.end()) {
             publish_signals_ = (config.at("publish_signals") == "true");
         }
+        size_t workers = 0;
+        if (config.find("workers") != config.end()) {
+            workers = std::stoul(config.at("workers"));
+        }
+        // 批量行情：需 Replay 打开 publish_batch
+        bool tick_batch = false;
+        if (config.find("tick_batch") != config.end()) {
+            tick_batch = (config.at("tick_batch") == "true");
+        }
 
         // 兼容性检查：优先使用 _yaml
         std::string yaml_content;
@@ -57,13 +97,13 @@ public:
 
             std::string id = node_cfg["id"].as<std::string>();
             std::string lib_path = node_cfg["library"].as<std::string>();
-            
+
             void* handle = dlopen(lib_path.c_str(), RTLD_LAZY);
             if (!handle) {
                 std::cerr << "[策略树] 加载失败: " << lib_path << " | " << dlerror() << std::endl;
                 continue;
             }
-            
+
             CreateStrategyFunc create_fn = (CreateStrategyFunc)dlsym(handle, "create_strategy");
             if (!create_fn) {
                 std::cerr << "[策略树] 符号未找到: create_strategy in " << lib_path << std::endl;
@@ -72,35 +112,58 @@ public:
             }
 
             IStrategyNode* strategy = create_fn();
-            
+            const size_t index = nodes_.size();
+            auto node_handle = std::make_unique<StrategyNodeHandle>();
+            node_handle->lib_handle = handle;
+            node_handle->node = std::unique_ptr<IStrategyNode>(strategy);
+            node_handle->id = id;
+
+            if (node_cfg["inputs"]) {
+                node_handle->consume_all = false;
+                for (const auto& name : factor_list(node_cfg["inputs"])) {
+                    node_handle->inputs.push_back(intern(name));
+                }
+            }
+            if (node_cfg["outputs"]) {
+                node_handle->emit_any = false;
+                for (const auto& name : factor_list(node_cfg["outputs"])) {
+                    node_handle->outputs.emplace_back(name, intern(name));
+                }
+            }
+
             // 注入受限上下文
-            StrategyContext* ctx = new StrategyContext(); 
+            node_handle->ctx = std::make_unique<StrategyContext>();
+            StrategyContext* ctx = node_handle->ctx.get();
             ctx->strategy_id = id;
-            ctx->send_order = [this, id](const OrderReq& req) {
-                bus_->publish(EVENT_ORDER_REQ, const_cast<OrderReq*>(&req));
-            };
-            
-            // [New Design] 集中式信号分发
-            ctx->send_signal = [this, id](const SignalRecord& sig) {
-                SignalRecord internal_sig = sig;
-                std::strncpy(internal_sig.source_id, id.c_str(), sizeof(internal_sig.source_id)-1);
-                
-                // 1. [Fast Path] 内部同步转发给兄弟节点
-                for (auto& n : nodes_) {
-                    if (n->id == id) continue; // 不发给自己，防止死循环
-                    n->node->onSignal(&internal_sig);
+            ctx->send_order = [this, index](const OrderReq& req) {
+                if (parallel_) {
+                    nodes_[index]->pending_orders.push_back(req);  // 并行层内：暂存，层结束后发出
+                    return;
                 }
+                publish_order(req);
+            };
 
-                // 2. [Slow Path] 可选发布到全局总线 (用于录制/监控)
-                if (publish_signals_) {
-                    bus_->publish(EVENT_SIGNAL, &internal_sig);
+            // [New Design] 集中式信号分发：按因子 ID 投递给声明的消费者
+            ctx->send_signal = [this, index, id](const SignalRecord& sig) {
+                if (parallel_) {
+                    auto& buf = nodes_[index]->pending_signals;
+                    buf.push_back(sig);
+                    std::strncpy(buf.back().source_id, id.c_str(), sizeof(buf.back().source_id)-1);
+                    return;
                 }
+                SignalRecord internal_sig = sig;
+                std::strncpy(internal_sig.source_id, id.c_str(), sizeof(internal_sig.source_id)-1);
+                deliver(index, internal_sig);
             };
 
             ctx->log = [id](const char* msg) {
                 std::cout << "[策略-" << id << "] " << msg << std::endl;
             };
-            
+
+            ctx->subscribe_symbols = [this, index](const std::vector<std::string>& symbols) {
+                subscribe(index, symbols);
+            };
+
             // 节点私有参数
             ConfigMap node_config;
             if (node_cfg["params"]) {
@@ -112,47 +175,387 @@ public:
                          }
                     }
                 }
-                
+
                 // [Fix] 序列化完整参数结构传给子节点，以便解析嵌套配置 (如 weights)
                 YAML::Emitter out;
                 out << node_cfg["params"];
                 node_config["_yaml"] = out.c_str();
             }
-            
-            strategy->init(ctx, node_config);
-            
-            auto node_handle = std::make_unique<StrategyNodeHandle>();
-            node_handle->lib_handle = handle;
-            node_handle->node = std::unique_ptr<IStrategyNode>(strategy);
-            node_handle->id = id;
+
             nodes_.push_back(std::move(node_handle));
+            strategy->init(ctx, node_config);
+        }
+
+        build_schedule();
+        build_routes();
+        if (workers > 0 && max_level_width_ > 1) {
+            pool_ = std::make_unique<ForkJoinPool>(std::min(workers, max_level_width_ - 1));
         }
 
         // --- 事件透传 ---
 
-        // 订阅行情 -> 分发给所有节点
-        bus_->subscribe(EVENT_MARKET_DATA, [this](void* d) {
-            for (auto& n : nodes_) n->node->onTick(static_cast<TickRecord*>(d));
-        });
+        // 订阅行情 -> 按拓扑层次分发
+        if (tick_batch) {
+            std::cout << "[策略树] 批量行情模式：消费 EVENT_TICK_BATCH (Replay 需配置 publish_batch: true)" << std::endl;
+            bus_->subscribe(EVENT_TICK_BATCH, [this](void* d) {
+                LatencyTrace::stamp(LAT_STRATEGY);
+                dispatch_batch(*static_cast<TickBatch*>(d));
+            });
+        } else {
+            bus_->subscribe(EVENT_MARKET_DATA, [this](void* d) {
+                LatencyTrace::stamp(LAT_STRATEGY);
+                const TickRecord* tick = static_cast<TickRecord*>(d);
+                dispatch(tick->symbol_id, [tick](IStrategyNode* n) { n->onTick(tick); });
+            });
+        }
 
         // 订阅 K线 -> 分发
         bus_->subscribe(EVENT_KLINE, [this](void* d) {
-            for (auto& n : nodes_) n->node->onKline(static_cast<KlineRecord*>(d));
+            const KlineRecord* kline = static_cast<KlineRecord*>(d);
+            dispatch(kline->symbol_id, [kline](IStrategyNode* n) { n->onKline(kline); });
+        });
+
+        // 订阅盘口重建 -> 分发
+        bus_->subscribe(EVENT_BOOK_UPDATE, [this](void* d) {
+            const BookUpdate* update = static_cast<BookUpdate*>(d);
+            dispatch(update->tick->symbol_id, [update](IStrategyNode* n) { n->onBookUpdate(update); });
         });
 
         // 注意：不再订阅 EVENT_SIGNAL，因为内部信号已经同步分发了
         // 如果外部有其他来源的信号，可以在这里补充，但通常策略信号都在本树内
 
-        // 订阅成交回报 -> 分发
+        // 回放阶段：追赶期抑制报单与信号外发
+        bus_->subscribe(EVENT_REPLAY_STATUS, [this](void* d) {
+            bool warmup = static_cast<ReplayStatus*>(d)->phase == REPLAY_WARMUP;
+            if (warmup_ && !warmup) {
+                std::cout << "[策略树] 回放追赶结束，恢复报单 (追赶期抑制 " << suppressed_orders_ << " 笔)" << std::endl;
+            }
+            warmup_ = warmup;
+        });
+
+        // 订阅成交回报 -> 分发 (回报只关心本节点订单，按调度顺序串行即可)
         bus_->subscribe(EVENT_RTN_ORDER, [this](void* d) {
-            for (auto& n : nodes_) n->node->onOrderUpdate(static_cast<OrderRtn*>(d));
+            for (uint32_t i : order_) nodes_[i]->node->onOrderUpdate(static_cast<OrderRtn*>(d));
         });
     }
 
 private:
+    struct Level {
+        size_t begin;  // order_ 中的区间 [begin, end)
+        size_t end;
+    };
+
+    static std::vector<std::string> factor_list(const YAML::Node& n) {
+        std::vector<std::string> names;
+        if (n.IsSequence()) {
+            for (const auto& v : n) names.push_back(v.as<std::string>());
+        } else if (n.IsScalar() && !n.as<std::string>().empty()) {
+            names.push_back(n.as<std::string>());
+        }
+        return names;
+    }
+
+    int intern(const std::string& name) {
+        auto it = factor_ids_.find(name);
+        if (it != factor_ids_.end()) return it->second;
+        int fid = static_cast<int>(consumers_.size());
+        factor_ids_.emplace(name, fid);
+        // 运行期新出现的因子：只有广播节点 (未声明 inputs) 接收
+        consumers_.emplace_back(broadcast_);
+        return fid;
+    }
+
+    // 信号因子名 -> ID：先查产出节点自己的输出表 (strncmp，无分配)，未命中再走全局表并记入输出表
+    int resolve(StrategyNodeHandle& src, const SignalRecord& sig) {
+        auto& outs = src.outputs;
+        if (src.last_output < outs.size() &&
+            std::strncmp(outs[src.last_output].first.c_str(), sig.factor_name, sizeof(sig.factor_name)) == 0) {
+            return outs[src.last_output].second;
+        }
+        for (size_t i = 0; i < outs.size(); ++i) {
+            if (std::strncmp(outs[i].first.c_str(), sig.factor_name, sizeof(sig.factor_name)) == 0) {
+                src.last_output = i;
+                return outs[i].second;
+            }
+        }
+        std::string name(sig.factor_name, strnlen(sig.factor_name, sizeof(sig.factor_name)));
+        if (!src.emit_any) {
+            std::cerr << "[策略树] 节点 " << src.id << " 输出未声明的因子: " << name << std::endl;
+        }
+        int fid = intern(name);
+        src.last_output = outs.size();
+        outs.emplace_back(name, fid);
+        return fid;
+    }
+
+    void deliver(size_t src, const SignalRecord& sig) {
+        // 1. [Fast Path] 同步投递给该因子的消费者
+        for (uint32_t dst : consumers_[resolve(*nodes_[src], sig)]) {
+            if (dst == src) continue; // 不发给自己，防止死循环
+            nodes_[dst]->node->onSignal(&sig);
+        }
+
+        // 2. [Slow Path] 可选发布到全局总线 (用于录制/监控)
+        if (publish_signals_ && !warmup_) {
+            bus_->publish(EVENT_SIGNAL, const_cast<SignalRecord*>(&sig));
+        }
+    }
+
+    void publish_order(const OrderReq& req) {
+        if (warmup_) {
+            ++suppressed_orders_;  // 回放追赶期：策略照常演算，报单不出树
+            return;
+        }
+        bus_->publish(EVENT_ORDER_REQ, const_cast<OrderReq*>(&req));
+    }
+
+    /**
+     * 建图与分层：
+     *   A -> B 当 A 的 outputs 与 B 的 inputs 有交集；
+     *   未声明 outputs 的节点可能输出任意因子，未声明 inputs 的节点接收全部因子，二者涉及的边按配置顺序连接 (前 -> 后)。
+     * 不声明任何依赖的旧配置因此退化为按配置顺序逐个执行，与原行为一致。
+     * level = 最长前驱链长度，同层节点互不依赖；存在环时报错并回退为配置顺序。
+     */
+    void build_schedule() {
+        const size_t n = nodes_.size();
+        for (uint32_t i = 0; i < n; ++i) {
+            if (nodes_[i]->consume_all) broadcast_.push_back(i);
+        }
+        std::vector<std::vector<uint32_t>> declared(consumers_.size());
+        for (uint32_t i = 0; i < n; ++i) {
+            for (int fid : nodes_[i]->inputs) declared[fid].push_back(i);
+        }
+        for (size_t fid = 0; fid < consumers_.size(); ++fid) {
+            auto& list = consumers_[fid];
+            list = declared[fid];
+            list.insert(list.end(), broadcast_.begin(), broadcast_.end());
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+        }
+
+        auto produces = [](const StrategyNodeHandle& h) { return h.emit_any || !h.outputs.empty(); };
+        auto consumes = [](const StrategyNodeHandle& h) { return h.consume_all || !h.inputs.empty(); };
+        std::vector<std::vector<uint32_t>> succ(n);
+        std::vector<int> indegree(n, 0);
+        for (uint32_t a = 0; a < n; ++a) {
+            const auto& A = *nodes_[a];
+            if (!produces(A)) continue;
+            for (uint32_t b = 0; b < n; ++b) {
+                const auto& B = *nodes_[b];
+                if (a == b || !consumes(B)) continue;
+                bool edge;
+                if (A.emit_any || B.consume_all) {
+                    edge = a < b;
+                } else {
+                    edge = false;
+                    for (const auto& out : A.outputs) {
+                        if (std::find(B.inputs.begin(), B.inputs.end(), out.second) != B.inputs.end()) {
+                            edge = true;
+                            break;
+                        }
+                    }
+                }
+                if (edge) {
+                    succ[a].push_back(b);
+                    ++indegree[b];
+                }
+            }
+        }
+
+        // Kahn 拓扑排序，同时求层次
+        std::vector<uint32_t> ready;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (indegree[i] == 0) ready.push_back(i);
+        }
+        size_t visited = 0;
+        while (!ready.empty()) {
+            uint32_t a = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (uint32_t b : succ[a]) {
+                nodes_[b]->level = std::max(nodes_[b]->level, nodes_[a]->level + 1);
+                if (--indegree[b] == 0) ready.push_back(b);
+            }
+        }
+        if (visited != n) {
+            std::cerr << "[策略树] 因子依赖存在环 (环上节点及其下游):";
+            for (uint32_t i = 0; i < n; ++i) {
+                if (indegree[i] > 0) std::cerr << " " << nodes_[i]->id;
+            }
+            std::cerr << "，回退为配置顺序执行" << std::endl;
+            for (uint32_t i = 0; i < n; ++i) nodes_[i]->level = static_cast<int>(i);
+        }
+
+        order_.resize(n);
+        for (uint32_t i = 0; i < n; ++i) order_[i] = i;
+        std::stable_sort(order_.begin(), order_.end(),
+                         [this](uint32_t a, uint32_t b) { return nodes_[a]->level < nodes_[b]->level; });
+        levels_.clear();
+        max_level_width_ = 0;
+        for (size_t i = 0; i < n;) {
+            size_t j = i;
+            while (j < n && nodes_[order_[j]]->level == nodes_[order_[i]]->level) ++j;
+            levels_.push_back({i, j});
+            max_level_width_ = std::max(max_level_width_, j - i);
+            i = j;
+        }
+
+        std::string plan;
+        for (const auto& lv : levels_) {
+            if (!plan.empty()) plan += " -> ";
+            plan += "{";
+            for (size_t k = lv.begin; k < lv.end; ++k) {
+                if (k > lv.begin) plan += ", ";
+                plan += nodes_[order_[k]]->id;
+            }
+            plan += "}";
+        }
+        if (!plan.empty()) std::cout << "[策略树] 调度: " << plan << std::endl;
+    }
+
+    void subscribe(size_t index, const std::vector<std::string>& symbols) {
+        auto& h = *nodes_[index];
+        const SymbolManager& sm = SymbolManager::instance();
+        for (const auto& sym : symbols) {
+            int row = sm.get_index(sm.get_id(sym.c_str()));
+            if (row < 0) {
+                // 不在 symbols.txt 中的合约没有稠密下标，无法路由：该节点继续接收全部合约，由节点自行过滤
+                std::cerr << "[策略树] 节点 " << h.id << " 订阅的合约 " << sym << " 不在合约表中，回退为接收全部合约" << std::endl;
+                h.unroutable = true;
+                continue;
+            }
+            h.symbol_rows.push_back(row);
+        }
+        h.all_symbols = h.unroutable;
+        std::sort(h.symbol_rows.begin(), h.symbol_rows.end());
+        h.symbol_rows.erase(std::unique(h.symbol_rows.begin(), h.symbol_rows.end()), h.symbol_rows.end());
+        if (!order_.empty()) build_routes();  // 初始化之后的订阅变更
+    }
+
+    /**
+     * 路由表 (CSR)：合约稠密下标 -> 按调度顺序排列的节点下标；末行供合约表之外的合约使用，只含全合约节点。
+     * 每条行情只遍历订阅了该合约的节点，扇出代价与订阅者数成正比，与节点总数无关。
+     */
+    void build_routes() {
+        const size_t rows = SymbolManager::instance().count() + 1;
+        route_begin_.assign(rows + 1, 0);
+        route_nodes_.clear();
+        for (size_t r = 0; r < rows; ++r) {
+            route_begin_[r] = static_cast<uint32_t>(route_nodes_.size());
+            for (uint32_t i : order_) {
+                const auto& h = *nodes_[i];
+                if (h.all_symbols || std::binary_search(h.symbol_rows.begin(), h.symbol_rows.end(), static_cast<int>(r))) {
+                    route_nodes_.push_back(i);
+                }
+            }
+        }
+        route_begin_[rows] = static_cast<uint32_t>(route_nodes_.size());
+        has_subsets_ = false;
+        for (const auto& h : nodes_) has_subsets_ |= !h->all_symbols;
+        node_level_.resize(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i) node_level_[i] = nodes_[i]->level;
+    }
+
+    // 按层驱动订阅了该合约的节点：单节点层直接调用；多节点层在线程池上并行，期间报单 / 信号暂存，层结束后按节点顺序发出
+    template <class F>
+    void dispatch(uint64_t symbol_id, F&& f) {
+        int row = SymbolManager::instance().get_index(symbol_id);
+        const size_t r = row >= 0 ? static_cast<size_t>(row) : route_begin_.size() - 2;
+        const uint32_t* p = route_nodes_.data() + route_begin_[r];
+        const uint32_t* end = route_nodes_.data() + route_begin_[r + 1];
+        if (!pool_) {
+            for (; p != end; ++p) f(nodes_[*p]->node.get());
+            return;
+        }
+        while (p != end) {
+            const uint32_t* q = p + 1;
+            while (q != end && node_level_[*q] == node_level_[*p]) ++q;
+            if (q - p == 1) {
+                f(nodes_[*p]->node.get());
+            } else {
+                parallel_ = true;
+                pool_->run(q - p, [this, &f, p](size_t k) { f(nodes_[p[k]]->node.get()); });
+                parallel_ = false;
+                for (const uint32_t* it = p; it != q; ++it) flush(*it);
+            }
+            p = q;
+        }
+    }
+
+    /**
+     * 批量分发：先按路由表把批内行情分到订阅了部分合约的节点 (保持原顺序)，再按层次每个节点调用一次 onTickBatch。
+     * 上游节点处理完整批后下游才收到本批行情，上游对本批产出的信号都先于下游的 onTickBatch 投递。
+     */
+    void dispatch_batch(const TickBatch& batch) {
+        if (has_subsets_) {
+            const SymbolManager& sm = SymbolManager::instance();
+            const size_t unknown = route_begin_.size() - 2;
+            for (size_t i = 0; i < batch.count; ++i) {
+                const TickRecord* tick = batch.ticks[i];
+                int row = sm.get_index(tick->symbol_id);
+                const size_t r = row >= 0 ? static_cast<size_t>(row) : unknown;
+                for (uint32_t k = route_begin_[r]; k < route_begin_[r + 1]; ++k) {
+                    auto& h = *nodes_[route_nodes_[k]];
+                    if (!h.all_symbols) h.tick_batch.push_back(tick);
+                }
+            }
+        }
+        for (const auto& lv : levels_) {
+            if (!pool_ || lv.end - lv.begin == 1) {
+                for (size_t k = lv.begin; k < lv.end; ++k) run_batch(order_[k], batch);
+                continue;
+            }
+            parallel_ = true;
+            pool_->run(lv.end - lv.begin, [this, &lv, &batch](size_t k) { run_batch(order_[lv.begin + k], batch); });
+            parallel_ = false;
+            for (size_t k = lv.begin; k < lv.end; ++k) flush(order_[k]);
+        }
+    }
+
+    void run_batch(uint32_t index, const TickBatch& batch) {
+        auto& h = *nodes_[index];
+        if (h.all_symbols) {
+            h.node->onTickBatch(batch.ticks, batch.count);
+            return;
+        }
+        if (h.tick_batch.empty()) return;
+        h.node->onTickBatch(h.tick_batch.data(), h.tick_batch.size());
+        h.tick_batch.clear();
+    }
+
+    void flush(uint32_t index) {
+        auto& h = *nodes_[index];
+        if (!h.pending_orders.empty()) {
+            for (const auto& req : h.pending_orders) publish_order(req);
+            h.pending_orders.clear();
+        }
+        if (!h.pending_signals.empty()) {
+            for (const auto& sig : h.pending_signals) deliver(index, sig);
+            h.pending_signals.clear();
+        }
+    }
+
     EventBus* bus_;
     std::vector<std::unique_ptr<StrategyNodeHandle>> nodes_;
     bool publish_signals_ = true;
+    bool warmup_ = false;             // 与行情同线程读写
+    uint64_t suppressed_orders_ = 0;
+
+    // 因子 DAG
+    std::unordered_map<std::string, int> factor_ids_;    // 因子名 -> ID (仅初始化 / 首次遇到新因子时查询)
+    std::vector<std::vector<uint32_t>> consumers_;       // 因子 ID -> 消费节点 (升序)
+    std::vector<uint32_t> broadcast_;                    // 未声明 inputs 的节点
+    std::vector<uint32_t> order_;                        // 按层次排列的节点下标
+    std::vector<Level> levels_;
+    size_t max_level_width_ = 0;
+    std::unique_ptr<ForkJoinPool> pool_;
+
+    // 合约路由
+    std::vector<uint32_t> route_begin_;                  // 行 r 的节点为 route_nodes_[route_begin_[r] .. route_begin_[r+1])
+    std::vector<uint32_t> route_nodes_;
+    std::vector<int> node_level_;
+    bool has_subsets_ = false;        // 存在只订阅部分合约的节点 (批量模式需按合约拆批)
+    bool parallel_ = false;           // 调度线程写，工作线程在 run 期间只读
 };
 
-EXPORT_MODULE(StrategyTreeModule)
\ No newline at end of file
+EXPORT_MODULE(StrategyTreeModule)
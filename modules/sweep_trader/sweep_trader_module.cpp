@@ -23,7 +23,7 @@ struct TwapTask {
     int interval_sec;
     uint64_t start_ts; // HHMMSSmmm
     uint64_t end_ts;
-    std::chrono::steady_clock::time_point last_exec_time;
+    uint64_t last_exec_ns = 0;  // 引擎时钟纳秒，0 表示尚未执行
     bool finished = false;
 };
 
@@ -129,7 +129,7 @@ public:
                 task.interval_sec = (interval > 0) ? interval : 60;
                 task.start_ts = start_ts;
                 task.end_ts = end_ts;
-                task.last_exec_time = std::chrono::steady_clock::now() - std::chrono::seconds(task.interval_sec);
+                task.last_exec_ns = 0;
                 active_tasks_[filename] = task;
                 std::cout << "[SweepTrader] TWAP task added: " << req.symbol << " vol=" << volume << std::endl;
             } else {
@@ -145,7 +145,7 @@ public:
     }
 
     void checkTwapTasks() {
-        auto now = std::chrono::steady_clock::now();
+        uint64_t now = IClock::instance().now_ns();
         uint64_t current_ts = getCurrentTimeUint();
 
         for (auto it = active_tasks_.begin(); it != active_tasks_.end(); ) {
@@ -165,8 +165,10 @@ public:
             }
 
             // 检查间隔
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - task.last_exec_time).count();
-            if (elapsed >= task.interval_sec) {
+            // now 早于上次执行 (时钟被替换或回拨) 时视为未到期，避免差值下溢立即触发
+            if (task.last_exec_ns == 0 ||
+                (now >= task.last_exec_ns &&
+                 now - task.last_exec_ns >= static_cast<uint64_t>(task.interval_sec) * 1000000000ULL)) {
                 // 计算此批次单量
                 int remaining = task.total_volume - task.executed_volume;
                 // 简单平分逻辑：剩余量 / 剩余批次
@@ -178,7 +180,7 @@ public:
                 req.volume = batch_vol;
                 if (executeOrder(req)) {
                     task.executed_volume += batch_vol;
-                    task.last_exec_time = now;
+                    task.last_exec_ns = now;
                 }
             }
             ++it;
@@ -222,11 +224,8 @@ private:
     }
 
     uint64_t getCurrentTimeUint() {
-        auto now = std::chrono::system_clock::now();
-        time_t t = std::chrono::system_clock::to_time_t(now);
-        struct tm tm;
-        localtime_r(&t, &tm);
-        return tm.tm_hour * 1000000ULL + tm.tm_min * 10000ULL + tm.tm_sec * 100ULL;
+        // HHMMSS -> HHMMSS00，与 parseTime 同一量纲
+        return IClock::instance().hhmmss() * 100ULL;
     }
 
     bool isCurrentTimeInRange(uint64_t start, uint64_t end) {
@@ -0,0 +1,89 @@
+#include "../../include/framework.h"
+#include "../../core/include/latency_trace.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/**
+ * LoopbackTradeModule: 回环交易桩 (基准测试 / CI 用)
+ *
+ * 订阅 EVENT_ORDER_SEND，在柜台出口位置打 LatencyTrace 的 api 时刻，随即同步回送已报与全部成交的原始回报
+ * (EVENT_RTN_RAW_ORDER / EVENT_RTN_RAW_TRADE)，让 OrderManager、持仓等下游按实盘路径处理，但不连接任何柜台。
+ */
+class LoopbackTradeModule : public IModule {
+public:
+    void init(EventBus* bus, const ConfigMap& config, ITimerService* timer_svc = nullptr) override {
+        bus_ = bus;
+        if (config.find("fill") != config.end()) {
+            fill_ = (config.at("fill") == "true" || config.at("fill") == "1");
+        }
+        if (config.find("debug") != config.end()) {
+            debug_ = (config.at("debug") == "true");
+        }
+
+        bus_->subscribe(EVENT_ORDER_SEND, [this](void* d) {
+            this->onOrder(static_cast<OrderReq*>(d));
+        });
+
+        std::cout << "[Loopback] Initialized. Fill=" << (fill_ ? "ON" : "OFF") << std::endl;
+    }
+
+    void stop() override {
+        std::cout << "[Loopback] Orders: " << orders_.load(std::memory_order_relaxed) << std::endl;
+    }
+
+private:
+    void onOrder(OrderReq* req) {
+        LatencyTrace::stamp(LAT_API);
+        LatencyTrace::egress(*req);
+        orders_.fetch_add(1, std::memory_order_relaxed);
+
+        OrderRtn rtn;
+        std::memset(&rtn, 0, sizeof(rtn));
+        rtn.client_id = req->client_id;
+        std::memcpy(rtn.account_id, req->account_id, sizeof(rtn.account_id));
+        std::memcpy(rtn.order_ref, req->order_ref, sizeof(rtn.order_ref));
+        snprintf(rtn.order_sys_id, sizeof(rtn.order_sys_id), "LB%llu",
+                 static_cast<unsigned long long>(++sys_seq_));
+        std::memcpy(rtn.symbol, req->symbol, sizeof(rtn.symbol));
+        rtn.symbol_id = req->symbol_id;
+        rtn.direction = req->direction;
+        rtn.offset_flag = req->offset_flag;
+        rtn.limit_price = req->price;
+        rtn.volume_total = req->volume;
+        rtn.volume_traded = fill_ ? req->volume : 0;
+        rtn.status = fill_ ? '0' : '3';
+        bus_->publish(EVENT_RTN_RAW_ORDER, &rtn);
+
+        if (fill_) {
+            TradeRtn trade;
+            std::memset(&trade, 0, sizeof(trade));
+            trade.client_id = req->client_id;
+            std::memcpy(trade.account_id, req->account_id, sizeof(trade.account_id));
+            std::memcpy(trade.symbol, req->symbol, sizeof(trade.symbol));
+            trade.symbol_id = req->symbol_id;
+            trade.direction = req->direction;
+            trade.offset_flag = req->offset_flag;
+            trade.price = req->price;
+            trade.volume = req->volume;
+            std::memcpy(trade.order_ref, req->order_ref, sizeof(trade.order_ref));
+            std::memcpy(trade.order_sys_id, rtn.order_sys_id, sizeof(trade.order_sys_id));
+            std::memcpy(trade.trade_id, rtn.order_sys_id, sizeof(trade.trade_id));
+            bus_->publish(EVENT_RTN_RAW_TRADE, &trade);
+        }
+
+        if (debug_) {
+            std::cout << "[Loopback] " << req->symbol << " " << req->direction << " " << req->volume
+                      << " @ " << req->price << " (Ref=" << req->order_ref << ")" << std::endl;
+        }
+    }
+
+    EventBus* bus_ = nullptr;
+    bool fill_ = true;
+    bool debug_ = false;
+    uint64_t sys_seq_ = 0;
+    std::atomic<uint64_t> orders_{0};
+};
+
+EXPORT_MODULE(LoopbackTradeModule)
@@ -22,7 +22,13 @@ pub struct TickRecord {
     pub _pad3: u32,
     pub ask_price: [f64; 5],
     pub ask_volume: [i32; 5],
-    pub _pad4: [u8; 60],
+    // TickNormalizer 写入的增量与质量标志 (原尾部填充)
+    pub volume_delta: i32,
+    pub quality_flags: u32,
+    pub _pad4: u32,
+    pub turnover_delta: f64,
+    pub recv_ns: u64, // 录制器接收时刻 (Unix 纳秒)
+    pub _pad5: [u8; 32],
 }
 
 impl TickRecord {
@@ -45,6 +51,8 @@ pub const MAX_SYMBOLS: usize = 2048;
 pub const SYMBOL_ID_BASE: u64 = 10000000;
 pub const SYMBOL_INDEX_SIZE: usize = 65536;
 pub const SHM_MAGIC: u64 = 0x534E415053484F54;
+pub const CHANGE_LOG_SIZE: usize = 4096;
+pub const CHANGE_SLOT_BITS: u32 = 16;
 
 #[repr(C)]
 pub struct ShmLayout {
@@ -52,4 +60,10 @@ pub struct ShmLayout {
     pub symbol_index: [i32; SYMBOL_INDEX_SIZE],
     pub slots: [SnapshotSlot; MAX_SYMBOLS],
     pub slot_count: i32,
+    pub _pad_count: [u8; 60],
+    // 变更通知区 (与 C++ ShmMarketSnapshot::ShmLayout 对齐)
+    pub update_seq: u64,
+    pub slot_update_seq: [u64; MAX_SYMBOLS],
+    pub slot_symbol_id: [u64; MAX_SYMBOLS],
+    pub change_log: [u64; CHANGE_LOG_SIZE], // (seq << 16) | slot
 }
@@ -1,6 +1,9 @@
 #include "../include/engine.h"
 #include "../core/include/symbol_manager.h"
 #include "../core/include/market_snapshot.h"
+#include "../core/include/snapshot_checkpoint.h"
+#include "../core/include/clock.h"
+#include "../core/include/latency_trace.h"
 #include <dlfcn.h>
 #include <iostream>
 #include <thread>
@@ -93,6 +96,10 @@ HftEngine::HftEngine() : is_running_(false) {
 
 HftEngine::~HftEngine() {
     stop();
+    if (clock_ && &IClock::instance() == clock_.get()) {
+        IClock::set_instance(nullptr);
+    }
+    LatencyTrace::set_clock(nullptr);
 }
 
 bool HftEngine::loadConfig(const std::string& config_path) {
@@ -121,6 +128,36 @@ bool HftEngine::loadConfig(const std::string& config_path) {
         return false;
     }
 
+    // 时间源：tsc (默认，不支持 invariant TSC 时回退) / wall；须在插件 init 之前安装
+    std::string clock_type = config["clock"] ? config["clock"].as<std::string>() : "tsc";
+    if (clock_type == "tsc" && TscClock::supported()) {
+        auto tsc = std::make_unique<TscClock>();
+        tsc_clock_ = tsc.get();
+        std::cout << "[System] Clock: TSC (" << tsc->ghz() << " GHz)" << std::endl;
+        clock_ = std::move(tsc);
+    } else {
+        std::cout << "[System] Clock: wall" << std::endl;
+        clock_ = std::make_unique<WallClock>();
+    }
+    IClock::set_instance(clock_.get());
+    LatencyTrace::set_clock(clock_.get());  // 链路打点始终用实时时钟，不随回放的 SimClock 变化
+
+    // 报单链路延迟统计 (latency.report_interval / latency.csv)，未配置时各打点为空操作
+    if (config["latency"]) {
+        const auto& lat = config["latency"];
+        std::string csv = lat["csv"] ? lat["csv"].as<std::string>() : "";
+        int interval = lat["report_interval"] ? lat["report_interval"].as<int>() : 10;
+        latency_stats_ = std::make_unique<LatencyStats>(csv);
+        LatencyTrace::set_sink(latency_stats_.get());
+        add_timer_impl(interval, [this]() {
+            if (!latency_stats_->empty()) {
+                std::cout << "[Latency] " << latency_stats_->report() << std::endl;
+            }
+        });
+        std::cout << "[System] Latency trace enabled (report every " << interval << "s"
+                  << (csv.empty() ? "" : ", csv: " + csv) << ")" << std::endl;
+    }
+
     // [INTEGRATION] 初始化截面 (Local 或 Shm)
     if (config["snapshot"]) {
         const auto& snap = config["snapshot"];
@@ -149,10 +186,35 @@ bool HftEngine::loadConfig(const std::string& config_path) {
     // 设置全局单例指针
     MarketSnapshot::set_instance(snapshot_impl_.get());
 
+    // [Checkpoint] 截面落盘与预热：在插件 init 之前回灌，保证策略首个报单即可定价
+    if (config["snapshot"] && config["snapshot"]["checkpoint_path"]) {
+        const auto& snap = config["snapshot"];
+        checkpoint_path_ = snap["checkpoint_path"].as<std::string>();
+        bool warm_start = snap["warm_start"] ? snap["warm_start"].as<bool>() : true;
+        // 只回灌当前交易日的记录：未配置时按时钟推算 (夜盘归下一交易日)，15:00 写下的检查点不会灌进 21:00 的夜盘，
+        // 而夜盘收盘后 08:50 重启仍属同一交易日，照常预热；checkpoint_max_age 默认 0 (不按时长过期)，交易日过滤已足够
+        uint32_t trading_day = snap["trading_day"] ? snap["trading_day"].as<uint32_t>() : clock_->trading_day();
+        int64_t max_age = snap["checkpoint_max_age"] ? snap["checkpoint_max_age"].as<int64_t>() : 0;
+        int interval = snap["checkpoint_interval"] ? snap["checkpoint_interval"].as<int>() : 60;
+
+        if (warm_start) {
+            size_t n = SnapshotCheckpoint::load(*snapshot_impl_, checkpoint_path_, trading_day, max_age);
+            std::cout << "[System] Snapshot warm start: " << n << " symbols of trading day " << trading_day
+                      << " restored from " << checkpoint_path_ << std::endl;
+        }
+        if (interval > 0) {
+            add_timer_impl(interval, [this]() { save_checkpoint(); });
+        }
+    }
+
     if (config["trading_hours"]) {
         const auto& th = config["trading_hours"];
         if (th["start"]) start_time_ = th["start"].as<std::string>();
         if (th["end"]) end_time_ = th["end"].as<std::string>();
+        int hh = 0, mm = 0, ss = 0;
+        if (!end_time_.empty() && sscanf(end_time_.c_str(), "%d:%d:%d", &hh, &mm, &ss) >= 2) {
+            end_hhmmss_ = static_cast<uint32_t>(hh * 10000 + mm * 100 + ss);
+        }
         
         std::cout << "[Config] Trading Hours: " 
                   << (start_time_.empty() ? "Any" : start_time_) << " - " 
@@ -226,6 +288,12 @@ bool HftEngine::loadConfig(const std::string& config_path) {
             }
         }
     }
+
+    // 回放模块安装了模拟时钟：定时器在回放线程内随行情整秒触发，与 Tick 的先后关系可复现
+    if (auto* sim = dynamic_cast<SimClock*>(&IClock::instance())) {
+        sim->set_on_second([this](uint64_t sec) { on_sim_second(sec); });
+        std::cout << "[System] Clock: simulated (timers driven by replay time)" << std::endl;
+    }
     return true;
 }
 
@@ -254,27 +322,23 @@ void HftEngine::run() {
     auto last_tick = std::chrono::steady_clock::now();
 
     while (!g_shutdown) {
-        auto now_clock = std::chrono::steady_clock::now();
-        if (now_clock - last_tick >= std::chrono::seconds(1)) {
-            total_seconds_++;
-            last_tick += std::chrono::seconds(1);
-            run_due_timers();
-        }
+        IClock& clock = IClock::instance();
+        if (!clock.simulated()) {
+            auto now_clock = std::chrono::steady_clock::now();
+            if (now_clock - last_tick >= std::chrono::seconds(1)) {
+                total_seconds_++;
+                last_tick += std::chrono::seconds(1);
+                if (tsc_clock_) tsc_clock_->resync();
+                run_due_timers();
+            }
 
-        // --- 结束时间检查 ---
-        if (!end_time_.empty()) {
-             auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-             std::tm local_tm = *std::localtime(&now);
-             std::ostringstream oss;
-             oss << std::put_time(&local_tm, "%H:%M:%S");
-             std::string current_time = oss.str();
-
-             if (current_time >= end_time_) {
-                 std::cout << "[System] Reached end time " << end_time_ << ". Stopping." << std::endl;
-                 break;
-             }
+            // --- 结束时间检查 (回放模式下由数据结束决定，不按行情时间停机) ---
+            if (end_hhmmss_ != 0 && clock.hhmmss() >= end_hhmmss_) {
+                std::cout << "[System] Reached end time " << end_time_ << ". Stopping." << std::endl;
+                break;
+            }
         }
-        
+
         // 降低轮询频率，减少 CPU 占用，但保证秒级精度
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
@@ -293,19 +357,45 @@ void HftEngine::add_timer_impl(int interval_sec, std::function<void()> cb, int p
     timer_tasks_.push_back({ interval_sec, next_fire, std::move(cb) });
 }
 
+EventBus* HftEngine::bus() const {
+    return bus_.get();
+}
+
+void HftEngine::on_sim_second(uint64_t sec) {
+    if (last_sim_sec_ != 0 && sec > last_sim_sec_) {
+        total_seconds_ += sec - last_sim_sec_;
+        run_due_timers();
+    }
+    last_sim_sec_ = sec;
+}
+
 void HftEngine::run_due_timers() {
     for (auto& t : timer_tasks_) {
         if (total_seconds_ >= t.next_fire) {
             t.callback();
-            t.next_fire += static_cast<uint64_t>(t.interval_sec);
+            // 时间跳跃 (如模拟时钟跨过午休) 时错过的周期合并为一次
+            while (t.next_fire <= total_seconds_) {
+                t.next_fire += static_cast<uint64_t>(t.interval_sec);
+            }
         }
     }
 }
 
+void HftEngine::save_checkpoint() {
+    if (checkpoint_path_.empty() || !snapshot_impl_) return;
+    long n = SnapshotCheckpoint::save(*snapshot_impl_, checkpoint_path_);
+    if (n < 0) {
+        std::cerr << "[System] Snapshot checkpoint failed: " << checkpoint_path_ << std::endl;
+    }
+}
+
 void HftEngine::stop() {
     if (!is_running_ && plugins_.empty()) return;
 
     std::cout << ">>> Shutting down..." << std::endl;
+
+    // 0. 模块 stop 可能清空截面 (如 ReplayModule)，须在此之前落盘
+    save_checkpoint();
     
     // 1. 停止模块
     for (auto& p : plugins_) {
@@ -323,6 +413,11 @@ void HftEngine::stop() {
     // 3. [CRITICAL] 显式释放插件，确保按照预期顺序析构
     // PluginHandle 的析构函数会负责 dlclose
     plugins_.clear();
+
+    if (latency_stats_) {
+        LatencyTrace::set_sink(nullptr);
+        std::cout << "[Latency] " << latency_stats_->report() << std::endl;
+    }
     
     is_running_ = false;
     std::cout << ">>> Shutdown Complete." << std::endl;
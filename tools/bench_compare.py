@@ -0,0 +1,65 @@
+"""对比两次 bench_core --json 输出，按 real_time (ns/op 中位数) 报告变化。
+
+用法: python3 tools/bench_compare.py baseline.json current.json [--threshold 10] [--filter substr]
+任一项变慢超过阈值 (百分比) 时返回 1，便于 CI 拦截回归；新增/删除的项只提示不判定。
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, "r", encoding="utf-8") as f:
+        doc = json.load(f)
+    return {b["name"]: b for b in doc.get("benchmarks", [])}, doc.get("context", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two bench_core JSON results")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="regression threshold in percent (default 10)")
+    parser.add_argument("--filter", default="", help="only compare benchmarks whose name contains this")
+    args = parser.parse_args()
+
+    base, base_ctx = load(args.baseline)
+    cur, cur_ctx = load(args.current)
+    if base_ctx.get("host_name") != cur_ctx.get("host_name"):
+        print(f"WARNING: different hosts ({base_ctx.get('host_name')} vs {cur_ctx.get('host_name')}), numbers may not be comparable")
+
+    names = [n for n in cur if args.filter in n]
+    width = max([len(n) for n in names] + [len("benchmark")])
+    print(f"{'benchmark':<{width}} {'base ns':>10} {'cur ns':>10} {'delta':>9}  {'noise':>6}")
+
+    regressions = []
+    for name in names:
+        c = cur[name]
+        b = base.get(name)
+        if b is None:
+            print(f"{name:<{width}} {'-':>10} {c['real_time']:>10.2f} {'new':>9}")
+            continue
+        delta = (c["real_time"] - b["real_time"]) / b["real_time"] * 100 if b["real_time"] > 0 else 0.0
+        # 两侧变异系数较大时，阈值内的波动不可信，标注出来
+        noise = max(b.get("cv", 0), c.get("cv", 0)) * 100
+        mark = ""
+        if delta > args.threshold:
+            mark = "  REGRESSION"
+            regressions.append((name, delta))
+        elif delta < -args.threshold:
+            mark = "  improved"
+        print(f"{name:<{width}} {b['real_time']:>10.2f} {c['real_time']:>10.2f} {delta:>+8.1f}%  {noise:>5.1f}%{mark}")
+
+    for name in base:
+        if args.filter in name and name not in cur:
+            print(f"{name:<{width}} {base[name]['real_time']:>10.2f} {'-':>10} {'removed':>9}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than {args.threshold:.1f}%:")
+        for name, delta in regressions:
+            print(f"  {name}: {delta:+.1f}%")
+        sys.exit(1)
+    print(f"\nNo regression beyond {args.threshold:.1f}%")
+
+
+if __name__ == "__main__":
+    main()
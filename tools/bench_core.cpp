@@ -0,0 +1,930 @@
+// 核心数据结构微基准：直接链接 hft_core / dlopen 生产插件，避免 demo/ 中拷贝代码与生产实现漂移。
+// 每项先标定迭代数使单轮耗时 >= min_time，再重复 reps 轮取中位数 ns/op，可输出 JSON 供 tools/bench_compare.py 对比。
+#include "framework.h"
+#include "protocol.h"
+#include "mmap_util.h"
+#include "market_snapshot.h"
+#include "symbol_manager.h"
+#include "order_manager.h"
+#include "kline_store.h"
+#include "factor_store.h"
+#include "expr_factor.h"
+#include "rolling.h"
+
+#include <dlfcn.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// ==========================================
+// 1. 计时框架
+// ==========================================
+template <typename T>
+inline void do_not_optimize(const T& v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 执行 n 次操作并返回计时区间的纳秒数 (准备工作放在计时区间外)
+using BenchFn = std::function<uint64_t(uint64_t n)>;
+
+struct Bench {
+    std::string name;
+    BenchFn fn;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double median_ns;
+    double min_ns;
+    double max_ns;
+    double cv;  // 各轮 ns/op 的变异系数
+};
+
+struct Options {
+    std::string filter;
+    std::string json_path;
+    std::string lib_dir = "../bin";
+    std::string symbols = "../conf/symbols.txt";
+    std::string work_dir = "/tmp/hft_bench_core";
+    double min_time = 0.2;
+    int reps = 5;
+    int cpu = -1;
+    bool list = false;
+};
+
+Result run_bench(const Bench& b, const Options& opt) {
+    // 标定：迭代数翻倍直到单轮耗时达到 min_time
+    uint64_t n = 1;
+    const uint64_t target_ns = static_cast<uint64_t>(opt.min_time * 1e9);
+    while (true) {
+        uint64_t t = b.fn(n);
+        if (t >= target_ns || n >= (1ULL << 34)) break;
+        double scale = t > 0 ? std::min(10.0, 1.4 * target_ns / t) : 10.0;
+        n = std::max<uint64_t>(n + 1, static_cast<uint64_t>(n * scale));
+    }
+
+    std::vector<double> per_op;
+    for (int r = 0; r < opt.reps; ++r) {
+        per_op.push_back(static_cast<double>(b.fn(n)) / n);
+    }
+    std::vector<double> sorted = per_op;
+    std::sort(sorted.begin(), sorted.end());
+
+    double mean = 0;
+    for (double v : per_op) mean += v;
+    mean /= per_op.size();
+    double var = 0;
+    for (double v : per_op) var += (v - mean) * (v - mean);
+    double cv = mean > 0 ? std::sqrt(var / per_op.size()) / mean : 0;
+
+    return {b.name, n, sorted[sorted.size() / 2], sorted.front(), sorted.back(), cv};
+}
+
+// ==========================================
+// 2. 测试数据
+// ==========================================
+std::vector<uint64_t> g_ids;          // 参与测试的合约 (symbols.txt 前 64 个)
+std::vector<TickRecord> g_ticks;      // 按合约轮转、时间递增的合成行情
+
+void build_ticks(size_t count) {
+    const SymbolManager& sm = SymbolManager::instance();
+    for (size_t i = 0; i < sm.count() && g_ids.size() < 64; ++i) g_ids.push_back(sm.id_at(i));
+    if (g_ids.empty()) g_ids.push_back(1);  // 未加载 symbols.txt 时仍可运行非合约相关的项
+
+    std::vector<double> price(g_ids.size(), 1000.0);
+    std::vector<int> volume(g_ids.size(), 0);
+    uint64_t rng = 88172645463325252ULL;
+    g_ticks.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t s = i % g_ids.size();
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        price[s] += static_cast<double>(static_cast<int>(rng % 5) - 2);
+        volume[s] += 1 + static_cast<int>((rng >> 8) % 10);
+
+        TickRecord& t = g_ticks[i];
+        std::memset(&t, 0, sizeof(t));
+        std::strncpy(t.symbol, sm.get_symbol(g_ids[s]), sizeof(t.symbol) - 1);
+        t.symbol_id = g_ids[s];
+        t.trading_day = 20260302;
+        uint64_t ms = 9 * 3600000ULL + i * 10;
+        t.update_time = ((ms / 3600000) * 10000 + (ms / 60000 % 60) * 100 + ms / 1000 % 60) * 1000 + ms % 1000;
+        t.last_price = price[s];
+        t.volume = volume[s];
+        t.turnover = price[s] * volume[s];
+        t.open_interest = 10000;
+        for (int l = 0; l < 5; ++l) {
+            t.bid_price[l] = price[s] - 1 - l;
+            t.ask_price[l] = price[s] + 1 + l;
+            t.bid_volume[l] = 10 + static_cast<int>((rng >> (l * 4)) % 50);
+            t.ask_volume[l] = 10 + static_cast<int>((rng >> (l * 4 + 20)) % 50);
+        }
+    }
+}
+
+// ==========================================
+// 3. 插件宿主 (最小 EventBus / 策略上下文)
+// ==========================================
+class BenchBus : public EventBus {
+public:
+    void subscribe(EventType type, Handler handler) override { handlers_[type].push_back(std::move(handler)); }
+    void publish(EventType type, void* data) override {
+        for (auto& h : handlers_[type]) h(data);
+    }
+    void clear() override {
+        for (auto& v : handlers_) v.clear();
+    }
+
+private:
+    std::array<std::vector<Handler>, MAX_EVENTS> handlers_;
+};
+
+struct Plugin {
+    void* handle = nullptr;
+    ~Plugin() {
+        if (handle) dlclose(handle);
+    }
+};
+
+// ==========================================
+// 4. 基准项
+// ==========================================
+void add_mmap_benches(std::vector<Bench>& out, const Options& opt) {
+    const std::string wpath = opt.work_dir + "/mmap_write";
+    out.push_back({"mmap/writer_write", [wpath](uint64_t n) {
+        fs::remove(wpath + ".dat");
+        fs::remove(wpath + ".meta");
+        MmapWriter<TickRecord> w(wpath, n);
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) w.write(g_ticks[i % g_ticks.size()]);
+        uint64_t t = now_ns() - t0;
+        return t;
+    }});
+
+    // 读者测试共用一份预写文件，读到尾部后回绕
+    const std::string rpath = opt.work_dir + "/mmap_read";
+    auto prepare = [rpath]() {
+        static bool ready = false;
+        if (ready) return;
+        fs::remove(rpath + ".dat");
+        fs::remove(rpath + ".meta");
+        MmapWriter<TickRecord> w(rpath, 1 << 20);
+        for (uint64_t i = 0; i < (1 << 20); ++i) w.write(g_ticks[i % g_ticks.size()]);
+        ready = true;
+    };
+    out.push_back({"mmap/reader_read_ptr", [rpath, prepare](uint64_t n) {
+        prepare();
+        MmapReader<TickRecord> r(rpath);
+        double sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            const TickRecord* p = r.read_ptr();
+            if (!p) {
+                r.seek_to_start();
+                p = r.read_ptr();
+            }
+            sum += p->last_price;
+        }
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+    out.push_back({"mmap/reader_read_batch16", [rpath, prepare](uint64_t n) {
+        prepare();
+        MmapReader<TickRecord> r(rpath);
+        const TickRecord* ptrs[16];
+        double sum = 0;
+        uint64_t done = 0;
+        uint64_t t0 = now_ns();
+        while (done < n) {
+            size_t got = r.read_batch(ptrs, 16);
+            if (got == 0) {
+                r.seek_to_start();
+                continue;
+            }
+            for (size_t i = 0; i < got; ++i) sum += ptrs[i]->last_price;
+            done += got;
+        }
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+}
+
+// update / get 单线程与有竞争两种情形；竞争线程在计时区间内持续运行
+void add_snapshot_benches(std::vector<Bench>& out, const std::string& kind,
+                          std::function<std::unique_ptr<MarketSnapshot>()> make) {
+    auto contended = [make](uint64_t n, bool measure_update, int others) {
+        std::unique_ptr<MarketSnapshot> snap = make();
+        for (const auto& t : g_ticks) snap->update(t);
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        for (int k = 0; k < others; ++k) {
+            threads.emplace_back([&, k]() {
+                TickRecord out;
+                size_t i = static_cast<size_t>(k) * 7;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const TickRecord& t = g_ticks[i++ % g_ticks.size()];
+                    if (measure_update) {
+                        snap->get(t.symbol_id, out);
+                        do_not_optimize(out.last_price);
+                    } else {
+                        snap->update(t);
+                    }
+                }
+            });
+        }
+        TickRecord got;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            const TickRecord& t = g_ticks[i % g_ticks.size()];
+            if (measure_update) {
+                snap->update(t);
+            } else {
+                snap->get(t.symbol_id, got);
+                do_not_optimize(got.last_price);
+            }
+        }
+        uint64_t t = now_ns() - t0;
+        stop = true;
+        for (auto& th : threads) th.join();
+        return t;
+    };
+
+    out.push_back({"snapshot/" + kind + "/update", [contended](uint64_t n) { return contended(n, true, 0); }});
+    out.push_back({"snapshot/" + kind + "/get", [contended](uint64_t n) { return contended(n, false, 0); }});
+    // 写者更新，同时 2 个读者轮询
+    out.push_back({"snapshot/" + kind + "/update_2readers", [contended](uint64_t n) { return contended(n, true, 2); }});
+    // 读者读取，同时 1 个写者持续更新 (SeqLock 重试)
+    out.push_back({"snapshot/" + kind + "/get_1writer", [contended](uint64_t n) { return contended(n, false, 1); }});
+}
+
+void add_id_benches(std::vector<Bench>& out) {
+    out.push_back({"symbol/get_id", [](uint64_t n) {
+        const SymbolManager& sm = SymbolManager::instance();
+        uint64_t sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) sum += sm.get_id(g_ticks[i % g_ticks.size()].symbol);
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+    out.push_back({"symbol/get_index", [](uint64_t n) {
+        const SymbolManager& sm = SymbolManager::instance();
+        int64_t sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) sum += sm.get_index(g_ticks[i % g_ticks.size()].symbol_id);
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+    out.push_back({"order/next_id", [](uint64_t n) {
+        OrderIDGenerator& gen = OrderIDGenerator::instance();
+        uint64_t sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) sum += gen.next_id();
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+}
+
+// KlineModule：经 EventBus 逐 Tick 聚合 (含整分钟收线与落盘)，时间按 10ms 递增
+void add_kline_bench(std::vector<Bench>& out, const Options& opt) {
+    std::string lib = opt.lib_dir + "/libmod_kline.so";
+    std::string dir = opt.work_dir + "/kline";
+    out.push_back({"kline/on_tick", [lib, dir](uint64_t n) -> uint64_t {
+        auto plugin = std::make_shared<Plugin>();
+        plugin->handle = dlopen(lib.c_str(), RTLD_NOW);
+        if (!plugin->handle) throw std::runtime_error(dlerror());
+        auto create = reinterpret_cast<CreateModuleFunc>(dlsym(plugin->handle, "create_module"));
+        if (!create) throw std::runtime_error("create_module not found in " + lib);
+
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        BenchBus bus;
+        std::unique_ptr<IModule> mod(create());
+        mod->init(&bus, {{"output_path", dir}});
+        mod->start();
+
+        TickRecord t;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            t = g_ticks[i % g_ticks.size()];
+            uint64_t ms = 9 * 3600000ULL + (i * 10) % (6 * 3600000ULL);
+            t.update_time = ((ms / 3600000) * 10000 + (ms / 60000 % 60) * 100 + ms / 1000 % 60) * 1000 + ms % 1000;
+            t.volume += static_cast<int>(i / g_ticks.size()) * 100;
+            bus.publish(EVENT_MARKET_DATA, &t);
+        }
+        uint64_t t_ns = now_ns() - t0;
+        mod->stop();
+        bus.clear();
+        mod.reset();
+        return t_ns;
+    }});
+}
+
+// KlineStore：20 个交易日 x 64 合约的 1m 线 (日盘 360 根)，查询单合约最近 500 根 (跨 2 日)
+KlineRecord store_bar(uint32_t day, size_t sym, uint32_t minute) {
+    KlineRecord k{};
+    const TickRecord& t = g_ticks[sym % g_ticks.size()];
+    std::memcpy(k.symbol, t.symbol, sizeof(k.symbol));
+    k.symbol_id = t.symbol_id;
+    k.trading_day = day;
+    k.period = 60;
+    k.type = KLINE_TIME;
+    k.interval = K_1M;
+    uint32_t m = 9 * 60 + minute;
+    k.start_time = (m / 60 * 10000ULL + m % 60 * 100ULL) * 1000;
+    k.open = k.high = k.low = k.close = t.last_price;
+    k.volume = 10;
+    return k;
+}
+
+void add_store_benches(std::vector<Bench>& out, const Options& opt) {
+    const std::string dir = opt.work_dir + "/kline_store";
+    const size_t kSymbols = 64;
+    const uint32_t kDays = 20, kBars = 360;
+
+    out.push_back({"kline_store/append", [dir](uint64_t n) -> uint64_t {
+        fs::remove_all(dir + "_append");
+        KlineStore store(dir + "_append", true);
+        std::vector<KlineRecord> bars;
+        for (uint32_t m = 0; m < kBars; ++m) {
+            for (size_t s = 0; s < kSymbols; ++s) bars.push_back(store_bar(20260101, s, m));
+        }
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            KlineRecord& k = bars[i % bars.size()];
+            k.trading_day = 20260101 + static_cast<uint32_t>(i / bars.size());
+            store.append(k, "1m");
+        }
+        return now_ns() - t0;
+    }});
+
+    auto prepare = [dir] {
+        static bool ready = false;
+        if (ready) return;
+        fs::remove_all(dir);
+        KlineStore store(dir, true);
+        for (uint32_t d = 0; d < kDays; ++d) {
+            for (uint32_t m = 0; m < kBars; ++m) {
+                for (size_t s = 0; s < kSymbols; ++s) store.append(store_bar(20260101 + d, s, m), "1m");
+            }
+        }
+        ready = true;
+    };
+
+    out.push_back({"kline_store/last_500", [dir, prepare](uint64_t n) -> uint64_t {
+        prepare();
+        KlineStore store(dir);
+        const uint64_t id = g_ticks[0].symbol_id;
+        size_t sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            for (const KlineSpan& sp : store.last_bars(id, "1m", 500)) sum += sp.size;
+        }
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+    // 策略 init 预热：新建只读 KlineStore (扫描目录 + 映射文件) 后取最近 500 根并求收盘均值
+    out.push_back({"kline_store/open_last_500", [dir, prepare](uint64_t n) -> uint64_t {
+        prepare();
+        const uint64_t id = g_ticks[0].symbol_id;
+        double sum = 0;
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            KlineStore store(dir);
+            for (const KlineSpan& sp : store.last_bars(id, "1m", 500)) {
+                for (const KlineRecord& k : sp) sum += k.close;
+            }
+        }
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sum);
+        return t;
+    }});
+}
+
+// rolling.h 增量指标单次 push 耗时；stats_naive 为移植前 StatArbNode 的 deque 逐笔重算
+template <typename Make, typename Fn>
+Bench rolling_bench(const std::string& name, Make make, Fn step) {
+    return {name, [make, step](uint64_t n) -> uint64_t {
+        auto op = make();
+        double sink = 0;
+        const size_t m = g_ticks.size();
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) sink += step(op, g_ticks[i % m].last_price, g_ticks[(i + 1) % m].last_price);
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sink);
+        return t;
+    }};
+}
+
+void add_rolling_benches(std::vector<Bench>& out) {
+    out.push_back(rolling_bench("rolling/sum_w20", [] { return RollingSum(20); }, [](RollingSum& o, double x, double) {
+        o.push(x);
+        return o.mean();
+    }));
+    out.push_back(rolling_bench("rolling/stats_w60", [] { return RollingStats(60); }, [](RollingStats& o, double x, double) {
+        o.push(x);
+        return o.zscore(x);
+    }));
+    out.push_back(rolling_bench("rolling/stats_naive_w60", [] { return std::deque<double>(); },
+        [](std::deque<double>& q, double x, double) {
+            q.push_back(x);
+            if (q.size() > 60) q.pop_front();
+            double mean = std::accumulate(q.begin(), q.end(), 0.0) / q.size();
+            double sq = 0;
+            for (double p : q) sq += (p - mean) * (p - mean);
+            double sd = std::sqrt(sq / q.size());
+            return sd > 1e-5 ? (x - mean) / sd : 0.0;
+        }));
+    out.push_back(rolling_bench("rolling/ema", [] { return Ema::from_span(60); }, [](Ema& o, double x, double) {
+        o.push(x);
+        return o.value();
+    }));
+    out.push_back(rolling_bench("rolling/minmax_w60", [] { return RollingMinMax(60); }, [](RollingMinMax& o, double x, double) {
+        o.push(x);
+        return o.max() - o.min();
+    }));
+    for (size_t w : {60, 512}) {
+        out.push_back(rolling_bench("rolling/quantile_w" + std::to_string(w), [w] { return RollingQuantile(w); },
+            [](RollingQuantile& o, double x, double) {
+                o.push(x);
+                return o.quantile(0.9);
+            }));
+    }
+    out.push_back(rolling_bench("rolling/corr_w60", [] { return RollingCorr(60); }, [](RollingCorr& o, double x, double y) {
+        o.push(x, y);
+        return o.corr() + o.beta();
+    }));
+}
+
+// FactorStore：64 合约 x 3 因子的信号轮转写入 (按名称定位 + seqlock 单元格 + 追加日志)，shm 只写表、不落日志
+void add_factor_store_benches(std::vector<Bench>& out, const Options& opt) {
+    const std::string base = opt.work_dir + "/factor_log";
+    for (bool with_log : {true, false}) {
+        out.push_back({with_log ? "factor_store/update_logged" : "factor_store/update_shm", [base, with_log](uint64_t n) -> uint64_t {
+            const char* factors[] = {"SMA_Diff", "Imbalance", "PriceJump"};
+            std::vector<SignalRecord> sigs;
+            for (size_t i = 0; i < g_ids.size(); ++i) {
+                for (const char* f : factors) {
+                    SignalRecord s{};
+                    std::memcpy(s.symbol, g_ticks[i].symbol, sizeof(s.symbol));
+                    std::strncpy(s.factor_name, f, sizeof(s.factor_name) - 1);
+                    s.timestamp = g_ticks[i].update_time;
+                    sigs.push_back(s);
+                }
+            }
+            fs::remove(base + ".dat");
+            fs::remove(base + ".meta");
+            fs::remove(base + ".names");
+            uint64_t t_ns;
+            std::streambuf* saved = std::cout.rdbuf(nullptr);  // 屏蔽 MmapWriter 析构日志
+            {
+                FactorStore store("/hft_bench_core_factors", true, 1024, 16);
+                if (with_log) store.open_log(base, n + 1);
+                uint64_t t0 = now_ns();
+                for (uint64_t i = 0; i < n; ++i) {
+                    SignalRecord& s = sigs[i % sigs.size()];
+                    s.value = static_cast<double>(i);
+                    store.update(s);
+                }
+                t_ns = now_ns() - t0;
+            }
+            std::cout.clear();
+            std::cout.rdbuf(saved);
+            return t_ns;
+        }});
+    }
+}
+
+// 每个 libstrat_*.so 的 onTick：以默认参数初始化，报单/信号回调为空操作
+// 表达式因子：与手写等价实现 (SmaFactorNode + ImbalanceNode 的计算部分) 对比字节码解释开销；
+// ema_set 为 4 个共享 mid / ema / 滚动统计的因子，公共子表达式只算一次。按合约各一份状态，ns/op 为每条 Tick 求值全部因子
+void add_expr_benches(std::vector<Bench>& out) {
+    auto eval_bench = [](std::vector<std::pair<std::string, std::string>> factors) {
+        return [factors](uint64_t n) -> uint64_t {
+            ExprProgram prog(factors);
+            std::vector<ExprState> states;
+            for (size_t i = 0; i < g_ids.size(); ++i) states.push_back(prog.make_state());
+            std::vector<double> v(prog.factor_count());
+            double sink = 0;
+            const size_t m = g_ticks.size();
+            uint64_t t0 = now_ns();
+            for (uint64_t i = 0; i < n; ++i) {
+                prog.eval(g_ticks[i % m], states[i % g_ids.size()], v.data());
+                for (double x : v) sink += std::isfinite(x) ? x : 0.0;
+            }
+            uint64_t t = now_ns() - t0;
+            do_not_optimize(sink);
+            return t;
+        };
+    };
+    out.push_back({"expr/eval_sma_imb", eval_bench({{"SMA_Diff", "clip((last - sma(last,20)) / sma(last,20) * 1000, -1, 1)"},
+                                                   {"Imbalance", "(bid_vol[0]-ask_vol[0])/(bid_vol[0]+ask_vol[0])"}})});
+    out.push_back({"expr/hand_sma_imb", [](uint64_t n) -> uint64_t {
+        std::vector<RollingSum> sums(g_ids.size(), RollingSum(20));
+        double sink = 0;
+        const size_t m = g_ticks.size();
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < n; ++i) {
+            const TickRecord& t = g_ticks[i % m];
+            RollingSum& sum = sums[i % g_ids.size()];
+            sum.push(t.last_price);
+            if (sum.full()) {
+                double sma = sum.mean();
+                sink += std::clamp((t.last_price - sma) / sma * 1000.0, -1.0, 1.0);
+            }
+            double b = t.bid_volume[0], a = t.ask_volume[0];
+            if (b + a != 0) sink += (b - a) / (b + a);
+        }
+        uint64_t t = now_ns() - t0;
+        do_not_optimize(sink);
+        return t;
+    }});
+    out.push_back({"expr/eval_ema_set", eval_bench({{"EmaSpread", "ema(mid,20) - ema(mid,100)"},
+                                                   {"MidDev", "(mid - ema(mid,20)) / std(mid,60)"},
+                                                   {"MidZ", "zscore(mid,60)"},
+                                                   {"Breakout", "(last - tsmax(last,60)) / spread"}})});
+}
+
+void add_strategy_benches(std::vector<Bench>& out, const Options& opt) {
+    if (!fs::is_directory(opt.lib_dir)) return;
+    std::vector<std::string> libs;
+    for (const auto& e : fs::directory_iterator(opt.lib_dir)) {
+        std::string f = e.path().filename().string();
+        if (f.rfind("libstrat_", 0) == 0 && e.path().extension() == ".so") libs.push_back(e.path().string());
+    }
+    std::sort(libs.begin(), libs.end());
+
+    for (const auto& lib : libs) {
+        std::string name = fs::path(lib).stem().string().substr(std::strlen("libstrat_"));
+        if (name == "expr") continue;  // 需配置表达式，见 expr/* 与 strategy_tree/expr_sma_imb
+        std::string symbols = opt.symbols;
+        out.push_back({"strategy/" + name + "/on_tick", [lib, symbols](uint64_t n) -> uint64_t {
+            Plugin plugin;
+            plugin.handle = dlopen(lib.c_str(), RTLD_NOW);
+            if (!plugin.handle) throw std::runtime_error(dlerror());
+            auto create = reinterpret_cast<CreateStrategyFunc>(dlsym(plugin.handle, "create_strategy"));
+            if (!create) throw std::runtime_error("create_strategy not found in " + lib);
+
+            StrategyContext ctx;
+            ctx.strategy_id = "bench";
+            ctx.send_order = [](const OrderReq&) {};
+            ctx.send_signal = [](const SignalRecord&) {};
+            ctx.log = [](const char*) {};
+            ConfigMap cfg = {{"symbol", g_ticks[0].symbol}, {"symbols_file", symbols}};
+
+            uint64_t t_ns;
+            {
+                std::unique_ptr<IStrategyNode> node(create());
+                node->init(&ctx, cfg);
+                uint64_t t0 = now_ns();
+                for (uint64_t i = 0; i < n; ++i) node->onTick(&g_ticks[i % g_ticks.size()]);
+                t_ns = now_ns() - t0;
+            }
+            return t_ns;
+        }});
+    }
+}
+
+// CrossSectionCombinerNode：一次迭代为一根 1m Bar 的完整截面 (全部合约各 3 个因子信号 + 1 根 K 线)
+void add_cs_combiner_bench(std::vector<Bench>& out, const Options& opt) {
+    std::string lib = opt.lib_dir + "/libstrat_cs_combiner.so";
+    if (!fs::exists(lib)) return;
+    std::string symbols = opt.symbols;
+    out.push_back({"strategy/cs_combiner/bar_cycle", [lib, symbols](uint64_t n) -> uint64_t {
+        Plugin plugin;
+        plugin.handle = dlopen(lib.c_str(), RTLD_NOW);
+        if (!plugin.handle) throw std::runtime_error(dlerror());
+        auto create = reinterpret_cast<CreateStrategyFunc>(dlsym(plugin.handle, "create_strategy"));
+        if (!create) throw std::runtime_error("create_strategy not found in " + lib);
+
+        const SymbolManager& sm = SymbolManager::instance();
+        if (sm.count() < 2) throw std::runtime_error("需要 --symbols");
+        StrategyContext ctx;
+        ctx.strategy_id = "bench";
+        uint64_t orders = 0;
+        ctx.send_order = [&orders](const OrderReq&) { ++orders; };
+        ctx.send_signal = [](const SignalRecord&) {};
+        ctx.log = [](const char*) {};
+        ConfigMap cfg = {{"symbols_file", symbols},
+                         {"_yaml", "weights: {SMA_Diff: 0.5, Imbalance: 0.3, PriceJump: 0.2}"}};
+
+        const char* factors[] = {"SMA_Diff", "Imbalance", "PriceJump"};
+        std::vector<SignalRecord> sigs;
+        std::vector<KlineRecord> bars(sm.count());
+        for (size_t i = 0; i < sm.count(); ++i) {
+            const char* sym = sm.get_symbol(sm.id_at(i));
+            for (const char* f : factors) {
+                SignalRecord s{};
+                std::strncpy(s.symbol, sym, sizeof(s.symbol) - 1);
+                std::strncpy(s.factor_name, f, sizeof(s.factor_name) - 1);
+                sigs.push_back(s);
+            }
+            KlineRecord& k = bars[i];
+            std::memset(&k, 0, sizeof(k));
+            std::strncpy(k.symbol, sym, sizeof(k.symbol) - 1);
+            k.symbol_id = sm.id_at(i);
+            k.trading_day = 20260302;
+            k.interval = K_1M;
+            k.period = 60;
+        }
+
+        uint64_t t_ns;
+        {
+            std::unique_ptr<IStrategyNode> node(create());
+            node->init(&ctx, cfg);
+            uint64_t rng = 88172645463325252ULL;
+            uint64_t t0 = now_ns();
+            for (uint64_t i = 0; i < n; ++i) {
+                for (auto& s : sigs) {
+                    rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                    s.value = static_cast<double>(rng % 2001) / 1000.0 - 1.0;
+                    node->onSignal(&s);
+                }
+                uint32_t m = 9 * 60 + static_cast<uint32_t>(i % 300);
+                for (auto& k : bars) {
+                    k.start_time = (m / 60 * 10000ULL + m % 60 * 100ULL) * 1000;
+                    node->onKline(&k);
+                }
+            }
+            t_ns = now_ns() - t0;
+        }
+        do_not_optimize(orders);
+        return t_ns;
+    }});
+}
+
+// StrategyTreeModule：5 个节点 (3 个 Tick 因子 + 截面组合 + 统计套利) 经 EventBus 逐 Tick 调度
+//   broadcast: 不声明 inputs/outputs (按配置顺序执行，信号发给全部兄弟)；dag: 声明依赖，信号只投递给消费者；
+//   dag_w2: dag + 2 个工作线程并行执行同层节点 (需至少 3 核)；
+//   stat_arb_x32: 32 个单合约统计套利节点各订阅一个合约，每条 Tick 只投递给订阅者
+void add_strategy_tree_benches(std::vector<Bench>& out, const Options& opt) {
+    std::string lib = opt.lib_dir + "/libmod_strategy_tree.so";
+    if (!fs::exists(lib) || !fs::exists(opt.lib_dir + "/libstrat_cs_combiner.so")) return;
+
+    auto make_yaml = [&opt](bool dag) {
+        auto node = [&](const char* id, const char* so, const char* io, const std::string& params) {
+            return std::string("  - id: ") + id + "\n    library: " + opt.lib_dir + "/" + so + "\n" +
+                   (dag ? io : "") + "    params: " + params + "\n";
+        };
+        return "nodes:\n" +
+               node("FACTOR_SMA", "libstrat_sma.so", "    inputs: []\n    outputs: [SMA_Diff]\n",
+                    "{window_size: 20, multiplier: 1000.0}") +
+               node("FACTOR_IMB", "libstrat_imbalance.so", "    inputs: []\n    outputs: [Imbalance]\n", "{}") +
+               node("FACTOR_JUMP", "libstrat_price_jump.so", "    inputs: []\n    outputs: [PriceJump]\n",
+                    "{threshold: 0.0001}") +
+               node("CS_COMBINER", "libstrat_cs_combiner.so",
+                    "    inputs: [SMA_Diff, Imbalance, PriceJump]\n    outputs: []\n",
+                    "{symbols_file: " + opt.symbols + ", weights: {SMA_Diff: 0.5, Imbalance: 0.3, PriceJump: 0.2}}") +
+               node("STAT_ARB", "libstrat_stat_arb.so", "    inputs: []\n    outputs: []\n",
+                    std::string("{symbol: ") + g_ticks[0].symbol + ", window_size: 100, sigma: 4.0}");
+    };
+
+    std::string per_symbol = "nodes:\n";
+    for (size_t i = 0; i < 32 && i < g_ids.size(); ++i) {
+        per_symbol += "  - id: STAT_ARB_" + std::to_string(i) + "\n    library: " + opt.lib_dir +
+                      "/libstrat_stat_arb.so\n    params: {symbol: " + SymbolManager::instance().get_symbol(g_ids[i]) +
+                      ", window_size: 100, sigma: 4.0}\n";
+    }
+
+    auto node_line = [&opt](const char* id, const char* so, const std::string& params) {
+        return std::string("  - id: ") + id + "\n    library: " + opt.lib_dir + "/" + so + "\n    params: " + params + "\n";
+    };
+    std::string imbalance_l5 = "nodes:\n" + node_line("FACTOR_IMB", "libstrat_imbalance.so", "{levels: 5, emit_features: true}");
+
+    // batch > 0 时按 EVENT_TICK_BATCH 每批 batch 条发布 (tick_batch 模式)，ns/op 仍按单条 Tick 计
+    struct Variant {
+        const char* name;
+        std::string yaml;
+        int workers;
+        size_t batch;
+    };
+    std::vector<Variant> variants = {{"broadcast", make_yaml(false), 0, 0}, {"dag", make_yaml(true), 0, 0},
+                                     {"dag_batch16", make_yaml(true), 0, 16}};
+    if (std::thread::hardware_concurrency() >= 3) variants.push_back({"dag_w2", make_yaml(true), 2, 0});
+    variants.push_back({"stat_arb_x32", per_symbol, 0, 0});
+    variants.push_back({"sma_imb", "nodes:\n" + node_line("FACTOR_SMA", "libstrat_sma.so", "{window_size: 20, multiplier: 1000.0}") +
+                                       node_line("FACTOR_IMB", "libstrat_imbalance.so", "{}"), 0, 0});
+    variants.push_back({"expr_sma_imb", "nodes:\n" + node_line("FACTOR_EXPR", "libstrat_expr.so",
+                       "{factors: {SMA_Diff: 'clip((last - sma(last,20)) / sma(last,20) * 1000, -1, 1)', "
+                       "Imbalance: '(bid_vol[0]-ask_vol[0])/(bid_vol[0]+ask_vol[0])'}}"), 0, 0});
+    variants.push_back({"imbalance_l5", imbalance_l5, 0, 0});
+    variants.push_back({"imbalance_l5_batch16", imbalance_l5, 0, 16});
+
+    // 批量发布用的指针环：末尾多放一批回绕指针，任意起点取 batch 条都不越界
+    auto ptrs = std::make_shared<std::vector<const TickRecord*>>();
+    for (size_t i = 0; i < g_ticks.size() + 16; ++i) ptrs->push_back(&g_ticks[i % g_ticks.size()]);
+
+    for (const auto& v : variants) {
+        std::string yaml = v.yaml;
+        std::string workers = std::to_string(v.workers);
+        size_t batch = v.batch;
+        out.push_back({std::string("strategy_tree/") + v.name + "/on_tick", [lib, yaml, workers, batch, ptrs](uint64_t n) -> uint64_t {
+            auto plugin = std::make_shared<Plugin>();
+            plugin->handle = dlopen(lib.c_str(), RTLD_NOW);
+            if (!plugin->handle) throw std::runtime_error(dlerror());
+            auto create = reinterpret_cast<CreateModuleFunc>(dlsym(plugin->handle, "create_module"));
+            if (!create) throw std::runtime_error("create_module not found in " + lib);
+
+            BenchBus bus;
+            std::unique_ptr<IModule> mod(create());
+            std::streambuf* saved = std::cout.rdbuf(nullptr);  // 屏蔽节点日志 (加载与开平仓)
+            mod->init(&bus, {{"_yaml", yaml}, {"publish_signals", "false"}, {"workers", workers},
+                             {"tick_batch", batch ? "true" : "false"}});
+
+            uint64_t t0 = now_ns();
+            if (batch) {
+                for (uint64_t i = 0; i < n; i += batch) {
+                    TickBatch b{ptrs->data() + i % g_ticks.size(), static_cast<size_t>(std::min<uint64_t>(batch, n - i))};
+                    bus.publish(EVENT_TICK_BATCH, &b);
+                }
+            } else {
+                for (uint64_t i = 0; i < n; ++i) bus.publish(EVENT_MARKET_DATA, &g_ticks[i % g_ticks.size()]);
+            }
+            uint64_t t_ns = now_ns() - t0;
+            bus.clear();
+            mod.reset();
+            std::cout.clear();
+            std::cout.rdbuf(saved);
+            return t_ns;
+        }});
+    }
+}
+
+// ==========================================
+// 5. 输出
+// ==========================================
+std::string json_escape(const std::string& s) {
+    std::string o;
+    for (char c : s) {
+        if (c == '"' || c == '\\') o += '\\';
+        o += c;
+    }
+    return o;
+}
+
+void write_json(const std::string& path, const std::vector<Result>& results, const Options& opt) {
+    char host[256] = {0};
+    gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::ofstream ofs(path);
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"host_name\": \"" << json_escape(host) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"cpu\": " << opt.cpu << ",\n"
+        << "    \"repetitions\": " << opt.reps << ",\n"
+        << "    \"min_time\": " << opt.min_time << "\n"
+        << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        ofs << "    {\"name\": \"" << json_escape(r.name) << "\", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << r.median_ns << ", \"min_time\": " << r.min_ns
+            << ", \"max_time\": " << r.max_ns << ", \"cv\": " << r.cv
+            << ", \"items_per_second\": " << (r.median_ns > 0 ? 1e9 / r.median_ns : 0)
+            << ", \"time_unit\": \"ns\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ofs << "  ]\n}\n";
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl;
+    std::cerr << "  --filter <substr>   只运行名称包含 substr 的项" << std::endl;
+    std::cerr << "  --json <file>       结果写入 JSON (供 tools/bench_compare.py 对比)" << std::endl;
+    std::cerr << "  --lib-dir <dir>     插件目录 (默认 ../bin，用于 kline 与 strategy 项)" << std::endl;
+    std::cerr << "  --symbols <file>    合约映射 (默认 ../conf/symbols.txt)" << std::endl;
+    std::cerr << "  --work-dir <dir>    临时文件目录 (默认 /tmp/hft_bench_core)" << std::endl;
+    std::cerr << "  --min-time <sec>    单轮最短耗时 (默认 0.2)" << std::endl;
+    std::cerr << "  --reps <N>          重复轮数，取中位数 (默认 5)" << std::endl;
+    std::cerr << "  --cpu <N>           绑定到指定 CPU，降低调度噪声" << std::endl;
+    std::cerr << "  --list              只列出基准项" << std::endl;
+}
+
+bool parse_args(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + a);
+            return argv[++i];
+        };
+        if (a == "--filter") opt.filter = next();
+        else if (a == "--json") opt.json_path = next();
+        else if (a == "--lib-dir") opt.lib_dir = next();
+        else if (a == "--symbols") opt.symbols = next();
+        else if (a == "--work-dir") opt.work_dir = next();
+        else if (a == "--min-time") opt.min_time = std::stod(next());
+        else if (a == "--reps") opt.reps = std::max(1, std::stoi(next()));
+        else if (a == "--cpu") opt.cpu = std::stoi(next());
+        else if (a == "--list") opt.list = true;
+        else return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    try {
+        if (!parse_args(argc, argv, opt)) {
+            print_usage(argv[0]);
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (opt.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(opt.cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            std::cerr << "[Bench] 绑核失败: cpu " << opt.cpu << std::endl;
+        }
+    }
+
+    SymbolManager::instance().load(opt.symbols);
+    fs::create_directories(opt.work_dir);
+    build_ticks(65536);
+
+    std::vector<Bench> benches;
+    add_mmap_benches(benches, opt);
+    add_snapshot_benches(benches, "local", [] { return std::make_unique<LocalMarketSnapshot>(); });
+    add_snapshot_benches(benches, "shm", [] {
+        return std::make_unique<ShmMarketSnapshot>("/hft_bench_core_snapshot", true);
+    });
+    add_id_benches(benches);
+    add_kline_bench(benches, opt);
+    add_store_benches(benches, opt);
+    add_rolling_benches(benches);
+    add_factor_store_benches(benches, opt);
+    add_expr_benches(benches);
+    add_strategy_benches(benches, opt);
+    add_cs_combiner_bench(benches, opt);
+    add_strategy_tree_benches(benches, opt);
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "ns/op"
+              << std::setw(12) << "min" << std::setw(12) << "max" << std::setw(8) << "cv%" << std::setw(14)
+              << "iterations" << std::endl;
+    for (const auto& b : benches) {
+        if (!opt.filter.empty() && b.name.find(opt.filter) == std::string::npos) continue;
+        if (opt.list) {
+            std::cout << b.name << std::endl;
+            continue;
+        }
+        try {
+            Result r = run_bench(b, opt);
+            std::cout << std::left << std::setw(40) << r.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << r.median_ns << std::setw(12) << r.min_ns << std::setw(12) << r.max_ns
+                      << std::setw(8) << std::setprecision(1) << r.cv * 100 << std::setw(14) << r.iterations
+                      << std::endl;
+            results.push_back(r);
+        } catch (const std::exception& e) {
+            std::cout << std::left << std::setw(40) << b.name << "  skipped: " << e.what() << std::endl;
+        }
+    }
+
+    if (!opt.json_path.empty()) {
+        write_json(opt.json_path, results, opt);
+        std::cout << "[Bench] JSON: " << opt.json_path << std::endl;
+    }
+    return 0;
+}
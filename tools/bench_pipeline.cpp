@@ -0,0 +1,270 @@
+// 端到端链路基准：按 YAML profile 加载真实插件 (replay -> strategy_tree -> risk -> order -> loopback)，
+// 回放合成或录制的行情文件，统计 tick -> EVENT_ORDER_SEND 延迟分布与最大持续吞吐。
+// 可设阈值，超出时返回非 0，供 CI 拦截热路径退化。
+#include "engine.h"
+#include "protocol.h"
+#include "mmap_util.h"
+#include "symbol_manager.h"
+#include "latency_trace.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string profile;
+    uint64_t gen_ticks = 0;      // >0 时先生成合成行情写入 replay 的 data_file
+    size_t gen_symbols = 50;
+    double max_p99_us = 0;       // 0 表示不检查
+    double min_tps = 0;
+    int timeout_s = 300;
+    int idle_ms = 1000;          // 录制文件：无新 Tick 超过该时长视为回放结束
+};
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <profile.yaml> [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --gen <N>           先生成 N 条合成行情到 profile 中 replay 的 data_file" << std::endl;
+    std::cerr << "  --symbols <K>       合成行情的合约数 (取 symbols.txt 前 K 个，默认 50)" << std::endl;
+    std::cerr << "  --max-p99-us <X>    tick->order p99 超过 X 微秒时返回 1" << std::endl;
+    std::cerr << "  --min-tps <N>       吞吐低于 N ticks/s 时返回 1" << std::endl;
+    std::cerr << "  --timeout <S>       最长运行秒数 (默认 300)" << std::endl;
+    std::cerr << "  --idle-ms <MS>      录制文件回放时的结束判定空闲时长 (默认 1000)" << std::endl;
+}
+
+bool parse_args(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : "0"; };
+        if (a == "--gen") opt.gen_ticks = std::stoull(next());
+        else if (a == "--symbols") opt.gen_symbols = std::stoul(next());
+        else if (a == "--max-p99-us") opt.max_p99_us = std::stod(next());
+        else if (a == "--min-tps") opt.min_tps = std::stod(next());
+        else if (a == "--timeout") opt.timeout_s = std::stoi(next());
+        else if (a == "--idle-ms") opt.idle_ms = std::stoi(next());
+        else if (a == "-h" || a == "--help") return false;
+        else if (opt.profile.empty()) opt.profile = a;
+        else return false;
+    }
+    return !opt.profile.empty();
+}
+
+// profile 中 replay 插件的 data_file
+std::string replay_data_file(const std::string& profile) {
+    YAML::Node doc = YAML::LoadFile(profile);
+    for (const auto& p : doc["plugins"]) {
+        std::string lib = p["library"] ? p["library"].as<std::string>() : "";
+        if (lib.find("mod_replay") != std::string::npos && p["config"] && p["config"]["data_file"]) {
+            return p["config"]["data_file"].as<std::string>();
+        }
+    }
+    return "";
+}
+
+// 合成行情：K 个合约轮转，每条 +1ms，价格随机游走，累计成交量单调递增
+bool generate_ticks(const std::string& base, uint64_t n, size_t k) {
+    const SymbolManager& sm = SymbolManager::instance();
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < k && i < sm.count(); ++i) {
+        ids.push_back(sm.id_at(i));
+    }
+    if (ids.empty()) {
+        std::cerr << "[Bench] symbols.txt 为空，无法生成合成行情" << std::endl;
+        return false;
+    }
+
+    fs::path dir = fs::path(base).parent_path();
+    if (!dir.empty()) fs::create_directories(dir);
+    fs::remove(base + ".dat");
+    fs::remove(base + ".meta");
+
+    MmapWriter<TickRecord> writer(base, n);
+    std::vector<double> price(ids.size(), 1000.0);
+    std::vector<int> volume(ids.size(), 0);
+    uint64_t rng = 88172645463325252ULL;
+    const uint64_t start_ms = 9 * 3600000ULL;
+    for (uint64_t i = 0; i < n; ++i) {
+        size_t s = i % ids.size();
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        price[s] += static_cast<double>(static_cast<int>(rng % 5) - 2);
+        volume[s] += 1 + static_cast<int>((rng >> 8) % 10);
+
+        TickRecord& t = *writer.reserve();
+        std::memset(&t, 0, sizeof(t));
+        std::strncpy(t.symbol, sm.get_symbol(ids[s]), sizeof(t.symbol) - 1);
+        t.symbol_id = ids[s];
+        t.trading_day = 20260302;
+        uint64_t ms = start_ms + i;
+        t.update_time = ((ms / 3600000) * 10000 + (ms / 60000 % 60) * 100 + ms / 1000 % 60) * 1000 + ms % 1000;
+        t.last_price = price[s];
+        t.volume = volume[s];
+        t.turnover = price[s] * volume[s];
+        t.open_interest = 10000;
+        t.upper_limit = 2000;
+        t.lower_limit = 500;
+        t.open_price = t.highest_price = t.lowest_price = t.pre_close_price = 1000.0;
+        for (int l = 0; l < 5; ++l) {
+            t.bid_price[l] = price[s] - 1 - l;
+            t.ask_price[l] = price[s] + 1 + l;
+            t.bid_volume[l] = t.ask_volume[l] = 10 + l;
+        }
+        writer.commit(1);
+    }
+    writer.publish();
+    std::cout << "[Bench] 合成行情: " << n << " 条, " << ids.size() << " 个合约 -> " << base << std::endl;
+    return true;
+}
+
+// 逐笔记录 md_pub -> api (即 EVENT_ORDER_SEND 到达交易桩) 的精确延迟，并转发给分段统计
+class PipelineSink : public ILatencySink {
+public:
+    void on_order(const OrderLatency& lat) override {
+        stages_.on_order(lat);
+        if (lat.ts[LAT_MD_PUB] && lat.ts[LAT_API] >= lat.ts[LAT_MD_PUB]) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            samples_.push_back(lat.ts[LAT_API] - lat.ts[LAT_MD_PUB]);
+        }
+        sends_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<uint64_t> take_samples() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return std::move(samples_);
+    }
+    uint64_t sends() const { return sends_.load(std::memory_order_relaxed); }
+    LatencyStats& stages() { return stages_; }
+
+private:
+    LatencyStats stages_;
+    std::mutex mtx_;
+    std::vector<uint64_t> samples_;
+    std::atomic<uint64_t> sends_{0};
+};
+
+double percentile_us(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[idx] / 1000.0;
+}
+
+uint64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::thread([]{}).join(); // Force pthread init
+
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    HftEngine engine;
+    if (!engine.loadConfig(opt.profile)) {
+        return 2;
+    }
+
+    uint64_t expected = 0;
+    if (opt.gen_ticks > 0) {
+        std::string base = replay_data_file(opt.profile);
+        if (base.empty()) {
+            std::cerr << "[Bench] profile 中未找到 mod_replay 的 data_file" << std::endl;
+            return 2;
+        }
+        if (!generate_ticks(base, opt.gen_ticks, opt.gen_symbols)) return 2;
+        expected = opt.gen_ticks;
+    }
+
+    PipelineSink sink;
+    LatencyTrace::set_sink(&sink);
+
+    // 观测回调订阅在插件之后：每条 Tick 的链路处理完毕时计数
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> first_ns{0};
+    std::atomic<uint64_t> last_ns{0};
+    engine.bus()->subscribe(EVENT_MARKET_DATA, [&](void*) {
+        uint64_t now = steady_ns();
+        if (ticks.load(std::memory_order_relaxed) == 0) first_ns.store(now, std::memory_order_relaxed);
+        last_ns.store(now, std::memory_order_relaxed);
+        ticks.fetch_add(1, std::memory_order_release);
+    });
+
+    engine.start();
+
+    // 合成数据按条数判定结束，录制数据按空闲时长判定
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(opt.timeout_s);
+    uint64_t seen = 0;
+    auto last_progress = std::chrono::steady_clock::now();
+    bool timed_out = false;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t n = ticks.load(std::memory_order_acquire);
+        auto now = std::chrono::steady_clock::now();
+        if (expected > 0 && n >= expected) break;
+        if (n != seen) {
+            seen = n;
+            last_progress = now;
+        } else if (expected == 0 && n > 0 && now - last_progress >= std::chrono::milliseconds(opt.idle_ms)) {
+            break;
+        }
+        if (now >= deadline) {
+            timed_out = true;
+            break;
+        }
+    }
+
+    uint64_t n = ticks.load(std::memory_order_acquire);
+    double elapsed_s = (last_ns.load() - first_ns.load()) / 1e9;
+    LatencyTrace::set_sink(nullptr);
+    engine.stop();
+
+    std::vector<uint64_t> samples = sink.take_samples();
+    std::sort(samples.begin(), samples.end());
+    double tps = elapsed_s > 0 ? n / elapsed_s : 0;
+    double p99 = percentile_us(samples, 0.99);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "========== bench_pipeline ==========" << std::endl;
+    std::cout << "profile        : " << opt.profile << std::endl;
+    std::cout << "ticks          : " << n << (timed_out ? " (timeout)" : "") << std::endl;
+    std::cout << "elapsed        : " << elapsed_s << " s" << std::endl;
+    std::cout << "throughput     : " << tps << " ticks/s" << std::endl;
+    std::cout << "order sends    : " << sink.sends() << " (with tick origin: " << samples.size() << ")" << std::endl;
+    if (!samples.empty()) {
+        std::cout << "tick->send us  : p50=" << percentile_us(samples, 0.5)
+                  << " p90=" << percentile_us(samples, 0.9)
+                  << " p99=" << p99
+                  << " p99.9=" << percentile_us(samples, 0.999)
+                  << " max=" << samples.back() / 1000.0 << std::endl;
+    }
+    std::cout << "stages         : " << sink.stages().report() << std::endl;
+
+    int rc = timed_out ? 1 : 0;
+    if (opt.max_p99_us > 0 && (samples.empty() || p99 > opt.max_p99_us)) {
+        std::cerr << "[Bench] FAIL: p99 " << p99 << " us > " << opt.max_p99_us << " us" << std::endl;
+        rc = 1;
+    }
+    if (opt.min_tps > 0 && tps < opt.min_tps) {
+        std::cerr << "[Bench] FAIL: throughput " << tps << " < " << opt.min_tps << " ticks/s" << std::endl;
+        rc = 1;
+    }
+    return rc;
+}
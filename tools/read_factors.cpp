@@ -0,0 +1,220 @@
+#include "factor_store.h"
+#include "mmap_util.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <getopt.h>
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] <log_base>" << std::endl;
+    std::cerr << "       " << prog << " --shm [name] [options]" << std::endl;
+    std::cerr << "       " << prog << " --diff <log_base_a> <log_base_b> [--tol x]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -s, --symbol <sym>   Filter by symbol (e.g., rb2605)" << std::endl;
+    std::cerr << "  -f, --factor <name>  Filter by factor (e.g., SMA_Diff)" << std::endl;
+    std::cerr << "  -n, --last <N>       Only the last N matching log records" << std::endl;
+    std::cerr << "      --shm [name]     Print latest values from factor SHM (default /hft_factors)" << std::endl;
+    std::cerr << "      --diff           Compare two logs stream by stream (symbol x factor, in order)" << std::endl;
+    std::cerr << "      --tol <x>        Absolute tolerance for --diff (default 1e-9)" << std::endl;
+    std::cerr << "  -h, --help           Show this help" << std::endl;
+}
+
+struct FactorLog {
+    std::vector<std::string> symbols;
+    std::vector<std::string> factors;
+    std::unique_ptr<MmapReader<FactorLogRecord>> reader;
+
+    bool open(const std::string& base) {
+        if (!FactorStore::load_names(base, &symbols, &factors)) {
+            std::cerr << "Cannot read " << base << ".names" << std::endl;
+            return false;
+        }
+        try {
+            reader = std::make_unique<MmapReader<FactorLogRecord>>(base);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& symbol(uint32_t i) const {
+        static const std::string unknown = "?";
+        return i < symbols.size() ? symbols[i] : unknown;
+    }
+    const std::string& factor(uint32_t i) const {
+        static const std::string unknown = "?";
+        return i < factors.size() ? factors[i] : unknown;
+    }
+};
+
+void print_record(const FactorLog& log, const FactorLogRecord& r) {
+    std::cout << r.trading_day << " " << std::setfill('0') << std::setw(9) << r.timestamp << std::setfill(' ') << " | "
+              << std::setw(8) << log.symbol(r.symbol_idx) << " | "
+              << std::setw(16) << log.factor(r.factor_idx) << " | "
+              << std::setprecision(10) << r.value << std::endl;
+}
+
+int dump_log(const std::string& base, const std::string& symbol, const std::string& factor, size_t last_n) {
+    FactorLog log;
+    if (!log.open(base)) return 1;
+
+    // 名称 -> 编号只查一次，逐条按整数比较
+    auto find = [](const std::vector<std::string>& names, const std::string& want) -> int64_t {
+        if (want.empty()) return -1;
+        auto it = std::find(names.begin(), names.end(), want);
+        return it == names.end() ? -2 : it - names.begin();
+    };
+    int64_t sym = find(log.symbols, symbol);
+    int64_t fac = find(log.factors, factor);
+    if (sym == -2 || fac == -2) return 0;
+
+    std::vector<FactorLogRecord> tail;
+    FactorLogRecord r;
+    uint64_t matched = 0;
+    while (log.reader->read(r)) {
+        if (sym >= 0 && r.symbol_idx != sym) continue;
+        if (fac >= 0 && r.factor_idx != fac) continue;
+        ++matched;
+        if (last_n == 0) {
+            print_record(log, r);
+        } else {
+            tail.push_back(r);
+            if (tail.size() > 2 * last_n) tail.erase(tail.begin(), tail.end() - last_n);
+        }
+    }
+    if (tail.size() > last_n) tail.erase(tail.begin(), tail.end() - last_n);
+    for (const auto& t : tail) print_record(log, t);
+    std::cerr << matched << " records" << std::endl;
+    return 0;
+}
+
+int dump_shm(const std::string& name, const std::string& symbol, const std::string& factor) {
+    try {
+        FactorStore store(name, false);
+        std::cout << "SHM " << name << ": " << store.symbols() << " symbols x " << store.factors()
+                  << " factors, update_seq " << store.update_seq() << std::endl;
+        for (uint32_t s = 0; s < store.symbols(); ++s) {
+            if (!symbol.empty() && symbol != store.symbol_name(s)) continue;
+            for (uint32_t f = 0; f < store.factors(); ++f) {
+                if (!factor.empty() && factor != store.factor_name(f)) continue;
+                FactorValue v;
+                if (!store.read(s, f, v)) continue;
+                std::cout << std::setfill('0') << std::setw(9) << v.timestamp << std::setfill(' ') << " | "
+                          << std::setw(8) << store.symbol_name(s) << " | "
+                          << std::setw(16) << store.factor_name(f) << " | "
+                          << std::setprecision(10) << v.value << std::endl;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 按 (合约, 因子) 流逐条对齐比较：第 i 条对第 i 条，交易日或时间戳不同也计为不一致
+int diff_logs(const std::string& a_base, const std::string& b_base, double tol) {
+    FactorLog a, b;
+    if (!a.open(a_base) || !b.open(b_base)) return 1;
+
+    using Key = std::pair<std::string, std::string>;
+    std::map<Key, std::vector<FactorLogRecord>> sa, sb;
+    FactorLogRecord r;
+    while (a.reader->read(r)) sa[{a.symbol(r.symbol_idx), a.factor(r.factor_idx)}].push_back(r);
+    while (b.reader->read(r)) sb[{b.symbol(r.symbol_idx), b.factor(r.factor_idx)}].push_back(r);
+
+    struct Stat {
+        uint64_t a = 0, b = 0, compared = 0, mismatched = 0;
+        double max_diff = 0.0;
+    };
+    std::map<std::string, Stat> by_factor;
+    bool differs = false;
+    for (const auto& [key, ra] : sa) {
+        Stat& st = by_factor[key.second];
+        st.a += ra.size();
+        auto it = sb.find(key);
+        if (it == sb.end()) continue;
+        const auto& rb = it->second;
+        size_t n = std::min(ra.size(), rb.size());
+        for (size_t i = 0; i < n; ++i) {
+            ++st.compared;
+            double d = std::fabs(ra[i].value - rb[i].value);
+            if (std::isnan(ra[i].value) != std::isnan(rb[i].value)) d = INFINITY;
+            st.max_diff = std::max(st.max_diff, d);
+            if (d > tol || ra[i].trading_day != rb[i].trading_day || ra[i].timestamp != rb[i].timestamp) {
+                if (st.mismatched == 0) {
+                    std::cout << "first mismatch " << key.first << "/" << key.second << " #" << i << ": "
+                              << ra[i].trading_day << " " << ra[i].timestamp << " " << std::setprecision(10)
+                              << ra[i].value << " vs " << rb[i].trading_day << " " << rb[i].timestamp << " "
+                              << rb[i].value << std::endl;
+                }
+                ++st.mismatched;
+            }
+        }
+    }
+    for (const auto& [key, rb] : sb) by_factor[key.second].b += rb.size();
+
+    std::cout << std::left << std::setw(20) << "factor" << std::right << std::setw(12) << "a" << std::setw(12) << "b"
+              << std::setw(12) << "compared" << std::setw(12) << "mismatch" << std::setw(14) << "max|diff|" << std::endl;
+    for (const auto& [name, st] : by_factor) {
+        std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << st.a << std::setw(12) << st.b
+                  << std::setw(12) << st.compared << std::setw(12) << st.mismatched << std::setw(14)
+                  << std::setprecision(3) << st.max_diff << std::endl;
+        if (st.mismatched || st.a != st.b) differs = true;
+    }
+    return differs ? 2 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter_symbol;
+    std::string filter_factor;
+    size_t last_n = 0;
+    bool shm = false;
+    bool diff = false;
+    double tol = 1e-9;
+
+    static struct option long_options[] = {
+        {"symbol", required_argument, 0, 's'},
+        {"factor", required_argument, 0, 'f'},
+        {"last",   required_argument, 0, 'n'},
+        {"shm",    no_argument,       0, 'm'},
+        {"diff",   no_argument,       0, 'D'},
+        {"tol",    required_argument, 0, 'T'},
+        {"help",   no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:f:n:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 's': filter_symbol = optarg; break;
+            case 'f': filter_factor = optarg; break;
+            case 'n': last_n = std::stoul(optarg); break;
+            case 'm': shm = true; break;
+            case 'D': diff = true; break;
+            case 'T': tol = std::stod(optarg); break;
+            case 'h': print_usage(argv[0]); return 0;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    if (shm) return dump_shm(optind < argc ? argv[optind] : "/hft_factors", filter_symbol, filter_factor);
+    if (diff) {
+        if (optind + 2 > argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return diff_logs(argv[optind], argv[optind + 1], tol);
+    }
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    return dump_log(argv[optind], filter_symbol, filter_factor, last_n);
+}
@@ -1,5 +1,8 @@
 #include "protocol.h"
 #include "mmap_util.h"
+#include "kline_engine.h"
+#include "kline_store.h"
+#include "symbol_manager.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -17,9 +20,42 @@ void print_usage(const char* prog) {
     std::cerr << "  -t, --start <time>   Start time (HHMMSSmmm, e.g., 093000000)" << std::endl;
     std::cerr << "  -e, --end <time>     End time (HHMMSSmmm, e.g., 150000000)" << std::endl;
     std::cerr << "  -d, --day <YYYYMMDD> Filter by trading day" << std::endl;
+    std::cerr << "  -i, --interval <k>   Only this interval (e.g., 1m), for .kls stores" << std::endl;
+    std::cerr << "  -n, --last <N>       Last N bars of --symbol across days (needs --interval, .kls store)" << std::endl;
     std::cerr << "  -h, --help           Show this help" << std::endl;
 }
 
+void print_bar(const KlineRecord& rec) {
+    std::string interval_str = KlineSpec::label_of(rec);
+
+    std::cout << std::setw(6) << rec.symbol << " | "
+              << rec.trading_day << " | "
+              << std::setfill('0') << std::setw(9) << rec.start_time << std::setfill(' ') << " | "
+              << std::setw(5) << interval_str << " | "
+              << std::setw(8) << rec.open << " | "
+              << std::setw(8) << rec.high << " | "
+              << std::setw(8) << rec.low << " | "
+              << std::setw(8) << rec.close << " | "
+              << std::setw(8) << rec.volume << " | "
+              << std::fixed << std::setprecision(0) << rec.turnover
+              << std::defaultfloat << std::setprecision(6)
+              << std::endl;
+}
+
+bool match(const KlineRecord& rec, const std::string& filter_symbol,
+           uint64_t start_time, uint64_t end_time, uint32_t filter_day) {
+    // 过滤交易日
+    if (filter_day != 0 && rec.trading_day != filter_day) return false;
+
+    // 过滤 Symbol
+    if (!filter_symbol.empty() && filter_symbol != rec.symbol) return false;
+
+    // 过滤时间范围
+    if (start_time != 0 && rec.start_time < start_time) return false;
+    if (end_time != 0 && rec.start_time > end_time) return false;
+    return true;
+}
+
 void process_file(const std::string& base_path, const std::string& filter_symbol, 
                   uint64_t start_time, uint64_t end_time, uint32_t filter_day) {
     try {
@@ -27,59 +63,58 @@ void process_file(const std::string& base_path, const std::string& filter_symbol
         KlineRecord rec;
         
         while (reader.read(rec)) {
-            // 过滤交易日
-            if (filter_day != 0 && rec.trading_day != filter_day) continue;
-            
-            // 过滤 Symbol
-            if (!filter_symbol.empty() && filter_symbol != rec.symbol) continue;
-            
-            // 过滤时间范围
-            if (start_time != 0 && rec.start_time < start_time) continue;
-            if (end_time != 0 && rec.start_time > end_time) continue;
-
-            std::string interval_str = (rec.interval == K_1M) ? "1M" : 
-                                       (rec.interval == K_1H) ? "1H" : 
-                                       (rec.interval == K_1D) ? "1D" : "UNK";
-
-            std::cout << std::setw(6) << rec.symbol << " | "
-                      << rec.trading_day << " | "
-                      << std::setfill('0') << std::setw(9) << rec.start_time << std::setfill(' ') << " | "
-                      << std::setw(3) << interval_str << " | "
-                      << std::setw(8) << rec.open << " | "
-                      << std::setw(8) << rec.high << " | "
-                      << std::setw(8) << rec.low << " | "
-                      << std::setw(8) << rec.close << " | "
-                      << std::setw(8) << rec.volume << " | "
-                      << std::fixed << std::setprecision(0) << rec.turnover
-                      << std::endl;
+            if (match(rec, filter_symbol, start_time, end_time, filter_day)) print_bar(rec);
         }
     } catch (...) {
         // 忽略无法打开的文件
     }
 }
 
+// KlineStore 目录：按 周期 -> 交易日 -> 合约区 输出
+void process_store(KlineStore& store, const std::string& filter_interval, const std::string& filter_symbol,
+                   uint64_t start_time, uint64_t end_time, uint32_t filter_day) {
+    for (const auto& interval : store.intervals()) {
+        if (!filter_interval.empty() && interval != filter_interval) continue;
+        for (uint32_t day : store.days(interval)) {
+            if (filter_day != 0 && day != filter_day) continue;
+            for (const KlineSpan& span : store.day_bars(interval, day)) {
+                if (!filter_symbol.empty() && filter_symbol != span[0].symbol) continue;
+                for (const KlineRecord& rec : span) {
+                    if (match(rec, filter_symbol, start_time, end_time, filter_day)) print_bar(rec);
+                }
+            }
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
     std::string filter_symbol;
     uint64_t start_time = 0;
     uint64_t end_time = 0;
     uint32_t filter_day = 0;
+    std::string filter_interval;
+    size_t last_n = 0;
 
     static struct option long_options[] = {
         {"symbol", required_argument, 0, 's'},
         {"start",  required_argument, 0, 't'},
         {"end",    required_argument, 0, 'e'},
         {"day",    required_argument, 0, 'd'},
+        {"interval", required_argument, 0, 'i'},
+        {"last",   required_argument, 0, 'n'},
         {"help",   no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "s:t:e:d:h", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "s:t:e:d:i:n:h", long_options, nullptr)) != -1) {
         switch (opt) {
             case 's': filter_symbol = optarg; break;
             case 't': start_time = std::stoull(optarg); break;
             case 'e': end_time = std::stoull(optarg); break;
             case 'd': filter_day = std::stoul(optarg); break;
+            case 'i': filter_interval = optarg; break;
+            case 'n': last_n = std::stoul(optarg); break;
             case 'h': print_usage(argv[0]); return 0;
             default: print_usage(argv[0]); return 1;
         }
@@ -92,10 +127,44 @@ int main(int argc, char* argv[]) {
 
     std::string path = argv[optind];
 
-    std::cout << "Symbol | Day      | StartTime | Int | Open     | High     | Low      | Close    | Volume   | Turnover" << std::endl;
-    std::cout << "-------|----------|-----------|-----|----------|----------|----------|----------|----------|----------" << std::endl;
+    std::cout << "Symbol | Day      | StartTime | Int   | Open     | High     | Low      | Close    | Volume   | Turnover" << std::endl;
+    std::cout << "-------|----------|-----------|-------|----------|----------|----------|----------|----------|----------" << std::endl;
+
+    // 单个 .kls 文件按所在目录作为存储根
+    if (!fs::is_directory(path) && fs::path(path).extension() == ".kls") {
+        std::string name = fs::path(path).stem().string();  // kline_<interval>_<day>
+        size_t us = name.rfind('_');
+        if (name.compare(0, 6, "kline_") == 0 && us != std::string::npos && us > 6) {
+            if (filter_interval.empty()) filter_interval = name.substr(6, us - 6);
+            if (filter_day == 0) filter_day = std::stoul(name.substr(us + 1));
+        }
+        path = fs::path(path).parent_path().string();
+        if (path.empty()) path = ".";
+    }
 
     if (fs::is_directory(path)) {
+        KlineStore store(path);
+        if (last_n > 0) {
+            if (filter_symbol.empty() || filter_interval.empty()) {
+                std::cerr << "--last requires --symbol and --interval" << std::endl;
+                return 1;
+            }
+            uint64_t to = filter_day ? KlineStore::day_end(filter_day) : KlineStore::KEY_MAX;
+            if (filter_day && end_time) to = KlineStore::key(filter_day, end_time);
+            uint64_t id = SymbolManager::instance().get_id(filter_symbol.c_str());
+            if (id == 0) {
+                // 未加载合约表：从存储里按名字找到 ID
+                for (const KlineSpan& s : store.get_bars(filter_symbol.c_str(), filter_interval, 0, to)) {
+                    id = s[0].symbol_id;
+                }
+            }
+            for (const KlineSpan& span : store.last_bars(id, filter_interval, last_n, to)) {
+                for (const KlineRecord& rec : span) print_bar(rec);
+            }
+            return 0;
+        }
+        process_store(store, filter_interval, filter_symbol, start_time, end_time, filter_day);
+
         std::vector<std::string> files;
         for (const auto& entry : fs::directory_iterator(path)) {
             if (entry.path().extension() == ".meta") {